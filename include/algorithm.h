@@ -8,6 +8,9 @@
 // using insertion sort/merge sort, stable sort:
 // 3. void stable_sort(Iterator First, Iterator Last, Compare cmp);
 // 4. void stable_sort(Iterator First, Iterator Last);
+//
+// 5. bool is_sorted(Iterator First, Iterator Last, Compare cmp);
+// 6. bool is_sorted(Iterator First, Iterator Last);
 
 #ifndef EZSTL_ALGORITHM_H
 #define EZSTL_ALGORITHM_H
@@ -36,7 +39,7 @@ namespace ezSTL {
 			next = ite;
 			value = *ite;
 			if (cmp(value, *First)) {
-				__copy_to_next(First, ite);
+				ezSTL::__copy_to_next(First, ite);
 				*First = value;
 			}
 			else {
@@ -163,29 +166,29 @@ namespace ezSTL {
 		unsigned int count;
 		while ((count = Last - First) > insertion_threshold && depth > 0) {
 			--depth;
-			Iterator Medium = __quick_sort_partition(First, Last, cmp);
+			Iterator Medium = ezSTL::__quick_sort_partition(First, Last, cmp);
 			if (Medium - First < Last - Medium) {
-				__intro_sort_loop(First, Medium, depth, cmp);
+				ezSTL::__intro_sort_loop(First, Medium, depth, cmp);
 				First = Medium;
 			}
 			else {
-				__intro_sort_loop(Medium, Last, depth, cmp);
+				ezSTL::__intro_sort_loop(Medium, Last, depth, cmp);
 				Last = Medium;
 			}
 		}
 		// if exceed recursive depth limitation
 		if (depth <= 0)
-			__heap_sort(First, Last, cmp);
+			ezSTL::__heap_sort(First, Last, cmp);
 		// if < insertion_threshold, change to insertion sort
 		else if (count >= 2)
-			__insertion_sort(First, Last, cmp);
+			ezSTL::__insertion_sort(First, Last, cmp);
 	}
 
 	// outer interface, using insertion sort/quick sort/heap sort
 	template<typename Iterator, typename Compare>
 	inline void sort(Iterator First, Iterator Last, Compare cmp) {
 		if (First < Last)
-			__intro_sort_loop(First, Last, recursive_depth(Last - First), cmp);
+			ezSTL::__intro_sort_loop(First, Last, recursive_depth(Last - First), cmp);
 	}
 
 	// outer interface, using less as comparison
@@ -221,12 +224,12 @@ namespace ezSTL {
 			return;
 		// if < insertion_threshold, use insertion sort
 		else if (count <= insertion_threshold)
-			__insertion_sort(First, Last, cmp);
+			ezSTL::__insertion_sort(First, Last, cmp);
 		else {
 			Iterator Medium = First + (Last - First) / 2;
-			__merge_sort(First, Medium, cmp);
-			__merge_sort(Medium, Last, cmp);
-			__merge(First, Medium, Last, cmp);
+			ezSTL::__merge_sort(First, Medium, cmp);
+			ezSTL::__merge_sort(Medium, Last, cmp);
+			ezSTL::__merge(First, Medium, Last, cmp);
 		}
 	}
 
@@ -234,7 +237,7 @@ namespace ezSTL {
 	template<typename Iterator, typename Compare>
 	inline void stable_sort(Iterator First, Iterator Last, Compare cmp) {
 		if (First < Last)
-			__merge_sort(First, Last, cmp);
+			ezSTL::__merge_sort(First, Last, cmp);
 	}
 
 	// outer interface, using less as comparison
@@ -243,6 +246,70 @@ namespace ezSTL {
 		stable_sort(First, Last, less<typename remove_reference<decltype(*First)>::type>());
 	}
 
+	// judge if [First, Last) is in non-descending order
+	template<typename Iterator, typename Compare>
+	inline bool is_sorted(Iterator First, Iterator Last, Compare cmp) {
+		if (First == Last)
+			return true;
+		for (Iterator Next = First; ++Next != Last; First = Next)
+			if (cmp(*Next, *First))
+				return false;
+		return true;
+	}
+
+	// using less as comparison
+	template<typename Iterator>
+	inline bool is_sorted(Iterator First, Iterator Last) {
+		return ezSTL::is_sorted(First, Last, less<typename remove_reference<decltype(*First)>::type>());
+	}
+
+	// hint the cache to load the line at p, nothing on compilers without a prefetch builtin
+	template<typename T>
+	inline void __prefetch(const T* p) {
+#if defined(__GNUC__)
+		__builtin_prefetch(p);
+#else
+		(void)p;
+#endif
+	}
+
+	// binary search of the sorted array [First, First + n), used by the flat containers:
+	// index of the first value not less than v, and of the first value greater than v;
+	// the window [base, base + n) halves with one comparison picked by a conditional move instead of
+	// a branch, and the probes of both next windows are prefetched, so on an array larger than the cache
+	// the misses of the next step overlap with the comparison of this one
+	template<typename T, typename Compare>
+	inline unsigned int __lower_bound_index(const T* First, unsigned int n, const T& v, Compare& cmp) {
+		if (n == 0)
+			return 0;
+		const T* base = First;
+		while (n > 1) {
+			unsigned int half = n / 2;
+			unsigned int next_half = (n - half) / 2;
+			__prefetch(base + next_half);
+			__prefetch(base + half + next_half);
+			base = cmp(base[half], v) ? base + half : base;
+			n -= half;
+		}
+		return static_cast<unsigned int>(base - First) + (cmp(*base, v) ? 1 : 0);
+	}
+
+	template<typename T, typename Compare>
+	inline unsigned int __upper_bound_index(const T* First, unsigned int n, const T& v, Compare& cmp) {
+		if (n == 0)
+			return 0;
+		const T* base = First;
+		while (n > 1) {
+			unsigned int half = n / 2;
+			unsigned int next_half = (n - half) / 2;
+			__prefetch(base + next_half);
+			__prefetch(base + half + next_half);
+			base = cmp(v, base[half]) ? base : base + half;
+			n -= half;
+		}
+		return static_cast<unsigned int>(base - First) + (cmp(v, *base) ? 0 : 1);
+	}
+
 	//  ********** SGI Version **********
 	//// intro sort
 	//template<typename Iterator, typename Compare>
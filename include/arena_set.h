@@ -0,0 +1,590 @@
+/*********************************************************************************************/
+// class arena_set:
+// a red-black tree whose nodes live in one array and link each other by 32-bit indices:
+// an unsigned value takes 16 bytes, three indices with the color in the top bit of the parent
+// index and the value, against a 32 byte node of set plus the heap header of its allocation
+// including some basic functions of arena_set:
+//
+// 1. iterator begin() const;
+// 2. iterator end() const;
+// 3. size_type size() const;
+// 4. bool empty() const;
+// 5. iterator find(const T& v) const;
+// 6. iterator lower_bound(const T& v) const;
+// 7. iterator upper_bound(const T& v) const;
+// 8. pair<iterator, bool> insert(const T& v);
+// 9. void erase(iterator pos);
+// 10. void clear();
+// 11. void swap(arena_set& other);
+// 12. void reserve(size_type n);
+// 13. size_type bytes_used() const;
+// only for debug:
+// 14. bool isRBTree() const;
+//
+// index 0 is no node, node k is slot k - 1 of the array, so up to 2^31 - 1 values;
+// erase puts the slot on a free list for the next insert, the erased value stays in the slot
+// until the slot is reused or the set is cleared, so the arena suits small values best;
+// reserve(n) before filling a large set avoids growing the array, a growing array briefly holds
+// the old and the new copy
+//
+// iterator stability:
+// iterators hold an index, insert and erase invalidate only iterators to the erased value,
+// references to values are invalidated when the array grows
+
+#ifndef EZSTL_ARENA_SET_H
+#define EZSTL_ARENA_SET_H
+
+#include "functional.h"
+#include "iterator.h"
+#include "memory.h"
+#include "utility.h"
+#include "vector.h"
+
+namespace ezSTL {
+
+	// forward declaration of class arena_set, which is to be used in __arena_set_iterator
+	template<typename T, typename Compare, typename Alloc> class arena_set;
+
+	// node of arena_set, the links are indices of nodes, 0 for none
+	template<typename T>
+	class __arena_set_node {
+	public:
+		template<typename V>
+		explicit __arena_set_node(V&& v) : left(0), right(0), parent_color(0), data(ezSTL::forward<V>(v)) {}
+
+		unsigned int left;
+		unsigned int right;
+		// the parent index, the color in the highest bit, 1 for black
+		unsigned int parent_color;
+		T data;
+	};
+
+	// arena_set iterator, index 0 for end()
+	template<typename T, typename Compare, typename Alloc>
+	class __arena_set_iterator : public iterator<bidirectional_iterator_tag, T> {
+	public:
+		using self = __arena_set_iterator<T, Compare, Alloc>;
+		using pointer = const T*;
+		using reference = const T&;
+		using difference_type = int;
+
+		const arena_set<T, Compare, Alloc>* tree;
+		unsigned int k;
+
+		__arena_set_iterator() = default;
+		__arena_set_iterator(const arena_set<T, Compare, Alloc>* t, unsigned int index) : tree(t), k(index) {}
+
+		bool operator== (const self& x) const {
+			return k == x.k;
+		}
+		bool operator!= (const self& x) const {
+			return k != x.k;
+		}
+		reference operator*() const {
+			return tree->value(k);
+		}
+		pointer operator->() const {
+			return &(operator*());
+		}
+		self& operator++() {
+			k = tree->next(k);
+			return *this;
+		}
+		self operator++(int) {
+			self temp = *this;
+			++(*this);
+			return temp;
+		}
+		// --end() is the largest value
+		self& operator--() {
+			k = tree->prev(k);
+			return *this;
+		}
+		self operator--(int) {
+			self temp = *this;
+			--(*this);
+			return temp;
+		}
+	};
+
+	// class arena_set
+	template<typename T, typename Compare = less<T>, typename Alloc = allocator<T>>
+	class arena_set {
+	public:
+		using size_type = unsigned int;
+		using value_type = T;
+		using arena_node = __arena_set_node<T>;
+		using node_allocator = typename Alloc::template rebind<arena_node>::other;
+		using iterator = __arena_set_iterator<T, Compare, Alloc>;
+		using const_iterator = const iterator;
+		using reference = const T&;
+		using const_reference = const T&;
+		using difference_type = int;
+	protected:
+		enum : unsigned int { black_bit = 0x80000000u };
+		// node k is nodes[k - 1]
+		vector<arena_node, node_allocator> nodes;
+		size_type root;
+		size_type leftmost;
+		size_type rightmost;
+		// first free slot, the free slots are chained by their left index
+		size_type free_head;
+		size_type __size;
+		Compare cmp;
+	public:
+		// constructor
+		arena_set() : root(0), leftmost(0), rightmost(0), free_head(0), __size(0) {}
+		template<typename Iterator>
+		arena_set(Iterator first, Iterator last) : arena_set() {
+			for (; first != last; ++first)
+				insert(*first);
+		}
+		arena_set(const arena_set&) = default;
+		// the indices stay valid in the moved array, moving swaps the array and the indices
+		arena_set(arena_set&& s) noexcept : arena_set() {
+			swap(s);
+		}
+		arena_set& operator=(const arena_set&) = default;
+		arena_set& operator=(arena_set&& s) noexcept {
+			swap(s);
+			return *this;
+		}
+
+		iterator begin() const {
+			return iterator(this, leftmost);
+		}
+		iterator end() const {
+			return iterator(this, 0);
+		}
+		size_type size() const {
+			return __size;
+		}
+		bool empty() const {
+			return __size == 0;
+		}
+		// find a value, one call of a three-way Compare per level
+		iterator find(const T& v) const {
+			size_type x = root;
+			while (x != 0) {
+				int c = __compare_traits<Compare>::compare(cmp, v, node(x).data);
+				if (c == 0)
+					break;
+				x = c < 0 ? node(x).left : node(x).right;
+			}
+			return iterator(this, x);
+		}
+		// the first value not less than v
+		iterator lower_bound(const T& v) const {
+			size_type y = 0;
+			for (size_type x = root; x != 0; )
+				if (less_than(node(x).data, v))
+					x = node(x).right;
+				else {
+					y = x;
+					x = node(x).left;
+				}
+			return iterator(this, y);
+		}
+		// the first value greater than v
+		iterator upper_bound(const T& v) const {
+			size_type y = 0;
+			for (size_type x = root; x != 0; )
+				if (less_than(v, node(x).data)) {
+					y = x;
+					x = node(x).left;
+				}
+				else
+					x = node(x).right;
+			return iterator(this, y);
+		}
+		// insert a value, nothing changes if an equal value exists
+		pair<iterator, bool> insert(const T& v);
+		// erase an iterator, its slot goes to the free list
+		void erase(iterator pos);
+		void clear() {
+			nodes.clear();
+			root = leftmost = rightmost = free_head = 0;
+			__size = 0;
+		}
+		void swap(arena_set& other) noexcept {
+			ezSTL::swap(nodes, other.nodes);
+			ezSTL::swap(root, other.root);
+			ezSTL::swap(leftmost, other.leftmost);
+			ezSTL::swap(rightmost, other.rightmost);
+			ezSTL::swap(free_head, other.free_head);
+			ezSTL::swap(__size, other.__size);
+			ezSTL::swap(cmp, other.cmp);
+		}
+		// room for n values without growing the array
+		void reserve(size_type n) {
+			nodes.reserve(n);
+		}
+		// bytes taken by the array and the set object
+		size_type bytes_used() const {
+			return sizeof(*this) + nodes.capacity() * sizeof(arena_node);
+		}
+
+		// for the iterator: the value of node k, and the nodes after and before k in order,
+		// next of the largest is 0 and prev of 0 is the largest
+		const T& value(size_type k) const {
+			return node(k).data;
+		}
+		size_type next(size_type k) const;
+		size_type prev(size_type k) const;
+
+		// interface for debug
+		// judge if the present tree is a RBTree
+		bool isRBTree() const;
+
+	protected:
+		arena_node& node(size_type k) {
+			return nodes[k - 1];
+		}
+		const arena_node& node(size_type k) const {
+			return nodes[k - 1];
+		}
+		bool less_than(const T& x, const T& y) const {
+			return __compare_traits<Compare>::less(cmp, x, y);
+		}
+		size_type parent(size_type k) const {
+			return node(k).parent_color & ~black_bit;
+		}
+		void set_parent(size_type k, size_type p) {
+			node(k).parent_color = (node(k).parent_color & black_bit) | p;
+		}
+		// no node is black
+		bool is_black(size_type k) const {
+			return k == 0 || (node(k).parent_color & black_bit) != 0;
+		}
+		void set_black(size_type k, bool black) {
+			node(k).parent_color = black ? node(k).parent_color | black_bit : node(k).parent_color & ~black_bit;
+		}
+		// make y the child of p in place of x, or the root
+		void replace_child(size_type p, size_type x, size_type y) {
+			if (p == 0)
+				root = y;
+			else if (node(p).left == x)
+				node(p).left = y;
+			else
+				node(p).right = y;
+		}
+		void rotate_left(size_type x);
+		void rotate_right(size_type x);
+		void insert_fixup(size_type z);
+		void erase_fixup(size_type son, size_type father);
+		// a red node holding v with no links, from the free list or at the end of the array
+		size_type new_node(const T& v);
+		// number of black nodes on every path from x down, 0 if a red-black property is broken
+		size_type black_height(size_type x) const;
+	};
+
+	template<typename T, typename Compare, typename Alloc>
+	typename arena_set<T, Compare, Alloc>::size_type arena_set<T, Compare, Alloc>::next(size_type k) const {
+		if (node(k).right != 0) {
+			k = node(k).right;
+			while (node(k).left != 0)
+				k = node(k).left;
+			return k;
+		}
+		size_type p = parent(k);
+		while (p != 0 && k == node(p).right) {
+			k = p;
+			p = parent(p);
+		}
+		return p;
+	}
+
+	template<typename T, typename Compare, typename Alloc>
+	typename arena_set<T, Compare, Alloc>::size_type arena_set<T, Compare, Alloc>::prev(size_type k) const {
+		if (k == 0)
+			return rightmost;
+		if (node(k).left != 0) {
+			k = node(k).left;
+			while (node(k).right != 0)
+				k = node(k).right;
+			return k;
+		}
+		size_type p = parent(k);
+		while (p != 0 && k == node(p).left) {
+			k = p;
+			p = parent(p);
+		}
+		return p;
+	}
+
+	template<typename T, typename Compare, typename Alloc>
+	typename arena_set<T, Compare, Alloc>::size_type arena_set<T, Compare, Alloc>::new_node(const T& v) {
+		if (free_head == 0) {
+			nodes.push_back(arena_node(v));
+			return nodes.size();
+		}
+		size_type k = free_head;
+		free_head = node(k).left;
+		arena_node& x = node(k);
+		x.left = x.right = x.parent_color = 0;
+		x.data = v;
+		return k;
+	}
+
+	template<typename T, typename Compare, typename Alloc>
+	pair<typename arena_set<T, Compare, Alloc>::iterator, bool> arena_set<T, Compare, Alloc>::insert(const T& v) {
+		// y : parent of the new node, last_right : the last node v went right of, equal to v if any is
+		size_type y = 0;
+		size_type last_right = 0;
+		bool go_left = true;
+		for (size_type x = root; x != 0; ) {
+			y = x;
+			go_left = less_than(v, node(x).data);
+			if (go_left)
+				x = node(x).left;
+			else {
+				last_right = x;
+				x = node(x).right;
+			}
+		}
+		if (last_right != 0 && !less_than(node(last_right).data, v))
+			return pair<iterator, bool>(iterator(this, last_right), false);
+		// the array may grow here, only indices are held across it
+		size_type z = new_node(v);
+		set_parent(z, y);
+		if (y == 0) {
+			root = leftmost = rightmost = z;
+		}
+		else if (go_left) {
+			node(y).left = z;
+			if (y == leftmost)
+				leftmost = z;
+		}
+		else {
+			node(y).right = z;
+			if (y == rightmost)
+				rightmost = z;
+		}
+		insert_fixup(z);
+		++__size;
+		return pair<iterator, bool>(iterator(this, z), true);
+	}
+
+	template<typename T, typename Compare, typename Alloc>
+	void arena_set<T, Compare, Alloc>::rotate_left(size_type x) {
+		size_type y = node(x).right;
+		node(x).right = node(y).left;
+		if (node(y).left != 0)
+			set_parent(node(y).left, x);
+		set_parent(y, parent(x));
+		replace_child(parent(x), x, y);
+		node(y).left = x;
+		set_parent(x, y);
+	}
+
+	template<typename T, typename Compare, typename Alloc>
+	void arena_set<T, Compare, Alloc>::rotate_right(size_type x) {
+		size_type y = node(x).left;
+		node(x).left = node(y).right;
+		if (node(y).right != 0)
+			set_parent(node(y).right, x);
+		set_parent(y, parent(x));
+		replace_child(parent(x), x, y);
+		node(y).right = x;
+		set_parent(x, y);
+	}
+
+	template<typename T, typename Compare, typename Alloc>
+	void arena_set<T, Compare, Alloc>::insert_fixup(size_type z) {
+		// z is red, recolor and rotate while its parent is red, the root is black so a red parent has a parent
+		while (!is_black(parent(z))) {
+			size_type p = parent(z);
+			size_type g = parent(p);
+			if (p == node(g).left) {
+				size_type uncle = node(g).right;
+				if (!is_black(uncle)) {
+					set_black(p, true);
+					set_black(uncle, true);
+					set_black(g, false);
+					z = g;
+					continue;
+				}
+				if (z == node(p).right) {
+					z = p;
+					rotate_left(z);
+					p = parent(z);
+				}
+				set_black(p, true);
+				set_black(g, false);
+				rotate_right(g);
+			}
+			else {
+				size_type uncle = node(g).left;
+				if (!is_black(uncle)) {
+					set_black(p, true);
+					set_black(uncle, true);
+					set_black(g, false);
+					z = g;
+					continue;
+				}
+				if (z == node(p).left) {
+					z = p;
+					rotate_right(z);
+					p = parent(z);
+				}
+				set_black(p, true);
+				set_black(g, false);
+				rotate_left(g);
+			}
+		}
+		set_black(root, true);
+	}
+
+	template<typename T, typename Compare, typename Alloc>
+	void arena_set<T, Compare, Alloc>::erase(iterator pos) {
+		size_type z = pos.k;
+		if (z == leftmost)
+			leftmost = next(z);
+		if (z == rightmost)
+			rightmost = prev(z);
+		// as in rbtree: todelete leaves its position, son takes it, father is the parent of son;
+		// with two children z is replaced by relinking its successor, no value moves
+		size_type todelete = z;
+		size_type son = 0;
+		size_type father = 0;
+		if (node(z).left == 0)
+			son = node(z).right;
+		else if (node(z).right == 0)
+			son = node(z).left;
+		else {
+			todelete = node(z).right;
+			while (node(todelete).left != 0)
+				todelete = node(todelete).left;
+			son = node(todelete).right;
+		}
+		if (todelete != z) {
+			set_parent(node(z).left, todelete);
+			node(todelete).left = node(z).left;
+			if (todelete != node(z).right) {
+				father = parent(todelete);
+				if (son != 0)
+					set_parent(son, father);
+				node(father).left = son;
+				node(todelete).right = node(z).right;
+				set_parent(node(z).right, todelete);
+			}
+			else
+				father = todelete;
+			replace_child(parent(z), z, todelete);
+			set_parent(todelete, parent(z));
+			// the color is a property of the position
+			bool black = is_black(todelete);
+			set_black(todelete, is_black(z));
+			set_black(z, black);
+		}
+		else {
+			father = parent(z);
+			if (son != 0)
+				set_parent(son, father);
+			replace_child(father, z, son);
+		}
+		if (is_black(z))
+			erase_fixup(son, father);
+		node(z).left = free_head;
+		free_head = z;
+		--__size;
+	}
+
+	template<typename T, typename Compare, typename Alloc>
+	void arena_set<T, Compare, Alloc>::erase_fixup(size_type son, size_type father) {
+		// son carries an extra black, push it up or end it by rotations
+		while (son != root && is_black(son)) {
+			if (son == node(father).left) {
+				size_type brother = node(father).right;
+				if (!is_black(brother)) {
+					set_black(brother, true);
+					set_black(father, false);
+					rotate_left(father);
+					brother = node(father).right;
+				}
+				if (is_black(node(brother).left) && is_black(node(brother).right)) {
+					set_black(brother, false);
+					son = father;
+					father = parent(father);
+					continue;
+				}
+				if (is_black(node(brother).right)) {
+					set_black(node(brother).left, true);
+					set_black(brother, false);
+					rotate_right(brother);
+					brother = node(father).right;
+				}
+				set_black(brother, is_black(father));
+				set_black(father, true);
+				set_black(node(brother).right, true);
+				rotate_left(father);
+				son = root;
+			}
+			else {
+				size_type brother = node(father).left;
+				if (!is_black(brother)) {
+					set_black(brother, true);
+					set_black(father, false);
+					rotate_right(father);
+					brother = node(father).left;
+				}
+				if (is_black(node(brother).right) && is_black(node(brother).left)) {
+					set_black(brother, false);
+					son = father;
+					father = parent(father);
+					continue;
+				}
+				if (is_black(node(brother).left)) {
+					set_black(node(brother).right, true);
+					set_black(brother, false);
+					rotate_left(brother);
+					brother = node(father).left;
+				}
+				set_black(brother, is_black(father));
+				set_black(father, true);
+				set_black(node(brother).left, true);
+				rotate_right(father);
+				son = root;
+			}
+		}
+		if (son != 0)
+			set_black(son, true);
+	}
+
+	template<typename T, typename Compare, typename Alloc>
+	typename arena_set<T, Compare, Alloc>::size_type arena_set<T, Compare, Alloc>::black_height(size_type x) const {
+		if (x == 0)
+			return 1;
+		size_type l = node(x).left;
+		size_type r = node(x).right;
+		// a red node must not have a red child, and the children must point back
+		if (!is_black(x) && (!is_black(l) || !is_black(r)))
+			return 0;
+		if ((l != 0 && parent(l) != x) || (r != 0 && parent(r) != x))
+			return 0;
+		if ((l != 0 && !less_than(node(l).data, node(x).data)) || (r != 0 && !less_than(node(x).data, node(r).data)))
+			return 0;
+		size_type left_height = black_height(l);
+		if (left_height == 0 || left_height != black_height(r))
+			return 0;
+		return left_height + (is_black(x) ? 1 : 0);
+	}
+
+	template<typename T, typename Compare, typename Alloc>
+	bool arena_set<T, Compare, Alloc>::isRBTree() const {
+		if (root == 0)
+			return __size == 0 && leftmost == 0 && rightmost == 0;
+		if (!is_black(root) || parent(root) != 0)
+			return false;
+		size_type first = root, last = root;
+		while (node(first).left != 0)
+			first = node(first).left;
+		while (node(last).right != 0)
+			last = node(last).right;
+		if (first != leftmost || last != rightmost)
+			return false;
+		return black_height(root) != 0;
+	}
+}
+
+#endif // !EZSTL_ARENA_SET_H
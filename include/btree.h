@@ -0,0 +1,841 @@
+/*********************************************************************************************/
+// class btree:
+// an internal class, basic data structure of btree_set and btree_map
+// a B-tree whose nodes hold up to node_slots sorted values in one array, node_slots is chosen to
+// fill about NodeBytes bytes (256 by default), so a search reads a few contiguous blocks
+// instead of one small node per level
+//
+// 1. iterator begin() const;
+// 2. iterator end() const;
+// 3. size_type size() const;
+// 4. bool empty() const;
+// 5. iterator find(const K& k) const;
+// 6. iterator lower_bound(const K& k) const;
+// 7. iterator upper_bound(const K& k) const;
+// 8. pair<iterator, iterator> equal_range(const K& k) const;
+// 9. pair<iterator, bool> insert(const T& v);
+// 10. iterator insert(iterator hint, const T& v);
+// 11. pair<iterator, bool> emplace(Args&&... args);
+// 12. iterator emplace_hint(iterator hint, Args&&... args);
+// 13. void insert(Iterator first, Iterator last);
+// 14. iterator erase(iterator pos);
+// 15. iterator erase(iterator first, iterator last);
+// 16. void for_each_in_range(const K& lo, const K& hi, Function f) const;
+// 17. void clear();
+// 18. Compare key_comp() const;
+// 19. value_compare value_comp() const;
+// 20. size_type node_count() const;
+// 21. size_type bytes_used() const;
+// only for debug:
+// 22. bool isBTree();
+//
+// keys are unique as in rbtree, KeyOfValue gives the key of a value, identity<T> for btree_set and
+// select1st for the pairs of btree_map, Compare orders the keys and may be a three-way comparator;
+// the lookups take any K that Compare compares with key_type; a node is searched with a
+// branchless binary search, the comparison picks the next half by a conditional move instead of a
+// jump, so arithmetic values cost no mispredicted branches; leaves carry no child pointers,
+// internal nodes carry node_slots + 1 of them
+//
+// insert splits a full node and moves its middle value up to the parent, the split leaves the new
+// value alone in its half when it goes at either end of the node, so ascending or descending values
+// fill the nodes; erase merges a node less than half full with a sibling when both fit in one node,
+// and moves one value over from the sibling otherwise
+//
+// iterator stability:
+// insert and erase move values between nodes, they invalidate all iterators, pointers and references;
+// insert returns an iterator to the inserted value and erase to the value after the erased one
+
+#ifndef EZSTL_BTREE_H
+#define EZSTL_BTREE_H
+
+#include "functional.h"
+#include "iterator.h"
+#include "memory.h"
+#include "utility.h"
+#include "vector.h"
+#include "algorithm.h"
+
+namespace ezSTL {
+
+	// number of values per node to fill about NodeBytes bytes with the values and the header, at least 3
+	template<typename T, unsigned int NodeBytes>
+	class __btree_slots {
+	public:
+		static const unsigned int header_bytes = 2 * sizeof(void*);
+		static const unsigned int value = NodeBytes >= header_bytes + 3 * sizeof(T) ? (NodeBytes - header_bytes) / sizeof(T) : 3;
+	};
+
+	// leaf node of btree, the values live in uninitialized storage, [0, count) are constructed
+	template<typename T, unsigned int Slots>
+	class __btree_node {
+		static_assert(Slots < 65536, "btree node positions are kept in 16 bits");
+	public:
+		using node_ptr = __btree_node<T, Slots>*;
+
+		node_ptr parent;
+		// index of this node in the children of parent
+		unsigned short position;
+		unsigned short count;
+		bool leaf;
+		alignas(T) unsigned char storage[sizeof(T) * Slots];
+
+		explicit __btree_node(bool is_leaf = true) : parent(nullptr), position(0), count(0), leaf(is_leaf) {}
+		T* values() {
+			return reinterpret_cast<T*>(storage);
+		}
+		T& value(unsigned int i) {
+			return values()[i];
+		}
+		// children of an internal node
+		node_ptr& child(unsigned int i);
+	};
+
+	// internal node of btree, child(i) holds the values between value(i - 1) and value(i)
+	template<typename T, unsigned int Slots>
+	class __btree_internal_node : public __btree_node<T, Slots> {
+	public:
+		typename __btree_node<T, Slots>::node_ptr children[Slots + 1];
+
+		__btree_internal_node() : __btree_node<T, Slots>(false) {}
+	};
+
+	template<typename T, unsigned int Slots>
+	inline typename __btree_node<T, Slots>::node_ptr& __btree_node<T, Slots>::child(unsigned int i) {
+		return static_cast<__btree_internal_node<T, Slots>*>(this)->children[i];
+	}
+
+	// iterator of btree, a node and the index of the value in it
+	// end() is the position after the last value of the rightmost leaf
+	template<typename T, unsigned int Slots>
+	class __btree_iterator : public iterator<bidirectional_iterator_tag, T> {
+	public:
+		using iterator = __btree_iterator<T, Slots>;
+		using self = __btree_iterator<T, Slots>;
+		using node_ptr = __btree_node<T, Slots>*;
+		using pointer = T*;
+		using reference = T&;
+		using difference_type = int;
+
+		node_ptr node;
+		unsigned int position;
+
+		__btree_iterator() = default;
+		__btree_iterator(node_ptr x, unsigned int i) : node(x), position(i) {}
+
+		bool operator== (const self& x) const {
+			return node == x.node && position == x.position;
+		}
+		bool operator!= (const self& x) const {
+			return !(*this == x);
+		}
+		reference operator*() const {
+			return node->value(position);
+		}
+		pointer operator->() const {
+			return &(operator*());
+		}
+		self& operator++() {
+			// an internal value is followed by the leftmost value of its right subtree
+			if (!node->leaf) {
+				node = node->child(position + 1);
+				while (!node->leaf)
+					node = node->child(0);
+				position = 0;
+				return *this;
+			}
+			if (++position < node->count)
+				return *this;
+			// the end of a leaf: climb to the first ancestor with a value after this subtree,
+			// after the last value stay at end()
+			self last = *this;
+			while (position == node->count && node->parent != nullptr) {
+				position = node->position;
+				node = node->parent;
+			}
+			if (position == node->count)
+				*this = last;
+			return *this;
+		}
+		self operator++(int) {
+			self temp = *this;
+			++(*this);
+			return temp;
+		}
+		self& operator--() {
+			// an internal value is preceded by the rightmost value of its left subtree
+			if (!node->leaf) {
+				node = node->child(position);
+				while (!node->leaf)
+					node = node->child(node->count);
+				position = node->count - 1;
+				return *this;
+			}
+			if (position > 0) {
+				--position;
+				return *this;
+			}
+			while (position == 0 && node->parent != nullptr) {
+				position = node->position;
+				node = node->parent;
+			}
+			--position;
+			return *this;
+		}
+		self operator--(int) {
+			self temp = *this;
+			--(*this);
+			return temp;
+		}
+
+		self operator+ (difference_type n) const {
+			self temp = *this;
+			ezSTL::advance(temp, n);
+			return temp;
+		}
+		self operator- (difference_type n) const {
+			self temp = *this;
+			ezSTL::advance(temp, -n);
+			return temp;
+		}
+	};
+
+	// B-tree class
+	// Alloc is rebound to the node types, KeyOfValue gives the key of a value and Compare orders the keys
+	template<typename T, typename Compare = less<T>, typename Alloc = allocator<T>, unsigned int NodeBytes = 256,
+		typename KeyOfValue = identity<T>>
+	class btree {
+	public:
+		static const unsigned int node_slots = __btree_slots<T, NodeBytes>::value;
+		// a node other than the root with fewer values is merged with or refilled from a sibling
+		static const unsigned int min_slots = node_slots / 2;
+
+		using node_type = __btree_node<T, node_slots>;
+		using internal_node_type = __btree_internal_node<T, node_slots>;
+		using node_ptr = node_type*;
+		using leaf_allocator = typename Alloc::template rebind<node_type>::other;
+		using internal_allocator = typename Alloc::template rebind<internal_node_type>::other;
+		using data_allocator = typename Alloc::template rebind<T>::other;
+		using size_type = unsigned int;
+		using key_type = typename KeyOfValue::key_type;
+		using value_type = T;
+		using value_compare = __key_value_compare<T, Compare, KeyOfValue>;
+		using iterator = __btree_iterator<T, node_slots>;
+		using const_iterator = const iterator;
+		using reference = value_type&;
+		using const_reference = const T&;
+		using difference_type = int;
+
+	protected:
+		// data members of btree, all nullptr in an empty tree
+		node_ptr __root;
+		node_ptr __leftmost;
+		node_ptr __rightmost;
+		size_type __size;
+		size_type __leaf_count;
+		size_type __internal_count;
+		Compare cmp;
+
+	public:
+		// constructor
+		btree() : __root(nullptr), __leftmost(nullptr), __rightmost(nullptr), __size(0), __leaf_count(0), __internal_count(0) {}
+		btree(const btree& t) : btree() {
+			cmp = t.cmp;
+			insert(t.begin(), t.end());
+		}
+		btree(btree&& t) noexcept : btree() {
+			swap(t);
+		}
+		btree& operator=(const btree& t) {
+			if (this != &t) {
+				clear();
+				cmp = t.cmp;
+				insert(t.begin(), t.end());
+			}
+			return *this;
+		}
+		btree& operator=(btree&& t) noexcept {
+			swap(t);
+			return *this;
+		}
+		~btree() {
+			clear();
+		}
+
+		// some outer interfaces
+		iterator begin() const {
+			return iterator(__leftmost, 0);
+		}
+		iterator end() const {
+			return iterator(__rightmost, __rightmost == nullptr ? 0 : __rightmost->count);
+		}
+		bool empty() const {
+			return __size == 0;
+		}
+		size_type size() const {
+			return __size;
+		}
+
+		// the lookups take a key, or anything Compare compares with keys
+		template<typename K>
+		iterator find(const K& k) const;
+		template<typename K>
+		iterator lower_bound(const K& k) const;
+		template<typename K>
+		iterator upper_bound(const K& k) const;
+		template<typename K>
+		pair<iterator, iterator> equal_range(const K& k) const;
+		pair<iterator, bool> insert(const value_type& v) {
+			return insert_unique(v);
+		}
+		iterator insert(iterator hint, const value_type& v) {
+			return insert_hint_unique(hint, v);
+		}
+		template<typename... Args>
+		pair<iterator, bool> emplace(Args&&... args) {
+			// the value is only known once it is built
+			return insert_unique(value_type(ezSTL::forward<Args>(args)...));
+		}
+		template<typename... Args>
+		iterator emplace_hint(iterator hint, Args&&... args) {
+			return insert_hint_unique(hint, value_type(ezSTL::forward<Args>(args)...));
+		}
+		template<typename Iterator>
+		void insert(Iterator first, Iterator last);
+		iterator erase(iterator pos);
+		iterator erase(iterator first, iterator last);
+		template<typename K, typename Function>
+		void for_each_in_range(const K& lo, const K& hi, Function f) const;
+		void clear();
+		void swap(btree& other) noexcept;
+		Compare key_comp() const {
+			return cmp;
+		}
+		value_compare value_comp() const {
+			return value_compare(cmp);
+		}
+		// number of nodes, and the bytes they take with the tree object
+		size_type node_count() const {
+			return __leaf_count + __internal_count;
+		}
+		size_type bytes_used() const {
+			return sizeof(*this) + __leaf_count * sizeof(node_type) + __internal_count * sizeof(internal_node_type);
+		}
+
+		// interface for debug
+		// judge if the present tree is a B-tree
+		bool isBTree() const;
+
+	protected:
+		static const key_type& key(const value_type& v) {
+			return KeyOfValue()(v);
+		}
+		// x < y by Compare of either kind
+		template<typename A, typename B>
+		bool less_than(const A& x, const B& y) const {
+			return __compare_traits<Compare>::less(cmp, x, y);
+		}
+		// index of the first value of x whose key is not less than k, and of the first one greater than k;
+		// the loop keeps a window of n values from base, one comparison halves it without a branch
+		template<typename K>
+		unsigned int lower_index(node_ptr x, const K& k) const {
+			const T* first = x->values();
+			const T* base = first;
+			unsigned int n = x->count;
+			while (n > 1) {
+				unsigned int half = n / 2;
+				base = less_than(key(base[half]), k) ? base + half : base;
+				n -= half;
+			}
+			return static_cast<unsigned int>(base - first) + (less_than(key(*base), k) ? 1 : 0);
+		}
+		template<typename K>
+		unsigned int upper_index(node_ptr x, const K& k) const {
+			const T* first = x->values();
+			const T* base = first;
+			unsigned int n = x->count;
+			while (n > 1) {
+				unsigned int half = n / 2;
+				base = less_than(k, key(base[half])) ? base : base + half;
+				n -= half;
+			}
+			return static_cast<unsigned int>(base - first) + (less_than(k, key(*base)) ? 0 : 1);
+		}
+		node_ptr new_leaf() {
+			node_ptr x = leaf_allocator().allocate();
+			leaf_allocator().construct(x);
+			++__leaf_count;
+			return x;
+		}
+		node_ptr new_internal() {
+			internal_node_type* x = internal_allocator().allocate();
+			internal_allocator().construct(x);
+			++__internal_count;
+			return x;
+		}
+		// release the node only, its values must be destroyed or moved out
+		void delete_node(node_ptr x) {
+			if (x->leaf) {
+				leaf_allocator().destroy(x);
+				leaf_allocator().deallocate(x);
+				--__leaf_count;
+			}
+			else {
+				internal_node_type* y = static_cast<internal_node_type*>(x);
+				internal_allocator().destroy(y);
+				internal_allocator().deallocate(y);
+				--__internal_count;
+			}
+		}
+		// move construct the value of src into dst and destroy src
+		static void relocate(T* dst, T* src) {
+			data_allocator().construct(dst, ezSTL::move(*src));
+			data_allocator().destroy(src);
+		}
+		// make y child i of x
+		static void set_child(node_ptr x, unsigned int i, node_ptr y) {
+			x->child(i) = y;
+			y->parent = x;
+			y->position = static_cast<unsigned short>(i);
+		}
+		template<typename V>
+		pair<iterator, bool> insert_unique(V&& v);
+		template<typename V>
+		iterator insert_hint_unique(iterator hint, V&& v);
+		// insert v at index i of x with right_child after it, nullptr in leaves; a full x is split first;
+		// a new value always goes into a leaf, a value with a right child moves up from a split
+		template<typename V>
+		iterator insert_value(node_ptr x, unsigned int i, V&& v, node_ptr right_child);
+		// move the separator i of parent and child i + 1 into child i, then remove child i + 1
+		void merge_children(node_ptr parent, unsigned int i);
+		// move one value from child i - 1 or child i + 1 of parent to child i through the separator
+		void shift_from_left(node_ptr parent, unsigned int i);
+		void shift_from_right(node_ptr parent, unsigned int i);
+		// refill the leaf x after a value left index i, return where the value after it is now
+		iterator rebalance_after_erase(node_ptr x, unsigned int i);
+		void destroy_subtree(node_ptr x);
+		// depth of the leaves under x, 0 if the subtree breaks a B-tree property
+		unsigned int check_subtree(node_ptr x, const value_type* lo, const value_type* hi) const;
+	};
+
+	// find the value of key k, O(lgn)
+	template<typename T, typename Compare, typename Alloc, unsigned int NodeBytes, typename KeyOfValue>
+	template<typename K>
+	typename btree<T, Compare, Alloc, NodeBytes, KeyOfValue>::iterator btree<T, Compare, Alloc, NodeBytes, KeyOfValue>::find(const K& k) const {
+		node_ptr x = __root;
+		while (x != nullptr) {
+			unsigned int i = lower_index(x, k);
+			if (i < x->count && !less_than(k, key(x->value(i))))
+				return iterator(x, i);
+			x = x->leaf ? nullptr : x->child(i);
+		}
+		return end();
+	}
+
+	// the first value whose key is not less than k, end() if none; O(lgn)
+	template<typename T, typename Compare, typename Alloc, unsigned int NodeBytes, typename KeyOfValue>
+	template<typename K>
+	typename btree<T, Compare, Alloc, NodeBytes, KeyOfValue>::iterator btree<T, Compare, Alloc, NodeBytes, KeyOfValue>::lower_bound(const K& k) const {
+		iterator result = end();
+		node_ptr x = __root;
+		while (x != nullptr) {
+			unsigned int i = lower_index(x, k);
+			if (i < x->count)
+				result = iterator(x, i);
+			x = x->leaf ? nullptr : x->child(i);
+		}
+		return result;
+	}
+
+	// the first value whose key is greater than k, end() if none; O(lgn)
+	template<typename T, typename Compare, typename Alloc, unsigned int NodeBytes, typename KeyOfValue>
+	template<typename K>
+	typename btree<T, Compare, Alloc, NodeBytes, KeyOfValue>::iterator btree<T, Compare, Alloc, NodeBytes, KeyOfValue>::upper_bound(const K& k) const {
+		iterator result = end();
+		node_ptr x = __root;
+		while (x != nullptr) {
+			unsigned int i = upper_index(x, k);
+			if (i < x->count)
+				result = iterator(x, i);
+			x = x->leaf ? nullptr : x->child(i);
+		}
+		return result;
+	}
+
+	template<typename T, typename Compare, typename Alloc, unsigned int NodeBytes, typename KeyOfValue>
+	template<typename K>
+	pair<typename btree<T, Compare, Alloc, NodeBytes, KeyOfValue>::iterator, typename btree<T, Compare, Alloc, NodeBytes, KeyOfValue>::iterator>
+		btree<T, Compare, Alloc, NodeBytes, KeyOfValue>::equal_range(const K& k) const {
+		iterator first = lower_bound(k);
+		iterator last = first;
+		if (last != end() && !less_than(k, key(*last)))
+			++last;
+		return pair<iterator, iterator>(first, last);
+	}
+
+	template<typename T, typename Compare, typename Alloc, unsigned int NodeBytes, typename KeyOfValue>
+	template<typename V>
+	pair<typename btree<T, Compare, Alloc, NodeBytes, KeyOfValue>::iterator, bool> btree<T, Compare, Alloc, NodeBytes, KeyOfValue>::insert_unique(V&& v) {
+		if (__root == nullptr) {
+			__root = __leftmost = __rightmost = new_leaf();
+			return pair<iterator, bool>(insert_value(__root, 0, ezSTL::forward<V>(v), nullptr), true);
+		}
+		// search down to a leaf first, nothing moves when the key of v is already there
+		const key_type& k = key(v);
+		node_ptr x = __root;
+		while (true) {
+			unsigned int i = lower_index(x, k);
+			if (i < x->count && !less_than(k, key(x->value(i))))
+				return pair<iterator, bool>(iterator(x, i), false);
+			if (x->leaf)
+				return pair<iterator, bool>(insert_value(x, i, ezSTL::forward<V>(v), nullptr), true);
+			x = x->child(i);
+		}
+	}
+
+	template<typename T, typename Compare, typename Alloc, unsigned int NodeBytes, typename KeyOfValue>
+	template<typename V>
+	typename btree<T, Compare, Alloc, NodeBytes, KeyOfValue>::iterator btree<T, Compare, Alloc, NodeBytes, KeyOfValue>::insert_hint_unique(iterator hint, V&& v) {
+		if (empty())
+			return insert_unique(ezSTL::forward<V>(v)).first;
+		const key_type& k = key(v);
+		// v goes right before hint: into the leaf of hint, or after the value before hint which is in a leaf
+		if (hint == end() || less_than(k, key(*hint))) {
+			if (hint == begin())
+				return insert_value(__leftmost, 0, ezSTL::forward<V>(v), nullptr);
+			iterator before = hint;
+			--before;
+			if (less_than(key(*before), k)) {
+				if (hint != end() && hint.node->leaf)
+					return insert_value(hint.node, hint.position, ezSTL::forward<V>(v), nullptr);
+				return insert_value(before.node, before.position + 1, ezSTL::forward<V>(v), nullptr);
+			}
+			return insert_unique(ezSTL::forward<V>(v)).first;
+		}
+		// v goes right after hint
+		if (less_than(key(*hint), k)) {
+			iterator after = hint;
+			++after;
+			if (after == end() || less_than(k, key(*after))) {
+				if (hint.node->leaf)
+					return insert_value(hint.node, hint.position + 1, ezSTL::forward<V>(v), nullptr);
+				return insert_value(after.node, after.position, ezSTL::forward<V>(v), nullptr);
+			}
+			return insert_unique(ezSTL::forward<V>(v)).first;
+		}
+		// equal to hint
+		return hint;
+	}
+
+	template<typename T, typename Compare, typename Alloc, unsigned int NodeBytes, typename KeyOfValue>
+	template<typename V>
+	typename btree<T, Compare, Alloc, NodeBytes, KeyOfValue>::iterator
+		btree<T, Compare, Alloc, NodeBytes, KeyOfValue>::insert_value(node_ptr x, unsigned int i, V&& v, node_ptr right_child) {
+		if (x->count == node_slots) {
+			// split x: values [0, left_count) stay, value left_count moves up, the rest goes to a new node y;
+			// a value at either end of x gets a half of its own
+			unsigned int left_count = i == node_slots ? node_slots - 1 : (i == 0 ? 0 : node_slots / 2);
+			node_ptr y = x->leaf ? new_leaf() : new_internal();
+			for (unsigned int j = left_count + 1; j < node_slots; ++j)
+				relocate(y->values() + (j - left_count - 1), x->values() + j);
+			if (!x->leaf)
+				for (unsigned int j = left_count + 1; j <= node_slots; ++j)
+					set_child(y, j - left_count - 1, x->child(j));
+			y->count = static_cast<unsigned short>(node_slots - left_count - 1);
+			x->count = static_cast<unsigned short>(left_count);
+			if (x == __rightmost)
+				__rightmost = y;
+			value_type middle(ezSTL::move(x->value(left_count)));
+			data_allocator().destroy(x->values() + left_count);
+			if (x->parent == nullptr) {
+				node_ptr root = new_internal();
+				set_child(root, 0, x);
+				__root = root;
+			}
+			insert_value(x->parent, x->position, ezSTL::move(middle), y);
+			if (i > left_count) {
+				x = y;
+				i -= left_count + 1;
+			}
+		}
+		// shift [i, count) one place up and construct v in the gap
+		T* values = x->values();
+		for (unsigned int j = x->count; j > i; --j)
+			relocate(values + j, values + j - 1);
+		data_allocator().construct(values + i, ezSTL::forward<V>(v));
+		if (right_child != nullptr) {
+			for (unsigned int j = x->count + 1; j > i + 1; --j)
+				set_child(x, j, x->child(j - 1));
+			set_child(x, i + 1, right_child);
+		}
+		else
+			++__size;
+		++x->count;
+		return iterator(x, i);
+	}
+
+	template<typename T, typename Compare, typename Alloc, unsigned int NodeBytes, typename KeyOfValue>
+	template<typename Iterator>
+	void btree<T, Compare, Alloc, NodeBytes, KeyOfValue>::insert(Iterator first, Iterator last) {
+		// sorted values into an empty tree are appended at the end of the rightmost leaf
+		// and fill every node but the last ones
+		if (!empty() || ezSTL::is_sorted(first, last, value_comp())) {
+			iterator hint = end();
+			for (; first != last; ++first) {
+				hint = insert(hint, *first);
+				++hint;
+			}
+			return;
+		}
+		vector<value_type> buffer;
+		for (; first != last; ++first)
+			buffer.push_back(*first);
+		// stable, so of equal values the first is inserted, as when inserting them one by one
+		ezSTL::stable_sort(buffer.begin(), buffer.end(), value_comp());
+		for (unsigned int i = 0; i < buffer.size(); ++i)
+			insert(end(), buffer[i]);
+	}
+
+	template<typename T, typename Compare, typename Alloc, unsigned int NodeBytes, typename KeyOfValue>
+	typename btree<T, Compare, Alloc, NodeBytes, KeyOfValue>::iterator btree<T, Compare, Alloc, NodeBytes, KeyOfValue>::erase(iterator pos) {
+		node_ptr x = pos.node;
+		unsigned int i = pos.position;
+		// an internal value is replaced by the value before it, which is the last value of a leaf
+		bool internal = !x->leaf;
+		if (internal) {
+			iterator before = pos;
+			--before;
+			x->value(i) = ezSTL::move(*before);
+			x = before.node;
+			i = before.position;
+		}
+		T* values = x->values();
+		data_allocator().destroy(values + i);
+		for (unsigned int j = i + 1; j < x->count; ++j)
+			relocate(values + j - 1, values + j);
+		--x->count;
+		--__size;
+		iterator result = rebalance_after_erase(x, i);
+		if (empty())
+			return end();
+		// result is after the last value of its leaf: step back and forward to climb to the value after it
+		if (result.position == result.node->count) {
+			--result.position;
+			++result;
+		}
+		// the value before the erased one took its place, the value after it comes next
+		if (internal)
+			++result;
+		return result;
+	}
+
+	template<typename T, typename Compare, typename Alloc, unsigned int NodeBytes, typename KeyOfValue>
+	typename btree<T, Compare, Alloc, NodeBytes, KeyOfValue>::iterator btree<T, Compare, Alloc, NodeBytes, KeyOfValue>::erase(iterator first, iterator last) {
+		if (first == begin() && last == end()) {
+			clear();
+			return end();
+		}
+		// erase moves values, count them before the iterators go stale
+		size_type n = 0;
+		for (iterator ite = first; ite != last; ++ite)
+			++n;
+		for (; n > 0; --n)
+			first = erase(first);
+		return first;
+	}
+
+	template<typename T, typename Compare, typename Alloc, unsigned int NodeBytes, typename KeyOfValue>
+	typename btree<T, Compare, Alloc, NodeBytes, KeyOfValue>::iterator btree<T, Compare, Alloc, NodeBytes, KeyOfValue>::rebalance_after_erase(node_ptr x, unsigned int i) {
+		iterator result(x, i);
+		while (x != __root && x->count < min_slots) {
+			node_ptr parent = x->parent;
+			unsigned int k = x->position;
+			node_ptr left = k > 0 ? parent->child(k - 1) : nullptr;
+			node_ptr right = k < parent->count ? parent->child(k + 1) : nullptr;
+			if (left != nullptr && left->count + x->count < node_slots) {
+				if (result.node == x)
+					result = iterator(left, left->count + 1 + result.position);
+				merge_children(parent, k - 1);
+			}
+			else if (right != nullptr && x->count + right->count < node_slots)
+				merge_children(parent, k);
+			else {
+				if (left != nullptr) {
+					shift_from_left(parent, k);
+					if (result.node == x)
+						++result.position;
+				}
+				else
+					shift_from_right(parent, k);
+				// the parent keeps its values
+				break;
+			}
+			x = parent;
+		}
+		// an empty root leaves the tree empty, or hands the tree over to its only child
+		if (__root->count == 0) {
+			node_ptr root = __root;
+			if (root->leaf)
+				__root = __leftmost = __rightmost = nullptr;
+			else {
+				__root = root->child(0);
+				__root->parent = nullptr;
+				__root->position = 0;
+			}
+			delete_node(root);
+		}
+		return result;
+	}
+
+	template<typename T, typename Compare, typename Alloc, unsigned int NodeBytes, typename KeyOfValue>
+	void btree<T, Compare, Alloc, NodeBytes, KeyOfValue>::merge_children(node_ptr parent, unsigned int i) {
+		node_ptr left = parent->child(i);
+		node_ptr right = parent->child(i + 1);
+		unsigned int n = left->count;
+		relocate(left->values() + n, parent->values() + i);
+		for (unsigned int j = 0; j < right->count; ++j)
+			relocate(left->values() + n + 1 + j, right->values() + j);
+		if (!left->leaf)
+			for (unsigned int j = 0; j <= right->count; ++j)
+				set_child(left, n + 1 + j, right->child(j));
+		left->count = static_cast<unsigned short>(n + 1 + right->count);
+		// close the gap of the separator and of right in parent
+		for (unsigned int j = i + 1; j < parent->count; ++j)
+			relocate(parent->values() + j - 1, parent->values() + j);
+		for (unsigned int j = i + 2; j <= parent->count; ++j)
+			set_child(parent, j - 1, parent->child(j));
+		--parent->count;
+		if (right == __rightmost)
+			__rightmost = left;
+		delete_node(right);
+	}
+
+	template<typename T, typename Compare, typename Alloc, unsigned int NodeBytes, typename KeyOfValue>
+	void btree<T, Compare, Alloc, NodeBytes, KeyOfValue>::shift_from_left(node_ptr parent, unsigned int i) {
+		node_ptr left = parent->child(i - 1);
+		node_ptr x = parent->child(i);
+		for (unsigned int j = x->count; j > 0; --j)
+			relocate(x->values() + j, x->values() + j - 1);
+		relocate(x->values(), parent->values() + i - 1);
+		relocate(parent->values() + i - 1, left->values() + left->count - 1);
+		if (!x->leaf) {
+			for (unsigned int j = x->count + 1; j > 0; --j)
+				set_child(x, j, x->child(j - 1));
+			set_child(x, 0, left->child(left->count));
+		}
+		--left->count;
+		++x->count;
+	}
+
+	template<typename T, typename Compare, typename Alloc, unsigned int NodeBytes, typename KeyOfValue>
+	void btree<T, Compare, Alloc, NodeBytes, KeyOfValue>::shift_from_right(node_ptr parent, unsigned int i) {
+		node_ptr x = parent->child(i);
+		node_ptr right = parent->child(i + 1);
+		relocate(x->values() + x->count, parent->values() + i);
+		relocate(parent->values() + i, right->values());
+		for (unsigned int j = 1; j < right->count; ++j)
+			relocate(right->values() + j - 1, right->values() + j);
+		if (!x->leaf) {
+			set_child(x, x->count + 1, right->child(0));
+			for (unsigned int j = 1; j <= right->count; ++j)
+				set_child(right, j - 1, right->child(j));
+		}
+		++x->count;
+		--right->count;
+	}
+
+	// f(value) for every value with a key in [lo, hi) in order
+	template<typename T, typename Compare, typename Alloc, unsigned int NodeBytes, typename KeyOfValue>
+	template<typename K, typename Function>
+	void btree<T, Compare, Alloc, NodeBytes, KeyOfValue>::for_each_in_range(const K& lo, const K& hi, Function f) const {
+		if (!less_than(lo, hi))
+			return;
+		iterator stop = lower_bound(hi);
+		for (iterator ite = lower_bound(lo); ite != stop; ++ite)
+			f(*ite);
+	}
+
+	template<typename T, typename Compare, typename Alloc, unsigned int NodeBytes, typename KeyOfValue>
+	void btree<T, Compare, Alloc, NodeBytes, KeyOfValue>::clear() {
+		if (__root != nullptr)
+			destroy_subtree(__root);
+		__root = __leftmost = __rightmost = nullptr;
+		__size = 0;
+	}
+
+	template<typename T, typename Compare, typename Alloc, unsigned int NodeBytes, typename KeyOfValue>
+	void btree<T, Compare, Alloc, NodeBytes, KeyOfValue>::destroy_subtree(node_ptr x) {
+		if (!x->leaf)
+			for (unsigned int i = 0; i <= x->count; ++i)
+				destroy_subtree(x->child(i));
+		for (unsigned int i = 0; i < x->count; ++i)
+			data_allocator().destroy(x->values() + i);
+		delete_node(x);
+	}
+
+	template<typename T, typename Compare, typename Alloc, unsigned int NodeBytes, typename KeyOfValue>
+	void btree<T, Compare, Alloc, NodeBytes, KeyOfValue>::swap(btree& other) noexcept {
+		ezSTL::swap(__root, other.__root);
+		ezSTL::swap(__leftmost, other.__leftmost);
+		ezSTL::swap(__rightmost, other.__rightmost);
+		ezSTL::swap(__size, other.__size);
+		ezSTL::swap(__leaf_count, other.__leaf_count);
+		ezSTL::swap(__internal_count, other.__internal_count);
+		ezSTL::swap(cmp, other.cmp);
+	}
+
+	template<typename T, typename Compare, typename Alloc, unsigned int NodeBytes, typename KeyOfValue>
+	bool btree<T, Compare, Alloc, NodeBytes, KeyOfValue>::isBTree() const {
+		if (__root == nullptr)
+			return __size == 0 && __leftmost == nullptr && __rightmost == nullptr;
+		if (__root->parent != nullptr || __root->count == 0)
+			return false;
+		if (check_subtree(__root, nullptr, nullptr) == 0)
+			return false;
+		// the leftmost and rightmost leaves, and the number of values
+		node_ptr x = __root;
+		while (!x->leaf)
+			x = x->child(0);
+		if (x != __leftmost)
+			return false;
+		x = __root;
+		while (!x->leaf)
+			x = x->child(x->count);
+		if (x != __rightmost)
+			return false;
+		size_type n = 0;
+		for (iterator ite = begin(); ite != end(); ++ite)
+			++n;
+		return n == __size;
+	}
+
+	template<typename T, typename Compare, typename Alloc, unsigned int NodeBytes, typename KeyOfValue>
+	unsigned int btree<T, Compare, Alloc, NodeBytes, KeyOfValue>::check_subtree(node_ptr x, const value_type* lo, const value_type* hi) const {
+		if (x->count > node_slots || (x != __root && x->count == 0))
+			return 0;
+		// the values are sorted and between the separators around x
+		for (unsigned int i = 0; i < x->count; ++i) {
+			if (lo != nullptr && !less_than(key(*lo), key(x->value(i))))
+				return 0;
+			if (hi != nullptr && !less_than(key(x->value(i)), key(*hi)))
+				return 0;
+			if (i > 0 && !less_than(key(x->value(i - 1)), key(x->value(i))))
+				return 0;
+		}
+		if (x->leaf)
+			return 1;
+		// every leaf is at the same depth
+		unsigned int depth = 0;
+		for (unsigned int i = 0; i <= x->count; ++i) {
+			node_ptr y = x->child(i);
+			if (y->parent != x || y->position != i)
+				return 0;
+			unsigned int d = check_subtree(y, i > 0 ? &x->value(i - 1) : lo, i < x->count ? &x->value(i) : hi);
+			if (d == 0 || (depth != 0 && d != depth))
+				return 0;
+			depth = d;
+		}
+		return depth + 1;
+	}
+}
+
+#endif // !EZSTL_BTREE_H
@@ -0,0 +1,205 @@
+/*********************************************************************************************/
+// class btree_map:
+// using btree as base container, the interface of map without merge, node handles, clone_from,
+// deferred_clear and order statistics;
+// NodeBytes is the size of a node, 256 bytes by default
+// including some basic functions of btree_map:
+//
+// 1. iterator begin() const;
+// 2. iterator end() const;
+// 3. size_type size() const;
+// 4. bool empty() const;
+// 5. iterator find(const Key& k) const;
+// 6. iterator lower_bound(const Key& k) const;
+// 7. iterator upper_bound(const Key& k) const;
+// 8. pair<iterator, iterator> equal_range(const Key& k) const;
+// 9. pair<iterator, bool> insert(const pair<Key, Value>& v);
+// 10. iterator insert(iterator hint, const pair<Key, Value>& v);
+// 11. pair<iterator, bool> emplace(Args&&... args);
+// 12. iterator emplace_hint(iterator hint, Args&&... args);
+// 13. void insert(Iterator first, Iterator last);
+// 14. iterator erase(iterator pos);
+// 15. iterator erase(iterator first, iterator last);
+// 16. void for_each_in_range(const Key& lo, const Key& hi, Function f) const;
+// 17. void clear();
+// 18. Compare key_comp() const;
+// 19. value_compare value_comp() const;
+// 20. Value& operator[] (const Key& k);
+// 21. Value& at(const Key& k) const;
+// 22. size_type count(const Key& k) const;
+// 23. bool contains(const Key& k) const;
+// 24. size_type bytes_used() const;
+//
+// the pairs are ordered by Compare on their keys only as in map, a lookup compares keys and builds
+// no pair and no Value; at throws std::out_of_range for a missing key; with a transparent Compare
+// such as less<>, the lookups also take any K comparable with Key
+//
+// a node holds many pairs in one array, so a btree_map takes a few bytes per pair besides
+// the pairs and a search reads a few nodes; insert and erase move pairs between nodes
+// and invalidate all iterators, insert and erase return the iterators to go on with
+
+#ifndef EZSTL_BTREE_MAP_H
+#define EZSTL_BTREE_MAP_H
+
+#include "btree.h"
+#include "functional.h"
+#include "memory.h"
+#include "utility.h"
+#include <stdexcept>
+
+namespace ezSTL {
+	template<typename Key, typename Value, typename Compare = less<Key>,
+		typename Alloc = allocator<pair<Key, Value>>, unsigned int NodeBytes = 256>
+	class btree_map {
+	public:
+		using base_tree = btree<pair<Key, Value>, Compare, Alloc, NodeBytes, select1st<pair<Key, Value>>>;
+		using size_type = unsigned int;
+		using key_type = Key;
+		using value_type = Value;
+		using iterator = typename base_tree::iterator;
+		using const_iterator = const iterator;
+		using value_compare = typename base_tree::value_compare;
+		using difference_type = int;
+	protected:
+		base_tree base_bt;
+	public:
+		// constructor
+		btree_map() = default;
+		template<typename Iterator>
+		btree_map(Iterator first, Iterator last) {
+			base_bt.insert(first, last);
+		}
+
+		iterator begin() const {
+			return base_bt.begin();
+		}
+		iterator end() const {
+			return base_bt.end();
+		}
+		size_type size() const {
+			return base_bt.size();
+		}
+		bool empty() const {
+			return base_bt.empty();
+		}
+		// find a pair according a specific Key
+		iterator find(const Key& k) const {
+			return base_bt.find(k);
+		}
+		// the first pair whose key is not less than k
+		iterator lower_bound(const Key& k) const {
+			return base_bt.lower_bound(k);
+		}
+		// the first pair whose key is greater than k
+		iterator upper_bound(const Key& k) const {
+			return base_bt.upper_bound(k);
+		}
+		pair<iterator, iterator> equal_range(const Key& k) const {
+			return base_bt.equal_range(k);
+		}
+		// the lookups by any K comparable with Key, only with a transparent Compare
+		template<typename K, typename = typename __if_transparent<Compare, K>::type>
+		iterator find(const K& k) const {
+			return base_bt.find(k);
+		}
+		template<typename K, typename = typename __if_transparent<Compare, K>::type>
+		iterator lower_bound(const K& k) const {
+			return base_bt.lower_bound(k);
+		}
+		template<typename K, typename = typename __if_transparent<Compare, K>::type>
+		iterator upper_bound(const K& k) const {
+			return base_bt.upper_bound(k);
+		}
+		template<typename K, typename = typename __if_transparent<Compare, K>::type>
+		pair<iterator, iterator> equal_range(const K& k) const {
+			return base_bt.equal_range(k);
+		}
+		// insert a pair, nothing changes if the key exists
+		pair<iterator, bool> insert(const pair<Key, Value>& v) {
+			return base_bt.insert(v);
+		}
+		// insert a pair, searching from the position before hint
+		iterator insert(iterator hint, const pair<Key, Value>& v) {
+			return base_bt.insert(hint, v);
+		}
+		template<typename... Args>
+		pair<iterator, bool> emplace(Args&&... args) {
+			return base_bt.emplace(ezSTL::forward<Args>(args)...);
+		}
+		template<typename... Args>
+		iterator emplace_hint(iterator hint, Args&&... args) {
+			return base_bt.emplace_hint(hint, ezSTL::forward<Args>(args)...);
+		}
+		// insert a range of pairs, sorted pairs into an empty map fill the nodes; of equal keys the first pair is inserted
+		template<typename Iterator>
+		void insert(Iterator first, Iterator last) {
+			base_bt.insert(first, last);
+		}
+		// erase an iterator, return the iterator to the next pair
+		iterator erase(iterator pos) {
+			return base_bt.erase(pos);
+		}
+		// erase a range of iterators, return the iterator to the pair after them
+		iterator erase(iterator first, iterator last) {
+			return base_bt.erase(first, last);
+		}
+		// f(p) for every pair p with a key in [lo, hi)
+		template<typename Function>
+		void for_each_in_range(const Key& lo, const Key& hi, Function f) const {
+			base_bt.for_each_in_range(lo, hi, f);
+		}
+		void clear() {
+			base_bt.clear();
+		}
+		Compare key_comp() const {
+			return base_bt.key_comp();
+		}
+		// orders the pairs by key
+		value_compare value_comp() const {
+			return base_bt.value_comp();
+		}
+		// the value of k, a value initialized Value is inserted first if k is missing
+		Value& operator[] (const Key& k) {
+			iterator ite = base_bt.lower_bound(k);
+			if (ite == end() || __compare_traits<Compare>::less(key_comp(), k, ite->first))
+				ite = base_bt.emplace_hint(ite, k, Value());
+			return ite->second;
+		}
+		// the value of k, std::out_of_range if k is missing
+		Value& at(const Key& k) const {
+			return checked_value(base_bt.find(k));
+		}
+		template<typename K, typename = typename __if_transparent<Compare, K>::type>
+		Value& at(const K& k) const {
+			return checked_value(base_bt.find(k));
+		}
+		// 1 if k is in the map, 0 otherwise
+		size_type count(const Key& k) const {
+			return base_bt.find(k) != end() ? 1 : 0;
+		}
+		template<typename K, typename = typename __if_transparent<Compare, K>::type>
+		size_type count(const K& k) const {
+			return base_bt.find(k) != end() ? 1 : 0;
+		}
+		bool contains(const Key& k) const {
+			return base_bt.find(k) != end();
+		}
+		template<typename K, typename = typename __if_transparent<Compare, K>::type>
+		bool contains(const K& k) const {
+			return base_bt.find(k) != end();
+		}
+		// bytes taken by the nodes and the map object
+		size_type bytes_used() const {
+			return base_bt.bytes_used();
+		}
+
+	protected:
+		Value& checked_value(iterator ite) const {
+			if (ite == end())
+				throw std::out_of_range("ezSTL::btree_map::at: key not found");
+			return ite->second;
+		}
+	};
+}
+
+#endif // !EZSTL_BTREE_MAP_H
@@ -0,0 +1,134 @@
+/*********************************************************************************************/
+// class btree_set:
+// using btree as base container, the same interface as set without the set operations
+// and order statistics; NodeBytes is the size of a node, 256 bytes by default
+// including some basic functions of btree_set:
+//
+// 1. iterator begin() const;
+// 2. iterator end() const;
+// 3. size_type size() const;
+// 4. bool empty() const;
+// 5. iterator find(const T& v) const;
+// 6. iterator lower_bound(const T& v) const;
+// 7. iterator upper_bound(const T& v) const;
+// 8. pair<iterator, iterator> equal_range(const T& v) const;
+// 9. pair<iterator, bool> insert(const T& v);
+// 10. iterator insert(iterator hint, const T& v);
+// 11. pair<iterator, bool> emplace(Args&&... args);
+// 12. iterator emplace_hint(iterator hint, Args&&... args);
+// 13. void insert(Iterator first, Iterator last);
+// 14. iterator erase(iterator pos);
+// 15. iterator erase(iterator first, iterator last);
+// 16. void for_each_in_range(const T& lo, const T& hi, Function f) const;
+// 17. void clear();
+// 18. Compare value_comp() const;
+// 19. size_type bytes_used() const;
+//
+// a node holds many values in one array, so a btree_set takes a few bytes per value besides
+// the values and a search reads a few nodes; insert and erase move values between nodes
+// and invalidate all iterators, insert and erase return the iterators to go on with
+
+#ifndef EZSTL_BTREE_SET_H
+#define EZSTL_BTREE_SET_H
+
+#include "btree.h"
+#include "functional.h"
+#include "memory.h"
+#include "utility.h"
+
+namespace ezSTL {
+	template<typename T, typename Compare = less<T>, typename Alloc = allocator<T>, unsigned int NodeBytes = 256>
+	class btree_set {
+	public:
+		using size_type = unsigned int;
+		using value_type = T;
+		using iterator = typename btree<T, Compare, Alloc, NodeBytes>::iterator;
+		using const_iterator = const iterator;
+		using reference = value_type&;
+		using const_reference = const T&;
+		using difference_type = int;
+	protected:
+		btree<T, Compare, Alloc, NodeBytes> base_bt;
+	public:
+		// constructor
+		btree_set() = default;
+		template<typename Iterator>
+		btree_set(Iterator first, Iterator last) {
+			base_bt.insert(first, last);
+		}
+
+		iterator begin() const {
+			return base_bt.begin();
+		}
+		iterator end() const {
+			return base_bt.end();
+		}
+		size_type size() const {
+			return base_bt.size();
+		}
+		bool empty() const {
+			return base_bt.empty();
+		}
+		// find a value
+		iterator find(const T& v) const {
+			return base_bt.find(v);
+		}
+		// the first value not less than v
+		iterator lower_bound(const T& v) const {
+			return base_bt.lower_bound(v);
+		}
+		// the first value greater than v
+		iterator upper_bound(const T& v) const {
+			return base_bt.upper_bound(v);
+		}
+		pair<iterator, iterator> equal_range(const T& v) const {
+			return base_bt.equal_range(v);
+		}
+		// insert a value, nothing changes if an equal value exists
+		pair<iterator, bool> insert(const T& v) {
+			return base_bt.insert(v);
+		}
+		// insert a value, searching from the position before hint
+		iterator insert(iterator hint, const T& v) {
+			return base_bt.insert(hint, v);
+		}
+		template<typename... Args>
+		pair<iterator, bool> emplace(Args&&... args) {
+			return base_bt.emplace(ezSTL::forward<Args>(args)...);
+		}
+		template<typename... Args>
+		iterator emplace_hint(iterator hint, Args&&... args) {
+			return base_bt.emplace_hint(hint, ezSTL::forward<Args>(args)...);
+		}
+		// insert a range of values, sorted values into an empty set fill the nodes
+		template<typename Iterator>
+		void insert(Iterator first, Iterator last) {
+			base_bt.insert(first, last);
+		}
+		// erase an iterator, return the iterator to the next value
+		iterator erase(iterator pos) {
+			return base_bt.erase(pos);
+		}
+		// erase a range of iterators, return the iterator to the value after them
+		iterator erase(iterator first, iterator last) {
+			return base_bt.erase(first, last);
+		}
+		// f(v) for every value v in [lo, hi)
+		template<typename Function>
+		void for_each_in_range(const T& lo, const T& hi, Function f) const {
+			base_bt.for_each_in_range(lo, hi, f);
+		}
+		void clear() {
+			base_bt.clear();
+		}
+		Compare value_comp() const {
+			return base_bt.key_comp();
+		}
+		// bytes taken by the nodes and the set object
+		size_type bytes_used() const {
+			return base_bt.bytes_used();
+		}
+	};
+}
+
+#endif // !EZSTL_BTREE_SET_H
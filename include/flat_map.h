@@ -0,0 +1,377 @@
+/*********************************************************************************************/
+// class flat_map:
+// using two sorted vectors as basic data structure, the keys in one array and the values at the
+// same indexes in another, so a lookup only reads keys and a key array of unsigned ints is
+// 16 keys per cache line; the interface of map on the two arrays
+// including some basic functions of flat_map:
+//
+// 1. iterator begin() const;
+// 2. iterator end() const;
+// 3. size_type size() const;
+// 4. bool empty() const;
+// 5. iterator find(const Key& k) const;
+// 6. iterator lower_bound(const Key& k) const;
+// 7. iterator upper_bound(const Key& k) const;
+// 8. pair<iterator, iterator> equal_range(const Key& k) const;
+// 9. pair<iterator, bool> insert(const pair<Key, Value>& v);
+// 10. iterator insert(iterator hint, const pair<Key, Value>& v);
+// 11. pair<iterator, bool> emplace(Args&&... args);
+// 12. iterator emplace_hint(iterator hint, Args&&... args);
+// 13. void insert(Iterator first, Iterator last);
+// 14. iterator erase(iterator pos);
+// 15. iterator erase(iterator first, iterator last);
+// 16. void for_each_in_range(const Key& lo, const Key& hi, Function f) const;
+// 17. void clear();
+// 18. Compare key_comp() const;
+// 19. void merge(flat_map& batch);
+// 20. void reserve(size_type n);
+// 21. size_type bytes_used() const;
+//
+// Compare orders the keys, not the pairs as in map;
+// *ite is a proxy with the members first and second referring into the two arrays,
+// ite->first and ite->second work as for map, a pair<Key, Value> is only built on request
+//
+// insert and erase of one pair shift the pairs after it, O(n); insert(first, last) and merge
+// sort the range by key with ezSTL::stable_sort and merge it with the present pairs once, O(n + m lgm);
+// insert keeps the present value of an existing key, merge replaces it with the value of the batch;
+// of equal keys within the range the first pair is inserted, as map::insert(first, last) does
+//
+// iterator stability:
+// insert and erase move pairs, they invalidate all iterators
+
+#ifndef EZSTL_FLAT_MAP_H
+#define EZSTL_FLAT_MAP_H
+
+#include "functional.h"
+#include "iterator.h"
+#include "memory.h"
+#include "utility.h"
+#include "vector.h"
+#include "algorithm.h"
+
+namespace ezSTL {
+
+	// what *ite of flat_map refers to, a key and its value in the two arrays
+	template<typename Key, typename Value>
+	class __flat_map_reference {
+	public:
+		const Key& first;
+		Value& second;
+
+		__flat_map_reference(const Key& k, Value& v) : first(k), second(v) {}
+		// lets ite->first work through the proxy returned by the iterator
+		__flat_map_reference* operator->() {
+			return this;
+		}
+		operator pair<Key, Value>() const {
+			return pair<Key, Value>(first, second);
+		}
+	};
+
+	// flat_map iterator, a random access position in both arrays
+	template<typename Key, typename Value>
+	class __flat_map_iterator : public iterator<random_access_iterator_tag, pair<Key, Value>, int,
+		__flat_map_reference<Key, Value>, __flat_map_reference<Key, Value>> {
+	public:
+		using self = __flat_map_iterator<Key, Value>;
+		using reference = __flat_map_reference<Key, Value>;
+		using difference_type = int;
+
+		Key* key;
+		Value* value;
+
+		__flat_map_iterator() = default;
+		__flat_map_iterator(Key* k, Value* v) : key(k), value(v) {}
+
+		bool operator== (const self& x) const {
+			return key == x.key;
+		}
+		bool operator!= (const self& x) const {
+			return key != x.key;
+		}
+		bool operator< (const self& x) const {
+			return key < x.key;
+		}
+		reference operator*() const {
+			return reference(*key, *value);
+		}
+		reference operator->() const {
+			return operator*();
+		}
+		reference operator[] (difference_type n) const {
+			return reference(key[n], value[n]);
+		}
+		self& operator++() {
+			++key;
+			++value;
+			return *this;
+		}
+		self operator++(int) {
+			self temp = *this;
+			++(*this);
+			return temp;
+		}
+		self& operator--() {
+			--key;
+			--value;
+			return *this;
+		}
+		self operator--(int) {
+			self temp = *this;
+			--(*this);
+			return temp;
+		}
+		self& operator+= (difference_type n) {
+			key += n;
+			value += n;
+			return *this;
+		}
+		self operator+ (difference_type n) const {
+			return self(key + n, value + n);
+		}
+		self operator- (difference_type n) const {
+			return self(key - n, value - n);
+		}
+		difference_type operator- (const self& x) const {
+			return static_cast<difference_type>(key - x.key);
+		}
+	};
+
+	// class flat_map
+	template<typename Key, typename Value, typename Compare = less<Key>, typename Alloc = allocator<pair<Key, Value>>>
+	class flat_map {
+	public:
+		using size_type = unsigned int;
+		using value_type = Value;
+		using iterator = __flat_map_iterator<Key, Value>;
+		using const_iterator = const iterator;
+		using difference_type = int;
+		using key_allocator = typename Alloc::template rebind<Key>::other;
+		using value_allocator = typename Alloc::template rebind<Value>::other;
+	protected:
+		// keys[i] is the key of values[i], the keys in ascending order
+		vector<Key, key_allocator> keys;
+		vector<Value, value_allocator> values;
+		Compare cmp;
+	public:
+		// constructor
+		flat_map() = default;
+		template<typename Iterator>
+		flat_map(Iterator first, Iterator last) {
+			insert(first, last);
+		}
+
+		iterator begin() const {
+			return iterator(keys.begin(), values.begin());
+		}
+		iterator end() const {
+			return iterator(keys.end(), values.end());
+		}
+		size_type size() const {
+			return keys.size();
+		}
+		bool empty() const {
+			return keys.empty();
+		}
+		// find a pair according a specific Key
+		iterator find(const Key& k) const {
+			size_type i = index_of(k);
+			return i < size() && !cmp(k, keys[i]) ? begin() + i : end();
+		}
+		// the first pair whose key is not less than k
+		iterator lower_bound(const Key& k) const {
+			return begin() + index_of(k);
+		}
+		// the first pair whose key is greater than k
+		iterator upper_bound(const Key& k) const {
+			return begin() + __upper_bound_index(keys.begin(), size(), k, cmp);
+		}
+		pair<iterator, iterator> equal_range(const Key& k) const {
+			iterator ite = lower_bound(k);
+			return pair<iterator, iterator>(ite, ite != end() && !cmp(k, *ite.key) ? ite + 1 : ite);
+		}
+		// insert a pair, nothing changes if the key exists
+		pair<iterator, bool> insert(const pair<Key, Value>& v) {
+			size_type i = index_of(v.first);
+			if (i < size() && !cmp(v.first, keys[i]))
+				return pair<iterator, bool>(begin() + i, false);
+			return pair<iterator, bool>(insert_at(i, v.first, v.second), true);
+		}
+		// insert a pair, no search when it goes right before hint
+		iterator insert(iterator hint, const pair<Key, Value>& v) {
+			if ((hint == end() || cmp(v.first, *hint.key)) && (hint == begin() || cmp(*(hint.key - 1), v.first)))
+				return insert_at(hint - begin(), v.first, v.second);
+			return insert(v).first;
+		}
+		template<typename... Args>
+		pair<iterator, bool> emplace(Args&&... args) {
+			return insert(pair<Key, Value>(ezSTL::forward<Args>(args)...));
+		}
+		template<typename... Args>
+		iterator emplace_hint(iterator hint, Args&&... args) {
+			return insert(hint, pair<Key, Value>(ezSTL::forward<Args>(args)...));
+		}
+		// insert a range of pairs, the keys that exist keep their values, the first of equal keys is taken
+		template<typename Iterator>
+		void insert(Iterator first, Iterator last) {
+			vector<pair<Key, Value>, Alloc> batch;
+			for (; first != last; ++first)
+				batch.push_back(*first);
+			merge_sorted(batch, false);
+		}
+		// erase an iterator, return the iterator to the next pair
+		iterator erase(iterator pos) {
+			return erase(pos, pos + 1);
+		}
+		iterator erase(iterator first, iterator last);
+		// f(p) for every pair p with a key in [lo, hi), p is the proxy of *ite
+		template<typename Function>
+		void for_each_in_range(const Key& lo, const Key& hi, Function f) const {
+			if (!cmp(lo, hi))
+				return;
+			for (size_type i = index_of(lo), stop = index_of(hi); i < stop; ++i)
+				f(*(begin() + i));
+		}
+		void clear() {
+			keys.clear();
+			values.clear();
+		}
+		Compare key_comp() const {
+			return cmp;
+		}
+		// move the pairs of batch into this map, replacing the values of the keys that exist,
+		// batch is left empty
+		void merge(flat_map& batch);
+		void reserve(size_type n) {
+			keys.reserve(n);
+			values.reserve(n);
+		}
+		// bytes taken by the two arrays and the map object
+		size_type bytes_used() const {
+			return sizeof(*this) + keys.capacity() * sizeof(Key) + values.capacity() * sizeof(Value);
+		}
+
+	protected:
+		size_type index_of(const Key& k) const {
+			return __lower_bound_index(keys.begin(), size(), k, cmp);
+		}
+		// put (k, v) at index i, the pairs from i on move one place up
+		template<typename K, typename V>
+		iterator insert_at(size_type i, K&& k, V&& v);
+		// sort batch by key and merge it with the present pairs, batch wins on equal keys if replace is true
+		void merge_sorted(vector<pair<Key, Value>, Alloc>& batch, bool replace);
+	};
+
+	template<typename Key, typename Value, typename Compare, typename Alloc>
+	template<typename K, typename V>
+	typename flat_map<Key, Value, Compare, Alloc>::iterator
+		flat_map<Key, Value, Compare, Alloc>::insert_at(size_type i, K&& k, V&& v) {
+		size_type n = size();
+		if (i == n) {
+			keys.push_back(ezSTL::forward<K>(k));
+			values.push_back(ezSTL::forward<V>(v));
+			return begin() + i;
+		}
+		keys.push_back(ezSTL::move(keys[n - 1]));
+		values.push_back(ezSTL::move(values[n - 1]));
+		for (size_type j = n - 1; j > i; --j) {
+			keys[j] = ezSTL::move(keys[j - 1]);
+			values[j] = ezSTL::move(values[j - 1]);
+		}
+		keys[i] = ezSTL::forward<K>(k);
+		values[i] = ezSTL::forward<V>(v);
+		return begin() + i;
+	}
+
+	template<typename Key, typename Value, typename Compare, typename Alloc>
+	typename flat_map<Key, Value, Compare, Alloc>::iterator
+		flat_map<Key, Value, Compare, Alloc>::erase(iterator first, iterator last) {
+		if (first == last)
+			return first;
+		size_type i = first - begin();
+		size_type j = last - begin();
+		size_type n = size();
+		for (; j < n; ++i, ++j) {
+			keys[i] = ezSTL::move(keys[j]);
+			values[i] = ezSTL::move(values[j]);
+		}
+		for (; i < n; ++i) {
+			keys.pop_back();
+			values.pop_back();
+		}
+		return first;
+	}
+
+	template<typename Key, typename Value, typename Compare, typename Alloc>
+	void flat_map<Key, Value, Compare, Alloc>::merge(flat_map& batch) {
+		if (this == &batch)
+			return;
+		// the keys of batch are sorted and distinct already, the merge below keeps them in order
+		vector<pair<Key, Value>, Alloc> pairs;
+		pairs.reserve(batch.size());
+		for (size_type i = 0; i < batch.size(); ++i)
+			pairs.push_back(pair<Key, Value>(ezSTL::move(batch.keys[i]), ezSTL::move(batch.values[i])));
+		batch.clear();
+		merge_sorted(pairs, true);
+	}
+
+	template<typename Key, typename Value, typename Compare, typename Alloc>
+	void flat_map<Key, Value, Compare, Alloc>::merge_sorted(vector<pair<Key, Value>, Alloc>& batch, bool replace) {
+		if (batch.empty())
+			return;
+		Compare& key_cmp = cmp;
+		auto by_key = [&key_cmp](const pair<Key, Value>& a, const pair<Key, Value>& b) {
+			return key_cmp(a.first, b.first);
+		};
+		// stable, so the first of equal keys of the batch comes first and the later ones are dropped
+		if (!ezSTL::is_sorted(batch.begin(), batch.end(), by_key))
+			ezSTL::stable_sort(batch.begin(), batch.end(), by_key);
+		size_type m = batch.size();
+		// the batch goes after the present pairs: append it, dropping its equal keys
+		if (empty() || cmp(keys.back(), batch[0].first)) {
+			reserve(size() + m);
+			for (size_type i = 0; i < m; ++i) {
+				if (i > 0 && !cmp(keys.back(), batch[i].first))
+					continue;
+				keys.push_back(ezSTL::move(batch[i].first));
+				values.push_back(ezSTL::move(batch[i].second));
+			}
+			return;
+		}
+		// merge the present pairs and the batch into new arrays
+		size_type n = size();
+		vector<Key, key_allocator> merged_keys;
+		vector<Value, value_allocator> merged_values;
+		merged_keys.reserve(n + m);
+		merged_values.reserve(n + m);
+		size_type a = 0;
+		size_type b = 0;
+		while (a < n || b < m) {
+			if (b == m || (a < n && cmp(keys[a], batch[b].first))) {
+				merged_keys.push_back(ezSTL::move(keys[a]));
+				merged_values.push_back(ezSTL::move(values[a]));
+				++a;
+			}
+			else if (!merged_keys.empty() && !cmp(merged_keys.back(), batch[b].first)) {
+				// an equal key of the batch after a present pair or after an earlier pair of the batch
+				++b;
+			}
+			else if (a < n && !cmp(batch[b].first, keys[a])) {
+				// the key exists, keep it and take one of the two values
+				merged_keys.push_back(ezSTL::move(keys[a]));
+				merged_values.push_back(replace ? ezSTL::move(batch[b].second) : ezSTL::move(values[a]));
+				++a;
+				++b;
+			}
+			else {
+				merged_keys.push_back(ezSTL::move(batch[b].first));
+				merged_values.push_back(ezSTL::move(batch[b].second));
+				++b;
+			}
+		}
+		keys = ezSTL::move(merged_keys);
+		values = ezSTL::move(merged_values);
+	}
+}
+
+#endif // !EZSTL_FLAT_MAP_H
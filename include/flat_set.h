@@ -0,0 +1,301 @@
+/*********************************************************************************************/
+// class flat_set:
+// using a sorted vector as basic data structure, the interface of set on one contiguous array:
+// no node per value, a lookup is a binary search over the array
+// including some basic functions of flat_set:
+//
+// 1. iterator begin() const;
+// 2. iterator end() const;
+// 3. size_type size() const;
+// 4. bool empty() const;
+// 5. iterator find(const T& v) const;
+// 6. iterator lower_bound(const T& v) const;
+// 7. iterator upper_bound(const T& v) const;
+// 8. pair<iterator, iterator> equal_range(const T& v) const;
+// 9. pair<iterator, bool> insert(const T& v);
+// 10. iterator insert(iterator hint, const T& v);
+// 11. pair<iterator, bool> emplace(Args&&... args);
+// 12. iterator emplace_hint(iterator hint, Args&&... args);
+// 13. void insert(Iterator first, Iterator last);
+// 14. iterator erase(iterator pos);
+// 15. iterator erase(iterator first, iterator last);
+// 16. void for_each_in_range(const T& lo, const T& hi, Function f) const;
+// 17. void clear();
+// 18. Compare value_comp() const;
+// 19. void set_union(flat_set& other);
+// 20. void set_intersection(flat_set& other);
+// 21. void set_difference(flat_set& other);
+// 22. iterator nth(size_type k) const;
+// 23. size_type rank(const T& v) const;
+// 24. size_type count_range(const T& lo, const T& hi) const;
+// 25. void reserve(size_type n);
+// 26. size_type bytes_used() const;
+//
+// find, lower_bound and upper_bound run a branchless binary search that prefetches the next probes,
+// see __lower_bound_index in algorithm.h; nth, rank and count_range are O(1) and O(lgn) on the array
+//
+// insert and erase of one value shift the values after it, O(n); insert(first, last) appends the
+// whole range, sorts it with ezSTL::stable_sort and merges it with the present values once, O(n + m lgm);
+// a read mostly table is best built by the range constructor or by inserting ranges;
+// of equal values the present one is kept, the first of equal values in the range is inserted
+//
+// iterator stability:
+// insert and erase move values, they invalidate all iterators, pointers and references
+
+#ifndef EZSTL_FLAT_SET_H
+#define EZSTL_FLAT_SET_H
+
+#include "functional.h"
+#include "memory.h"
+#include "utility.h"
+#include "vector.h"
+#include "algorithm.h"
+
+namespace ezSTL {
+	template<typename T, typename Compare = less<T>, typename Alloc = allocator<T>>
+	class flat_set {
+	public:
+		using size_type = unsigned int;
+		using value_type = T;
+		using iterator = typename vector<T, Alloc>::iterator;
+		using const_iterator = const iterator;
+		using reference = value_type&;
+		using const_reference = const T&;
+		using difference_type = int;
+	protected:
+		// the values in ascending order
+		vector<T, Alloc> values;
+		Compare cmp;
+	public:
+		// constructor
+		flat_set() = default;
+		template<typename Iterator>
+		flat_set(Iterator first, Iterator last) {
+			insert(first, last);
+		}
+
+		iterator begin() const {
+			return values.begin();
+		}
+		iterator end() const {
+			return values.end();
+		}
+		size_type size() const {
+			return values.size();
+		}
+		bool empty() const {
+			return values.empty();
+		}
+		// find a value
+		iterator find(const T& v) const {
+			iterator ite = lower_bound(v);
+			return ite != end() && !cmp(v, *ite) ? ite : end();
+		}
+		// the first value not less than v
+		iterator lower_bound(const T& v) const {
+			return begin() + __lower_bound_index(begin(), size(), v, cmp);
+		}
+		// the first value greater than v
+		iterator upper_bound(const T& v) const {
+			return begin() + __upper_bound_index(begin(), size(), v, cmp);
+		}
+		pair<iterator, iterator> equal_range(const T& v) const {
+			iterator ite = lower_bound(v);
+			return pair<iterator, iterator>(ite, ite != end() && !cmp(v, *ite) ? ite + 1 : ite);
+		}
+		// insert a value, nothing changes if an equal value exists
+		pair<iterator, bool> insert(const T& v) {
+			return insert_unique(v);
+		}
+		// insert a value, no search when it goes right before hint
+		iterator insert(iterator hint, const T& v) {
+			return insert_hint_unique(hint, v);
+		}
+		template<typename... Args>
+		pair<iterator, bool> emplace(Args&&... args) {
+			return insert_unique(T(ezSTL::forward<Args>(args)...));
+		}
+		template<typename... Args>
+		iterator emplace_hint(iterator hint, Args&&... args) {
+			return insert_hint_unique(hint, T(ezSTL::forward<Args>(args)...));
+		}
+		template<typename Iterator>
+		void insert(Iterator first, Iterator last);
+		// erase an iterator, return the iterator to the next value
+		iterator erase(iterator pos) {
+			return erase(pos, pos + 1);
+		}
+		iterator erase(iterator first, iterator last);
+		// f(v) for every value v in [lo, hi)
+		template<typename Function>
+		void for_each_in_range(const T& lo, const T& hi, Function f) const {
+			if (!cmp(lo, hi))
+				return;
+			for (iterator ite = lower_bound(lo), stop = lower_bound(hi); ite != stop; ++ite)
+				f(*ite);
+		}
+		void clear() {
+			values.clear();
+		}
+		Compare value_comp() const {
+			return cmp;
+		}
+		// this = this | other, other is left empty
+		void set_union(flat_set& other) {
+			if (this == &other)
+				return;
+			insert(other.begin(), other.end());
+			other.clear();
+		}
+		// this = this & other, other is left empty
+		void set_intersection(flat_set& other) {
+			if (this != &other)
+				keep_if_in(other, true);
+		}
+		// this = this - other, other is left empty
+		void set_difference(flat_set& other) {
+			if (this == &other)
+				clear();
+			else
+				keep_if_in(other, false);
+		}
+		// the k-th smallest value counting from 0, end() if k >= size()
+		iterator nth(size_type k) const {
+			return k < size() ? begin() + k : end();
+		}
+		// the number of values less than v
+		size_type rank(const T& v) const {
+			return __lower_bound_index(begin(), size(), v, cmp);
+		}
+		// the number of values in [lo, hi)
+		size_type count_range(const T& lo, const T& hi) const {
+			return cmp(lo, hi) ? rank(hi) - rank(lo) : 0;
+		}
+		void reserve(size_type n) {
+			values.reserve(n);
+		}
+		// bytes taken by the array and the set object
+		size_type bytes_used() const {
+			return sizeof(*this) + values.capacity() * sizeof(T);
+		}
+
+	protected:
+		template<typename V>
+		pair<iterator, bool> insert_unique(V&& v);
+		template<typename V>
+		iterator insert_hint_unique(iterator hint, V&& v);
+		// put v at index i, the values from i on move one place up
+		template<typename V>
+		iterator insert_at(size_type i, V&& v);
+		// keep the values that are in other if in_other is true, or that are not if it is false
+		void keep_if_in(flat_set& other, bool in_other);
+	};
+
+	template<typename T, typename Compare, typename Alloc>
+	template<typename V>
+	pair<typename flat_set<T, Compare, Alloc>::iterator, bool> flat_set<T, Compare, Alloc>::insert_unique(V&& v) {
+		size_type i = __lower_bound_index(begin(), size(), v, cmp);
+		if (i < size() && !cmp(v, values[i]))
+			return pair<iterator, bool>(begin() + i, false);
+		return pair<iterator, bool>(insert_at(i, ezSTL::forward<V>(v)), true);
+	}
+
+	template<typename T, typename Compare, typename Alloc>
+	template<typename V>
+	typename flat_set<T, Compare, Alloc>::iterator flat_set<T, Compare, Alloc>::insert_hint_unique(iterator hint, V&& v) {
+		if ((hint == end() || cmp(v, *hint)) && (hint == begin() || cmp(*(hint - 1), v)))
+			return insert_at(hint - begin(), ezSTL::forward<V>(v));
+		return insert_unique(ezSTL::forward<V>(v)).first;
+	}
+
+	template<typename T, typename Compare, typename Alloc>
+	template<typename V>
+	typename flat_set<T, Compare, Alloc>::iterator flat_set<T, Compare, Alloc>::insert_at(size_type i, V&& v) {
+		size_type n = size();
+		if (i == n) {
+			values.push_back(ezSTL::forward<V>(v));
+			return begin() + i;
+		}
+		values.push_back(ezSTL::move(values[n - 1]));
+		for (size_type j = n - 1; j > i; --j)
+			values[j] = ezSTL::move(values[j - 1]);
+		values[i] = ezSTL::forward<V>(v);
+		return begin() + i;
+	}
+
+	template<typename T, typename Compare, typename Alloc>
+	template<typename Iterator>
+	void flat_set<T, Compare, Alloc>::insert(Iterator first, Iterator last) {
+		// append the range, then sort it once
+		size_type n = size();
+		for (; first != last; ++first)
+			values.push_back(*first);
+		if (size() == n)
+			return;
+		iterator tail = begin() + n;
+		// stable, so the first of equal values of the range comes first and the later ones are dropped
+		if (!ezSTL::is_sorted(tail, end(), cmp))
+			ezSTL::stable_sort(tail, end(), cmp);
+		// the range goes after the present values: drop the equal values of the range in place
+		if (n == 0 || cmp(values[n - 1], *tail)) {
+			size_type k = n + 1;
+			for (size_type i = n + 1; i < size(); ++i)
+				if (cmp(values[k - 1], values[i])) {
+					if (k != i)
+						values[k] = ezSTL::move(values[i]);
+					++k;
+				}
+			while (size() > k)
+				values.pop_back();
+			return;
+		}
+		// merge the two sorted runs into a new array, a present value goes first on ties
+		// and the equal values after it are dropped
+		vector<T, Alloc> merged;
+		merged.reserve(size());
+		iterator a = begin();
+		iterator b = tail;
+		while (a != tail || b != end()) {
+			iterator next = (b == end() || (a != tail && !cmp(*b, *a))) ? a++ : b++;
+			if (merged.empty() || cmp(merged.back(), *next))
+				merged.push_back(ezSTL::move(*next));
+		}
+		values = ezSTL::move(merged);
+	}
+
+	template<typename T, typename Compare, typename Alloc>
+	typename flat_set<T, Compare, Alloc>::iterator flat_set<T, Compare, Alloc>::erase(iterator first, iterator last) {
+		if (first == last)
+			return first;
+		// move the values after last down over the range
+		iterator dest = first;
+		for (iterator ite = last; ite != end(); ++ite)
+			*dest++ = ezSTL::move(*ite);
+		size_type n = last - first;
+		for (; n > 0; --n)
+			values.pop_back();
+		return first;
+	}
+
+	template<typename T, typename Compare, typename Alloc>
+	void flat_set<T, Compare, Alloc>::keep_if_in(flat_set& other, bool in_other) {
+		// walk both arrays once, compacting the kept values to the front
+		size_type k = 0;
+		iterator b = other.begin();
+		for (size_type i = 0; i < size(); ++i) {
+			while (b != other.end() && cmp(*b, values[i]))
+				++b;
+			bool found = b != other.end() && !cmp(values[i], *b);
+			if (found == in_other) {
+				if (k != i)
+					values[k] = ezSTL::move(values[i]);
+				++k;
+			}
+		}
+		while (size() > k)
+			values.pop_back();
+		other.clear();
+	}
+}
+
+#endif // !EZSTL_FLAT_SET_H
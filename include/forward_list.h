@@ -0,0 +1,368 @@
+/*********************************************************************************************/
+// class forward_list:
+// using singly linked list as basic data structure, one pointer per node and one pointer
+// per list, nodes never point back to the list so a forward_list can be moved around freely,
+// e.g. as the bucket chains of a hash table kept in a vector
+// there is no size(), counting the elements is O(n) by distance(begin(), end())
+// including some basic functions of forward_list:
+//
+// 1. iterator before_begin() const;
+// 2. iterator begin() const;
+// 3. iterator end() const;
+// 4. bool empty() const;
+// 5. reference front() const;
+// 6. void push_front(const_reference x);
+// 7. void emplace_front(Args&&... args);
+// 8. void pop_front();
+// 9. iterator insert_after(iterator pos, const_reference x);
+// 10. iterator erase_after(iterator pos);
+// 11. void splice_after(iterator pos, forward_list& x);
+// 12. void splice_after(iterator pos, forward_list& x, iterator i);
+// 13. void splice_after(iterator pos, forward_list& x, iterator before_first, iterator last);
+// 14. void merge(forward_list& x, Compare cmp = Compare());
+// 15. void reverse();
+// 16. void remove_if(Predicate pred);
+// 17. void sort(Compare cmp = Compare());
+// 18. void clear();
+//
+// splice_after, merge, reverse, remove_if and sort only relink nodes, no node is copied or allocated
+
+#ifndef EZSTL_FORWARD_LIST_H
+#define EZSTL_FORWARD_LIST_H
+
+#include "functional.h"
+#include "iterator.h"
+#include "memory.h"
+#include "utility.h"
+
+namespace ezSTL {
+
+	// link of forward_list node, also the head of the list
+	class __forward_list_node_base {
+	public:
+		__forward_list_node_base() : next(nullptr) {}
+		__forward_list_node_base* next;
+	};
+
+	// forward_list node
+	template<typename T>
+	class __forward_list_node : public __forward_list_node_base {
+	public:
+		template<typename... Args>
+		explicit __forward_list_node(Args&&... args) : data(ezSTL::forward<Args>(args)...) {}
+		T data;
+	};
+
+	// forward_list iterator
+	template<typename T>
+	class __forward_list_iterator : public iterator<forward_iterator_tag, T> {
+	public:
+		using iterator = __forward_list_iterator<T>;
+		using self = __forward_list_iterator<T>;
+		using base_ptr = __forward_list_node_base*;
+		using link_type = __forward_list_node<T>*;
+		using pointer = T*;
+		using reference = T&;
+		using difference_type = int;
+
+		// node pointer, nullptr for end()
+		base_ptr node;
+
+		__forward_list_iterator() = default;
+		__forward_list_iterator(base_ptr x) : node(x) {}
+
+		bool operator== (const self& x) const {
+			return node == x.node;
+		}
+		bool operator!= (const self& x) const {
+			return node != x.node;
+		}
+		reference operator*() const {
+			return static_cast<link_type>(node)->data;
+		}
+		pointer operator->() const {
+			return &(operator*());
+		}
+		// go to next
+		self& operator++() {
+			node = node->next;
+			return *this;
+		}
+		self operator++(int) {
+			self temp = *this;
+			++(*this);
+			return temp;
+		}
+		self operator+ (difference_type n) const {
+			self temp = *this;
+			ezSTL::advance(temp, n);
+			return temp;
+		}
+	};
+
+	// class forward_list
+	template<typename T, typename Alloc = allocator<__forward_list_node<T>>>
+	class forward_list {
+	public:
+		using list_node = __forward_list_node<T>;
+		using base_ptr = __forward_list_node_base*;
+		using link_type = __forward_list_node<T>*;
+		using size_type = unsigned int;
+		using value_type = T;
+		using iterator = __forward_list_iterator<T>;
+		using const_iterator = const iterator;
+		using reference = value_type&;
+		using const_reference = const T&;
+		using difference_type = int;
+
+	protected:
+		// head.next is the first node
+		__forward_list_node_base head;
+
+	public:
+		// constructor
+		forward_list() = default;
+		forward_list(const forward_list& other) {
+			copy_after(&head, other);
+		}
+		forward_list(forward_list&& other) noexcept {
+			head.next = other.head.next;
+			other.head.next = nullptr;
+		}
+		forward_list& operator=(const forward_list& other) {
+			if (this != &other) {
+				clear();
+				copy_after(&head, other);
+			}
+			return *this;
+		}
+		forward_list& operator=(forward_list&& other) noexcept {
+			swap(other);
+			return *this;
+		}
+		// destructor
+		~forward_list() {
+			clear();
+		}
+
+		// some common functions for forward_list
+		// position before the first element, only valid while the list object does not move
+		const_iterator before_begin() const {
+			return iterator(const_cast<base_ptr>(&head));
+		}
+		const_iterator begin() const {
+			return iterator(head.next);
+		}
+		const_iterator end() const {
+			return iterator(nullptr);
+		}
+		bool empty() const {
+			return head.next == nullptr;
+		}
+		reference front() const {
+			return *begin();
+		}
+		void push_front(const_reference x) {
+			emplace_after(before_begin(), x);
+		}
+		void push_front(value_type&& x) {
+			emplace_after(before_begin(), ezSTL::move(x));
+		}
+		template<typename... Args>
+		void emplace_front(Args&&... args) {
+			emplace_after(before_begin(), ezSTL::forward<Args>(args)...);
+		}
+		void pop_front() {
+			erase_after(before_begin());
+		}
+		iterator insert_after(iterator pos, const_reference x) {
+			return emplace_after(pos, x);
+		}
+		iterator insert_after(iterator pos, value_type&& x) {
+			return emplace_after(pos, ezSTL::move(x));
+		}
+		template<typename... Args>
+		iterator emplace_after(iterator pos, Args&&... args) {
+			link_type node = Alloc().allocate();
+			Alloc().construct(node, ezSTL::forward<Args>(args)...);
+			node->next = pos.node->next;
+			pos.node->next = node;
+			return iterator(node);
+		}
+		// erase the element after pos, return the element after the erased one
+		iterator erase_after(iterator pos) {
+			link_type node = static_cast<link_type>(pos.node->next);
+			pos.node->next = node->next;
+			Alloc().destroy(node);
+			Alloc().deallocate(node);
+			return iterator(pos.node->next);
+		}
+		void clear();
+		void swap(forward_list& other) noexcept {
+			ezSTL::swap(head.next, other.head.next);
+		}
+
+		// relinking operations
+		void splice_after(iterator pos, forward_list& x);
+		void splice_after(iterator pos, forward_list& x, iterator i);
+		void splice_after(iterator pos, forward_list& x, iterator before_first, iterator last);
+		template<typename Compare = less<T>>
+		void merge(forward_list& x, Compare cmp = Compare());
+		void reverse();
+		template<typename Predicate>
+		void remove_if(Predicate pred);
+		template<typename Compare = less<T>>
+		void sort(Compare cmp = Compare());
+
+	protected:
+		// move the nodes after before_first up to and including tail after pos
+		static void transfer_after(base_ptr pos, base_ptr before_first, base_ptr tail);
+		// merge two sorted null terminated chains, a goes first on ties
+		template<typename Compare>
+		static base_ptr merge_chain(base_ptr a, base_ptr b, Compare& cmp);
+		static const value_type& value(base_ptr x) {
+			return static_cast<link_type>(x)->data;
+		}
+		void copy_after(base_ptr pos, const forward_list& other) {
+			for (base_ptr node = other.head.next; node != nullptr; node = node->next)
+				pos = emplace_after(iterator(pos), value(node)).node;
+		}
+	};
+
+	template<typename T, typename Alloc>
+	void forward_list<T, Alloc>::clear() {
+		base_ptr node = head.next;
+		while (node != nullptr) {
+			link_type temp = static_cast<link_type>(node);
+			node = node->next;
+			Alloc().destroy(temp);
+			Alloc().deallocate(temp);
+		}
+		head.next = nullptr;
+	}
+
+	template<typename T, typename Alloc>
+	void forward_list<T, Alloc>::transfer_after(base_ptr pos, base_ptr before_first, base_ptr tail) {
+		if (pos == before_first || pos == tail)
+			return;
+		base_ptr first = before_first->next;
+		before_first->next = tail->next;
+		tail->next = pos->next;
+		pos->next = first;
+	}
+
+	template<typename T, typename Alloc>
+	void forward_list<T, Alloc>::splice_after(iterator pos, forward_list<T, Alloc>& x) {
+		if (this == &x || x.empty())
+			return;
+		base_ptr tail = &x.head;
+		while (tail->next != nullptr)
+			tail = tail->next;
+		transfer_after(pos.node, &x.head, tail);
+	}
+
+	template<typename T, typename Alloc>
+	void forward_list<T, Alloc>::splice_after(iterator pos, forward_list<T, Alloc>&, iterator i) {
+		// move the element after i
+		base_ptr node = i.node->next;
+		if (node == nullptr)
+			return;
+		transfer_after(pos.node, i.node, node);
+	}
+
+	template<typename T, typename Alloc>
+	void forward_list<T, Alloc>::splice_after(iterator pos, forward_list<T, Alloc>&, iterator before_first, iterator last) {
+		// move (before_first, last)
+		if (before_first.node->next == last.node)
+			return;
+		base_ptr tail = before_first.node;
+		while (tail->next != last.node)
+			tail = tail->next;
+		transfer_after(pos.node, before_first.node, tail);
+	}
+
+	template<typename T, typename Alloc>
+	template<typename Compare>
+	void forward_list<T, Alloc>::merge(forward_list<T, Alloc>& x, Compare cmp) {
+		if (this == &x)
+			return;
+		head.next = merge_chain(head.next, x.head.next, cmp);
+		x.head.next = nullptr;
+	}
+
+	template<typename T, typename Alloc>
+	void forward_list<T, Alloc>::reverse() {
+		base_ptr result = nullptr;
+		base_ptr node = head.next;
+		while (node != nullptr) {
+			base_ptr next = node->next;
+			node->next = result;
+			result = node;
+			node = next;
+		}
+		head.next = result;
+	}
+
+	template<typename T, typename Alloc>
+	template<typename Predicate>
+	void forward_list<T, Alloc>::remove_if(Predicate pred) {
+		base_ptr prev = &head;
+		while (prev->next != nullptr) {
+			if (pred(value(prev->next)))
+				erase_after(iterator(prev));
+			else
+				prev = prev->next;
+		}
+	}
+
+	template<typename T, typename Alloc>
+	template<typename Compare>
+	typename forward_list<T, Alloc>::base_ptr
+		forward_list<T, Alloc>::merge_chain(base_ptr a, base_ptr b, Compare& cmp) {
+		base_ptr result = nullptr;
+		base_ptr* tail = &result;
+		while (a != nullptr && b != nullptr) {
+			if (cmp(value(b), value(a))) {
+				*tail = b;
+				b = b->next;
+			}
+			else {
+				*tail = a;
+				a = a->next;
+			}
+			tail = &(*tail)->next;
+		}
+		*tail = a != nullptr ? a : b;
+		return result;
+	}
+
+	template<typename T, typename Alloc>
+	template<typename Compare>
+	void forward_list<T, Alloc>::sort(Compare cmp) {
+		// bottom up merge sort, bins[i] is empty or holds a sorted run of 2^i nodes that precede the later ones
+		const int max_bins = sizeof(size_type) * 8 + 1;
+		base_ptr bins[max_bins] = {};
+		int fill = 0;
+		base_ptr node = head.next;
+		while (node != nullptr) {
+			base_ptr carry = node;
+			node = node->next;
+			carry->next = nullptr;
+			int i = 0;
+			for (; i < fill && bins[i] != nullptr; ++i) {
+				carry = merge_chain(bins[i], carry, cmp);
+				bins[i] = nullptr;
+			}
+			bins[i] = carry;
+			if (i == fill)
+				++fill;
+		}
+		base_ptr result = nullptr;
+		for (int i = 0; i < fill; ++i)
+			if (bins[i] != nullptr)
+				result = result == nullptr ? bins[i] : merge_chain(bins[i], result, cmp);
+		head.next = result;
+	}
+}
+
+#endif // !EZSTL_FORWARD_LIST_H
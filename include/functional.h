@@ -16,6 +16,16 @@
 // 14. logical_or
 // 15. logical_not
 // 16. hash
+// 17. identity
+// 18. select1st
+// 19. three_way_compare
+//
+// less<> (less<void>) is transparent: it compares any two types with <, and the lookups of set and map
+// with a transparent Compare take any type comparable with the key, e.g. a const char* for string keys
+//
+// a three-way comparator has is_three_way and returns an int, negative, zero or positive for x < y, x == y
+// and x > y; set and map take one as Compare and then make one call per node where a less functor needs
+// two, three_way_compare uses x.compare(y) when the type has it (std::string) and x < y otherwise
 
 #ifndef EZSTL_FUNCTIONAL_H
 #define EZSTL_FUNCTIONAL_H
@@ -100,13 +110,23 @@ namespace ezSTL {
 		}
 	};
 	// less functor
-	template<typename T>
+	template<typename T = void>
 	class less {
 	public:
 		inline bool operator()(const T& x, const T& y) const {
 			return x < y;
 		}
 	};
+	// transparent less functor, the two sides may have different types
+	template<>
+	class less<void> {
+	public:
+		using is_transparent = void;
+		template<typename T, typename U>
+		inline bool operator()(const T& x, const U& y) const {
+			return x < y;
+		}
+	};
 	// greater equal functor
 	template<typename T>
 	class greater_equal {
@@ -124,6 +144,42 @@ namespace ezSTL {
 		}
 	};
 
+	// three-way comparison of x and y: x.compare(y) if x has it, or the reverse of y.compare(x),
+	// or two calls of operator<
+	template<typename T, typename U>
+	inline auto __three_way(const T& x, const U& y, int) -> decltype(int(x.compare(y))) {
+		return x.compare(y);
+	}
+	template<typename T, typename U>
+	inline auto __three_way(const T& x, const U& y, long) -> decltype(int(y.compare(x))) {
+		int c = y.compare(x);
+		return c < 0 ? 1 : (c > 0 ? -1 : 0);
+	}
+	template<typename T, typename U>
+	inline int __three_way(const T& x, const U& y, ...) {
+		return x < y ? -1 : (y < x ? 1 : 0);
+	}
+	// three-way comparison functor
+	template<typename T = void>
+	class three_way_compare {
+	public:
+		using is_three_way = void;
+		inline int operator()(const T& x, const T& y) const {
+			return __three_way(x, y, 0);
+		}
+	};
+	// transparent three-way comparison functor
+	template<>
+	class three_way_compare<void> {
+	public:
+		using is_three_way = void;
+		using is_transparent = void;
+		template<typename T, typename U>
+		inline int operator()(const T& x, const U& y) const {
+			return __three_way(x, y, 0);
+		}
+	};
+
 	// three logical functors
 	// logical and functor
 	template<typename T>
@@ -150,6 +206,83 @@ namespace ezSTL {
 		}
 	};
 
+	// key extractors of rbtree and btree
+	// the value is its own key, for set and btree_set
+	template<typename T>
+	class identity {
+	public:
+		using key_type = T;
+		inline const T& operator()(const T& x) const {
+			return x;
+		}
+	};
+	// the key is the first member of a pair, for map and btree_map
+	template<typename Pair>
+	class select1st {
+	public:
+		using key_type = typename Pair::first_type;
+		inline const key_type& operator()(const Pair& x) const {
+			return x.first;
+		}
+	};
+
+	// __if_transparent<Compare, K>::type is K if Compare has is_transparent and does not exist otherwise,
+	// it turns off the overloads of set and map taking keys of any type for the other comparators
+	template<typename T>
+	class __void_type {
+	public:
+		using type = void;
+	};
+	template<typename Compare, typename K, typename = void>
+	class __if_transparent {};
+	template<typename Compare, typename K>
+	class __if_transparent<Compare, K, typename __void_type<typename Compare::is_transparent>::type> {
+	public:
+		using type = K;
+	};
+
+	// __compare_traits<Compare> calls a less functor and a three-way comparator the same way:
+	// less(cmp, x, y) is x < y and compare(cmp, x, y) is negative, zero or positive,
+	// one call of a three-way comparator for either and up to two calls of a less functor for compare
+	template<typename Compare, typename = void>
+	class __compare_traits {
+	public:
+		static const bool three_way = false;
+		template<typename T, typename U>
+		static bool less(const Compare& cmp, const T& x, const U& y) {
+			return cmp(x, y);
+		}
+		template<typename T, typename U>
+		static int compare(const Compare& cmp, const T& x, const U& y) {
+			return cmp(x, y) ? -1 : (cmp(y, x) ? 1 : 0);
+		}
+	};
+	template<typename Compare>
+	class __compare_traits<Compare, typename __void_type<typename Compare::is_three_way>::type> {
+	public:
+		static const bool three_way = true;
+		template<typename T, typename U>
+		static bool less(const Compare& cmp, const T& x, const U& y) {
+			return cmp(x, y) < 0;
+		}
+		template<typename T, typename U>
+		static int compare(const Compare& cmp, const T& x, const U& y) {
+			return cmp(x, y);
+		}
+	};
+
+	// orders the values of a tree by Compare on their keys, KeyOfValue gives the key of a value
+	template<typename T, typename Compare, typename KeyOfValue>
+	class __key_value_compare {
+	public:
+		explicit __key_value_compare(const Compare& c) : cmp(c) {}
+		bool operator()(const T& x, const T& y) const {
+			return __compare_traits<Compare>::less(cmp, KeyOfValue()(x), KeyOfValue()(y));
+		}
+	protected:
+		Compare cmp;
+	};
+
 	// hash functors, using FNV-1a hash function
 	inline unsigned int _Hash_seq(const unsigned char* str, unsigned int count) {
 		const unsigned int FNV_offset_basis = 2166136261U;
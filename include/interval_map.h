@@ -0,0 +1,221 @@
+/*********************************************************************************************/
+// class interval_map:
+// maps closed intervals [lo, hi] to values, using rbtree as base container
+// including some basic functions of interval_map:
+//
+// 1. iterator begin() const;
+// 2. iterator end() const;
+// 3. size_type size() const;
+// 4. bool empty() const;
+// 5. iterator find(const T& lo, const T& hi) const;
+// 6. pair<iterator, bool> insert(const T& lo, const T& hi, const V& v);
+// 7. pair<iterator, bool> insert(const value_type& v);
+// 8. void insert(Iterator first, Iterator last);
+// 9. void erase(iterator pos);
+// 10. void clear();
+// 11. iterator find_overlap(const T& lo, const T& hi) const;
+// 12. void for_each_overlap(const T& lo, const T& hi, Function f) const;
+// 13. size_type count_overlaps(const T& lo, const T& hi) const;
+// only for debug:
+// 14. bool isRBTree() const;
+//
+// the values are pair<pair<T, T>, V>, first.first is lo and first.second is hi, lo must not be greater
+// than hi; the intervals are ordered by lo and then by hi, an interval is in the map at most once
+// and inserting it again changes nothing; two intervals overlap if each starts before the other ends
+//
+// every node keeps the largest hi in its subtree, updated by the tree algorithms on the path of an
+// insert or erase and in every rotation (see the Augment policies in rbtree.h), so:
+// find_overlap returns one interval overlapping [lo, hi], or end(), in O(lgn);
+// for_each_overlap calls f on every interval overlapping [lo, hi] in order, skipping the subtrees
+// ending before lo and stopping at the first interval starting after hi, O(lgn) when no interval
+// overlaps and at most O(lgn) more per reported interval
+//
+// constructing from a range, or inserting a range into an empty map, builds the tree in O(n)
+// when the range is sorted by interval, and sorts a copy of the range first otherwise
+
+#ifndef EZSTL_INTERVAL_MAP_H
+#define EZSTL_INTERVAL_MAP_H
+
+#include "functional.h"
+#include "memory.h"
+#include "rbtree.h"
+#include "utility.h"
+
+namespace ezSTL {
+
+	// links of a node of interval_map with the largest end of the intervals in its subtree
+	template<typename T>
+	class __rbtree_max_end_node_base : public __rbtree_node_base {
+	public:
+		T max_end;
+	};
+
+	// augmentation of interval_map: the largest end of the subtree, Compare orders the ends
+	template<typename T, typename V, typename Compare>
+	class __interval_max_end {
+	public:
+		using node_base = __rbtree_max_end_node_base<T>;
+		using node = __rbtree_node<pair<pair<T, T>, V>, node_base>;
+		static const bool enabled = true;
+		static const bool threaded = false;
+		static const T& max_end(const __rbtree_node_base* x) {
+			return static_cast<const node_base*>(x)->max_end;
+		}
+		static const T& end(const __rbtree_node_base* x) {
+			return static_cast<const node*>(x)->data.first.second;
+		}
+		static const T& max_end_of_children(const __rbtree_node_base* x) {
+			const T* result = &end(x);
+			if (x->left != nullptr && Compare()(*result, max_end(x->left)))
+				result = &max_end(x->left);
+			if (x->right != nullptr && Compare()(*result, max_end(x->right)))
+				result = &max_end(x->right);
+			return *result;
+		}
+		static void update(__rbtree_node_base* x) {
+			static_cast<node_base*>(x)->max_end = max_end_of_children(x);
+		}
+		static bool check(const __rbtree_node_base* x) {
+			const T& expected = max_end_of_children(x);
+			return !Compare()(max_end(x), expected) && !Compare()(expected, max_end(x));
+		}
+	};
+
+	// orders the intervals by lo and then by hi
+	template<typename T, typename Compare>
+	class __interval_less {
+	public:
+		bool operator()(const pair<T, T>& x, const pair<T, T>& y) const {
+			Compare cmp;
+			if (cmp(x.first, y.first))
+				return true;
+			if (cmp(y.first, x.first))
+				return false;
+			return cmp(x.second, y.second);
+		}
+	};
+
+	template<typename T, typename V, typename Compare = less<T>, typename Alloc = allocator<pair<pair<T, T>, V>>>
+	class interval_map {
+	public:
+		using interval_type = pair<T, T>;
+		using value_type = pair<interval_type, V>;
+		using augment = __interval_max_end<T, V, Compare>;
+		using base_tree = rbtree<value_type, __interval_less<T, Compare>, Alloc, augment, select1st<value_type>>;
+		using size_type = unsigned int;
+		using iterator = typename base_tree::iterator;
+		using const_iterator = const iterator;
+		using difference_type = int;
+	protected:
+		using base_ptr = __rbtree_node_base*;
+		using link_type = typename base_tree::link_type;
+		base_tree base_rbt;
+		Compare cmp;
+	public:
+		// constructor
+		interval_map() = default;
+		template<typename Iterator>
+		interval_map(Iterator first, Iterator last) {
+			base_rbt.insert(first, last);
+		}
+
+		iterator begin() const {
+			return base_rbt.begin();
+		}
+		iterator end() const {
+			return base_rbt.end();
+		}
+		size_type size() const {
+			return base_rbt.size();
+		}
+		bool empty() const {
+			return base_rbt.empty();
+		}
+		// find the interval [lo, hi] itself
+		iterator find(const T& lo, const T& hi) const {
+			return base_rbt.find(interval_type(lo, hi));
+		}
+		pair<iterator, bool> insert(const T& lo, const T& hi, const V& v) {
+			return base_rbt.insert(value_type(interval_type(lo, hi), v));
+		}
+		pair<iterator, bool> insert(const value_type& v) {
+			return base_rbt.insert(v);
+		}
+		template<typename Iterator>
+		void insert(Iterator first, Iterator last) {
+			base_rbt.insert(first, last);
+		}
+		void erase(iterator pos) {
+			base_rbt.erase(pos);
+		}
+		void clear() {
+			base_rbt.clear();
+		}
+		// an interval overlapping [lo, hi], end() if none does
+		iterator find_overlap(const T& lo, const T& hi) const;
+		// call f on every pair whose interval overlaps [lo, hi], in order
+		template<typename Function>
+		void for_each_overlap(const T& lo, const T& hi, Function f) const;
+		size_type count_overlaps(const T& lo, const T& hi) const {
+			size_type n = 0;
+			for_each_overlap(lo, hi, [&n](const value_type&) { ++n; });
+			return n;
+		}
+
+		// interface for debug
+		// judge if the present tree is a RBTree with the largest ends up to date
+		bool isRBTree() const {
+			return base_rbt.isRBTree();
+		}
+
+	protected:
+		// the parent of the header is the root
+		base_ptr root() const {
+			return end().node->parent();
+		}
+		const interval_type& interval(base_ptr x) const {
+			return static_cast<link_type>(x)->data.first;
+		}
+		bool overlaps(base_ptr x, const T& lo, const T& hi) const {
+			return !cmp(hi, interval(x).first) && !cmp(interval(x).second, lo);
+		}
+	};
+
+	// go left while the left subtree ends at or after lo: if it holds no overlapping interval
+	// then none starts before hi and neither does any interval to the right
+	template<typename T, typename V, typename Compare, typename Alloc>
+	typename interval_map<T, V, Compare, Alloc>::iterator interval_map<T, V, Compare, Alloc>::find_overlap(const T& lo, const T& hi) const {
+		base_ptr x = root();
+		while (x != nullptr && !overlaps(x, lo, hi)) {
+			if (x->left != nullptr && !cmp(augment::max_end(x->left), lo))
+				x = x->left;
+			else
+				x = x->right;
+		}
+		return x == nullptr ? end() : iterator(static_cast<link_type>(x));
+	}
+
+	template<typename T, typename V, typename Compare, typename Alloc>
+	template<typename Function>
+	void interval_map<T, V, Compare, Alloc>::for_each_overlap(const T& lo, const T& hi, Function f) const {
+		// the nodes whose left subtree is being visited, at most one per level,
+		// and a tree of less than 2^32 nodes is at most 64 levels high
+		base_ptr stack[2 * sizeof(size_type) * 8];
+		int top = 0;
+		// a subtree whose largest end is before lo is skipped as a whole
+		for (base_ptr x = root(); x != nullptr && !cmp(augment::max_end(x), lo); x = x->left)
+			stack[top++] = x;
+		while (top > 0) {
+			base_ptr x = stack[--top];
+			// this and all the following intervals start after hi
+			if (cmp(hi, interval(x).first))
+				return;
+			if (!cmp(interval(x).second, lo))
+				f(static_cast<link_type>(x)->data);
+			for (x = x->right; x != nullptr && !cmp(augment::max_end(x), lo); x = x->left)
+				stack[top++] = x;
+		}
+	}
+}
+
+#endif // !EZSTL_INTERVAL_MAP_H
@@ -0,0 +1,241 @@
+/*********************************************************************************************/
+// class intrusive_list:
+// bidirectional list of objects embedding an intrusive_list_hook, the list never allocates
+// and never copies an object, it only links the hooks; the objects are owned by the user
+// and an object can sit in several lists at once through several hooks
+// including some basic functions of intrusive_list:
+//
+// 1. iterator begin() const;
+// 2. iterator end() const;
+// 3. size_type size() const;
+// 4. bool empty() const;
+// 5. reference front() const;
+// 6. reference back() const;
+// 7. void push_back(reference x);
+// 8. void push_front(reference x);
+// 9. void pop_back();
+// 10. void pop_front();
+// 11. iterator insert(iterator pos, reference x);
+// 12. iterator erase(iterator pos);
+// 13. void erase(reference x);
+// 14. iterator iterator_to(reference x) const;
+// 15. void clear();
+//
+// usage:
+// class session { intrusive_list_hook lru_hook; ... };
+// intrusive_list<session, &session::lru_hook> lru;
+//
+// an object must be unlinked before it is destroyed or linked into another list through the same hook;
+// erase, pop and clear leave the hook unlinked again;
+// T must be a standard-layout class, the object is found from its hook by the offset of the hook
+
+#ifndef EZSTL_INTRUSIVE_LIST_H
+#define EZSTL_INTRUSIVE_LIST_H
+
+#include "iterator.h"
+#include "utility.h"
+
+namespace ezSTL {
+
+	// hook embedded in an object of intrusive_list
+	class intrusive_list_hook {
+	public:
+		intrusive_list_hook() : prev(nullptr), next(nullptr) {}
+		// a copied object starts unlinked, the links belong to the original one
+		intrusive_list_hook(const intrusive_list_hook&) : prev(nullptr), next(nullptr) {}
+		intrusive_list_hook& operator=(const intrusive_list_hook&) {
+			return *this;
+		}
+		bool is_linked() const {
+			return next != nullptr;
+		}
+
+		intrusive_list_hook* prev;
+		intrusive_list_hook* next;
+	};
+
+	// intrusive list iterator
+	template<typename T, intrusive_list_hook T::*Hook>
+	class __intrusive_list_iterator : public iterator<bidirectional_iterator_tag, T> {
+	public:
+		using iterator = __intrusive_list_iterator<T, Hook>;
+		using self = __intrusive_list_iterator<T, Hook>;
+		using hook_type = intrusive_list_hook*;
+		using pointer = T*;
+		using reference = T&;
+		using difference_type = int;
+
+		// hook of the object
+		hook_type node;
+
+		__intrusive_list_iterator() = default;
+		__intrusive_list_iterator(hook_type x) : node(x) {}
+
+		bool operator== (const self& x) const {
+			return node == x.node;
+		}
+		bool operator!= (const self& x) const {
+			return node != x.node;
+		}
+		reference operator*() const {
+			return *__owner_of(node, Hook);
+		}
+		pointer operator->() const {
+			return &(operator*());
+		}
+		// go to next
+		self& operator++() {
+			node = node->next;
+			return *this;
+		}
+		self operator++(int) {
+			self temp = *this;
+			++(*this);
+			return temp;
+		}
+		// go to prev
+		self& operator--() {
+			node = node->prev;
+			return *this;
+		}
+		self operator--(int) {
+			self temp = *this;
+			--(*this);
+			return temp;
+		}
+	};
+
+	// class intrusive_list
+	template<typename T, intrusive_list_hook T::*Hook>
+	class intrusive_list {
+	public:
+		using hook_type = intrusive_list_hook*;
+		using size_type = unsigned int;
+		using value_type = T;
+		using iterator = __intrusive_list_iterator<T, Hook>;
+		using const_iterator = const iterator;
+		using reference = value_type&;
+		using const_reference = const T&;
+		using difference_type = int;
+
+	protected:
+		// header hook, not embedded in any object
+		intrusive_list_hook header;
+		size_type __size;
+
+	public:
+		// constructor
+		intrusive_list() : __size(0) {
+			header.prev = &header;
+			header.next = &header;
+		}
+		intrusive_list(const intrusive_list&) = delete;
+		intrusive_list& operator=(const intrusive_list&) = delete;
+		intrusive_list(intrusive_list&& other) noexcept : intrusive_list() {
+			swap(other);
+		}
+		intrusive_list& operator=(intrusive_list&& other) noexcept {
+			swap(other);
+			return *this;
+		}
+		// destructor, unlinks all objects
+		~intrusive_list() {
+			clear();
+		}
+
+		// some common functions for intrusive_list
+		const_iterator begin() const {
+			return iterator(header.next);
+		}
+		const_iterator end() const {
+			return iterator(const_cast<hook_type>(&header));
+		}
+		reference front() const {
+			return *begin();
+		}
+		reference back() const {
+			return *iterator(header.prev);
+		}
+		size_type size() const {
+			return __size;
+		}
+		bool empty() const {
+			return size() == 0;
+		}
+		void push_back(reference x) {
+			insert(end(), x);
+		}
+		void push_front(reference x) {
+			insert(begin(), x);
+		}
+		void pop_back() {
+			erase(iterator(header.prev));
+		}
+		void pop_front() {
+			erase(begin());
+		}
+		// link x before pos, x must not be linked through this hook
+		iterator insert(iterator pos, reference x) {
+			hook_type node = &(x.*Hook);
+			node->next = pos.node;
+			node->prev = pos.node->prev;
+			pos.node->prev->next = node;
+			pos.node->prev = node;
+			++__size;
+			return iterator(node);
+		}
+		// unlink the object at pos, return the next position
+		iterator erase(iterator pos) {
+			hook_type node = pos.node;
+			hook_type next = node->next;
+			node->prev->next = next;
+			next->prev = node->prev;
+			node->prev = nullptr;
+			node->next = nullptr;
+			--__size;
+			return iterator(next);
+		}
+		void erase(reference x) {
+			erase(iterator_to(x));
+		}
+		// iterator to an object linked in this list, O(1)
+		iterator iterator_to(reference x) const {
+			return iterator(&(x.*Hook));
+		}
+		void clear() {
+			hook_type node = header.next;
+			while (node != &header) {
+				hook_type next = node->next;
+				node->prev = nullptr;
+				node->next = nullptr;
+				node = next;
+			}
+			header.prev = &header;
+			header.next = &header;
+			__size = 0;
+		}
+		void swap(intrusive_list& other) noexcept {
+			// swap the links, copying a hook does not copy them
+			ezSTL::swap(header.prev, other.header.prev);
+			ezSTL::swap(header.next, other.header.next);
+			ezSTL::swap(__size, other.__size);
+			// the first and last objects still point to the header of the other list
+			relink_header();
+			other.relink_header();
+		}
+
+	protected:
+		void relink_header() {
+			if (__size == 0) {
+				header.prev = &header;
+				header.next = &header;
+			}
+			else {
+				header.next->prev = &header;
+				header.prev->next = &header;
+			}
+		}
+	};
+}
+
+#endif // !EZSTL_INTRUSIVE_LIST_H
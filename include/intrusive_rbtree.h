@@ -0,0 +1,307 @@
+/*********************************************************************************************/
+// class intrusive_rbtree:
+// red-black tree of objects embedding an intrusive_rbtree_hook, insert and erase never allocate
+// and never copy an object, they only link the hooks; it runs the same algorithms as rbtree
+// on the links of the hooks; the objects are owned by the user and an object can sit in
+// several trees and lists at once through several hooks
+// including some basic functions of intrusive_rbtree:
+//
+// 1. iterator begin() const;
+// 2. iterator end() const;
+// 3. size_type size() const;
+// 4. bool empty() const;
+// 5. iterator find(const T& v) const;
+// 6. pair<iterator, bool> insert(reference x);
+// 7. iterator insert_equal(reference x);
+// 8. iterator erase(iterator pos);
+// 9. void erase(reference x);
+// 10. iterator iterator_to(reference x) const;
+// 11. void clear();
+// only for debug:
+// 12. bool isRBTree();
+//
+// usage:
+// class session { intrusive_rbtree_hook tree_hook; ... };
+// intrusive_rbtree<session, &session::tree_hook, compare_by_id> sessions;
+//
+// insert links x unless an equal object is already linked, then it returns that one;
+// insert_equal always links x, after the equal objects;
+// an object must be unlinked before it is destroyed, or before its key changes;
+// T must be a standard-layout class, the object is found from its hook by the offset of the hook
+
+#ifndef EZSTL_INTRUSIVE_RBTREE_H
+#define EZSTL_INTRUSIVE_RBTREE_H
+
+#include "functional.h"
+#include "iterator.h"
+#include "rbtree.h"
+#include "utility.h"
+
+namespace ezSTL {
+
+	// hook embedded in an object of intrusive_rbtree, the parent is nullptr while unlinked
+	class intrusive_rbtree_hook : public __rbtree_node_base {
+	public:
+		intrusive_rbtree_hook() = default;
+		// a copied object starts unlinked, the links belong to the original one
+		intrusive_rbtree_hook(const intrusive_rbtree_hook&) : __rbtree_node_base() {}
+		intrusive_rbtree_hook& operator=(const intrusive_rbtree_hook&) {
+			return *this;
+		}
+		bool is_linked() const {
+			return parent() != nullptr;
+		}
+	};
+
+	// intrusive rbtree iterator
+	template<typename T, intrusive_rbtree_hook T::*Hook>
+	class __intrusive_rbtree_iterator : public iterator<bidirectional_iterator_tag, T> {
+	public:
+		using iterator = __intrusive_rbtree_iterator<T, Hook>;
+		using self = __intrusive_rbtree_iterator<T, Hook>;
+		using base_ptr = __rbtree_node_base*;
+		using pointer = T*;
+		using reference = T&;
+		using difference_type = int;
+
+		// hook of the object, or the header of the tree
+		base_ptr node;
+
+		__intrusive_rbtree_iterator() = default;
+		__intrusive_rbtree_iterator(base_ptr x) : node(x) {}
+
+		bool operator== (const self& x) const {
+			return node == x.node;
+		}
+		bool operator!= (const self& x) const {
+			return node != x.node;
+		}
+		reference operator*() const {
+			return *__owner_of(static_cast<intrusive_rbtree_hook*>(node), Hook);
+		}
+		pointer operator->() const {
+			return &(operator*());
+		}
+		self& operator++() {
+			node = __rbtree_increment(node);
+			return *this;
+		}
+		self operator++(int) {
+			self temp = *this;
+			++(*this);
+			return temp;
+		}
+		self& operator--() {
+			node = __rbtree_decrement(node);
+			return *this;
+		}
+		self operator--(int) {
+			self temp = *this;
+			--(*this);
+			return temp;
+		}
+	};
+
+	// class intrusive_rbtree
+	template<typename T, intrusive_rbtree_hook T::*Hook, typename Compare = less<T>>
+	class intrusive_rbtree {
+	public:
+		using base_ptr = __rbtree_node_base*;
+		using size_type = unsigned int;
+		using value_type = T;
+		using iterator = __intrusive_rbtree_iterator<T, Hook>;
+		using const_iterator = const iterator;
+		using reference = value_type&;
+		using const_reference = const T&;
+		using difference_type = int;
+
+	protected:
+		// header of the tree, not embedded in any object
+		__rbtree_node_base header;
+		size_type __size;
+		Compare cmp;
+
+	public:
+		// constructor
+		explicit intrusive_rbtree(const Compare& c = Compare()) : __size(0), cmp(c) {
+			reset_header();
+		}
+		intrusive_rbtree(const intrusive_rbtree&) = delete;
+		intrusive_rbtree& operator=(const intrusive_rbtree&) = delete;
+		intrusive_rbtree(intrusive_rbtree&& other) noexcept : __size(0), cmp(other.cmp) {
+			reset_header();
+			swap(other);
+		}
+		intrusive_rbtree& operator=(intrusive_rbtree&& other) noexcept {
+			swap(other);
+			return *this;
+		}
+		// destructor, unlinks all objects
+		~intrusive_rbtree() {
+			clear();
+		}
+
+		// some outer interfaces
+		const_iterator begin() const {
+			return iterator(header.left);
+		}
+		const_iterator end() const {
+			return iterator(const_cast<base_ptr>(&header));
+		}
+		bool empty() const {
+			return __size == 0;
+		}
+		size_type size() const {
+			return __size;
+		}
+
+		iterator find(const value_type& v) const;
+		pair<iterator, bool> insert(reference x);
+		iterator insert_equal(reference x);
+		// unlink the object at pos, return the next position
+		iterator erase(iterator pos) {
+			iterator next = pos;
+			++next;
+			__rbtree_rebalance_for_erase(pos.node, header);
+			unlink(pos.node);
+			--__size;
+			return next;
+		}
+		void erase(reference x) {
+			erase(iterator_to(x));
+		}
+		// iterator to an object linked in this tree, O(1)
+		iterator iterator_to(reference x) const {
+			return iterator(&(x.*Hook));
+		}
+		void clear();
+		void swap(intrusive_rbtree& other) noexcept;
+
+		// interface for debug
+		// judge if the present tree is a RBTree
+		bool isRBTree() const {
+			return __rbtree_is_valid(&header);
+		}
+
+	protected:
+		static const value_type& value(base_ptr x) {
+			return *__owner_of(static_cast<intrusive_rbtree_hook*>(x), Hook);
+		}
+		static void unlink(base_ptr x) {
+			x->set_parent(nullptr);
+			x->left = nullptr;
+			x->right = nullptr;
+			x->set_color(__rbtree_red);
+		}
+		void reset_header() {
+			header.set_color(__rbtree_red);
+			header.set_parent(nullptr);
+			header.left = &header;
+			header.right = &header;
+		}
+	};
+
+	// find an object equal to v, O(lgn)
+	template<typename T, intrusive_rbtree_hook T::*Hook, typename Compare>
+	typename intrusive_rbtree<T, Hook, Compare>::iterator
+		intrusive_rbtree<T, Hook, Compare>::find(const value_type& v) const {
+		base_ptr x = header.parent();
+		while (x != nullptr) {
+			if (cmp(v, value(x)))
+				x = x->left;
+			else if (cmp(value(x), v))
+				x = x->right;
+			else
+				return iterator(x);
+		}
+		return end();
+	}
+
+	template<typename T, intrusive_rbtree_hook T::*Hook, typename Compare>
+	pair<typename intrusive_rbtree<T, Hook, Compare>::iterator, bool>
+		intrusive_rbtree<T, Hook, Compare>::insert(reference x) {
+		// y : parent of the new node, z : node used to find proper position
+		base_ptr y = &header;
+		base_ptr z = header.parent();
+		bool insert_left = true;
+		while (z != nullptr) {
+			y = z;
+			if (cmp(x, value(z))) {
+				insert_left = true;
+				z = z->left;
+			}
+			else if (cmp(value(z), x)) {
+				insert_left = false;
+				z = z->right;
+			}
+			else
+				return pair<iterator, bool>(iterator(z), false);
+		}
+		base_ptr node = &(x.*Hook);
+		__rbtree_insert_and_rebalance(insert_left, node, y, header);
+		++__size;
+		return pair<iterator, bool>(iterator(node), true);
+	}
+
+	template<typename T, intrusive_rbtree_hook T::*Hook, typename Compare>
+	typename intrusive_rbtree<T, Hook, Compare>::iterator
+		intrusive_rbtree<T, Hook, Compare>::insert_equal(reference x) {
+		base_ptr y = &header;
+		base_ptr z = header.parent();
+		bool insert_left = true;
+		while (z != nullptr) {
+			y = z;
+			insert_left = cmp(x, value(z));
+			z = insert_left ? z->left : z->right;
+		}
+		base_ptr node = &(x.*Hook);
+		__rbtree_insert_and_rebalance(insert_left, node, y, header);
+		++__size;
+		return iterator(node);
+	}
+
+	template<typename T, intrusive_rbtree_hook T::*Hook, typename Compare>
+	void intrusive_rbtree<T, Hook, Compare>::clear() {
+		// unlink every hook, walking down and back up along the parent links without recursion
+		base_ptr x = header.parent();
+		while (x != nullptr) {
+			if (x->left != nullptr)
+				x = x->left;
+			else if (x->right != nullptr)
+				x = x->right;
+			else {
+				base_ptr parent = x->parent();
+				if (parent != &header) {
+					if (parent->left == x)
+						parent->left = nullptr;
+					else
+						parent->right = nullptr;
+				}
+				unlink(x);
+				x = parent == &header ? nullptr : parent;
+			}
+		}
+		reset_header();
+		__size = 0;
+	}
+
+	template<typename T, intrusive_rbtree_hook T::*Hook, typename Compare>
+	void intrusive_rbtree<T, Hook, Compare>::swap(intrusive_rbtree& other) noexcept {
+		ezSTL::swap(header.parent_color, other.header.parent_color);
+		ezSTL::swap(header.left, other.header.left);
+		ezSTL::swap(header.right, other.header.right);
+		ezSTL::swap(__size, other.__size);
+		ezSTL::swap(cmp, other.cmp);
+		// the root, leftmost and rightmost still refer to the header of the other tree
+		if (header.parent() == nullptr)
+			reset_header();
+		else
+			header.parent()->set_parent(&header);
+		if (other.header.parent() == nullptr)
+			other.reset_header();
+		else
+			other.header.parent()->set_parent(&other.header);
+	}
+}
+
+#endif // !EZSTL_INTRUSIVE_RBTREE_H
@@ -17,12 +17,25 @@
 // 12. iterator insert(iterator pos, const_reference x);
 // 13. iterator erase(iterator pos);
 // 14. void clear();
+// 15. void splice(iterator pos, list& x);
+// 16. void splice(iterator pos, list& x, iterator i);
+// 17. void splice(iterator pos, list& x, iterator first, iterator last);
+// 18. void merge(list& x, Compare cmp = Compare());
+// 19. void reverse();
+// 20. void unique(BinaryPredicate pred = BinaryPredicate());
+// 21. void remove(const_reference x);
+// 22. void remove_if(Predicate pred);
+// 23. void sort(Compare cmp = Compare());
+//
+// splice, merge, reverse, unique, remove_if and sort only relink nodes, no node is copied or allocated
 
 #ifndef EZSTL_LIST_H
 #define EZSTL_LIST_H
 
 #include "iterator.h"
 #include "memory.h"
+#include "functional.h"
+#include "utility.h"
 
 namespace ezSTL {
 
@@ -80,7 +93,7 @@ namespace ezSTL {
  			node = node->next;
 			return *this;
 		}
-		self& operator++(int) {
+		self operator++(int) {
 			self temp = *this;
 			++(*this);
 			return temp;
@@ -90,7 +103,7 @@ namespace ezSTL {
 			node = node->prev;
 			return *this;
 		}
-		self& operator--(int) {
+		self operator--(int) {
 			self temp = *this;
 			--(*this);
 			return temp;
@@ -98,13 +111,13 @@ namespace ezSTL {
 
 		self operator+ (difference_type n) const {
 			self temp = *this;
-			advance(temp, n);
+			ezSTL::advance(temp, n);
 			return temp;
 		}
 
 		self operator-(difference_type n) const {
 			self temp = *this;
-			advance(temp, -n);
+			ezSTL::advance(temp, -n);
 			return temp;
 		}
 	};
@@ -138,22 +151,19 @@ namespace ezSTL {
 		}
 		list(const list<T, Alloc>&);
 		list<T, Alloc>& operator=(const list<T, Alloc>&);
-		list(list<T, Alloc>&& other) noexcept: list_iterator(other.list_iterator), __size(other.__size) {
-			other.__size = 0;
+		// other is left empty with a fresh header node, so both lists own their own header
+		list(list<T, Alloc>&& other) noexcept: list() {
+			swap(other);
 		}
 		list<T, Alloc>& operator=(list<T, Alloc>&& other) noexcept {
-			list_iterator = other.list_iterator;
-			__size = other.__size;
-			other.__size = 0;
+			swap(other);
 			return *this;
 		}
 		// destructor
 		~list() {
-			if (!empty()) {
-				clear();
-				Alloc().destroy(list_iterator.node);
-				Alloc().deallocate(list_iterator.node);
-			}
+			clear();
+			Alloc().destroy(list_iterator.node);
+			Alloc().deallocate(list_iterator.node);
 		}
 
 		// some common functions for list
@@ -182,6 +192,34 @@ namespace ezSTL {
 		iterator insert(iterator pos, const_reference x);
 		iterator erase(iterator pos);
 		void clear();
+		void swap(list<T, Alloc>& other) noexcept {
+			ezSTL::swap(list_iterator.node, other.list_iterator.node);
+			ezSTL::swap(__size, other.__size);
+		}
+
+		// relinking operations
+		void splice(iterator pos, list<T, Alloc>& x);
+		void splice(iterator pos, list<T, Alloc>& x, iterator i);
+		void splice(iterator pos, list<T, Alloc>& x, iterator first, iterator last);
+		template<typename Compare = less<T>>
+		void merge(list<T, Alloc>& x, Compare cmp = Compare());
+		void reverse();
+		template<typename BinaryPredicate = equal_to<T>>
+		void unique(BinaryPredicate pred = BinaryPredicate());
+		void remove(const_reference x);
+		template<typename Predicate>
+		void remove_if(Predicate pred);
+		template<typename Compare = less<T>>
+		void sort(Compare cmp = Compare());
+
+	protected:
+		// move [first, last) before pos, pos must not be in [first, last)
+		static void transfer(link_type pos, link_type first, link_type last);
+		// merge two sorted null terminated chains linked by next, a goes first on ties
+		template<typename Compare>
+		static link_type merge_chain(link_type a, link_type b, Compare& cmp);
+		// unlink node and release it
+		void destroy_node(link_type node);
 	};
 
 	template<typename T, typename Alloc>
@@ -209,24 +247,10 @@ namespace ezSTL {
 	template<typename T, typename Alloc>
 	list<T, Alloc>& list<T, Alloc>::operator=(const list<T, Alloc>& other) {
 		if (this != &other) {
-			Alloc alloc = Alloc();
-			link_type prev_node = alloc.allocate();
-			alloc.construct(prev_node, __list_node<T>());
-			list_iterator.node = prev_node;
-			__size = 0;
-			// copy each node of other
-			for (iterator ite = other.begin(); ite != other.end(); ++ite) {
-				link_type new_node = alloc.allocate();
-				alloc.construct(new_node, __list_node<T>(*ite));
-				if (ite == other.begin())
-					list_iterator.node->next = new_node;
-				prev_node->next = new_node;
-				new_node->prev = prev_node;
-				prev_node = new_node;
-				++__size;
-			}
-			prev_node->next = list_iterator.node;
-			list_iterator.node->prev = prev_node;
+			// keep the header node, release the old elements
+			clear();
+			for (iterator ite = other.begin(); ite != other.end(); ++ite)
+				push_back(*ite);
 		}
 		return *this;
 	}
@@ -320,6 +344,195 @@ namespace ezSTL {
 		list_iterator.node->next = list_iterator.node;
 		__size = 0;
 	}
+
+	template<typename T, typename Alloc>
+	void list<T, Alloc>::transfer(link_type pos, link_type first, link_type last) {
+		if (pos == first || pos == last || first == last)
+			return;
+		link_type tail = last->prev;
+		// cut [first, last) out of its list
+		first->prev->next = last;
+		last->prev = first->prev;
+		// link it before pos
+		first->prev = pos->prev;
+		tail->next = pos;
+		pos->prev->next = first;
+		pos->prev = tail;
+	}
+
+	template<typename T, typename Alloc>
+	void list<T, Alloc>::destroy_node(link_type node) {
+		node->prev->next = node->next;
+		node->next->prev = node->prev;
+		Alloc().destroy(node);
+		Alloc().deallocate(node);
+		--__size;
+	}
+
+	template<typename T, typename Alloc>
+	void list<T, Alloc>::splice(iterator pos, list<T, Alloc>& x) {
+		if (this == &x || x.empty())
+			return;
+		transfer(pos.node, x.begin().node, x.end().node);
+		__size += x.__size;
+		x.__size = 0;
+	}
+
+	template<typename T, typename Alloc>
+	void list<T, Alloc>::splice(iterator pos, list<T, Alloc>& x, iterator i) {
+		link_type next = i.node->next;
+		if (pos.node == i.node || pos.node == next)
+			return;
+		transfer(pos.node, i.node, next);
+		++__size;
+		--x.__size;
+	}
+
+	template<typename T, typename Alloc>
+	void list<T, Alloc>::splice(iterator pos, list<T, Alloc>& x, iterator first, iterator last) {
+		if (first == last)
+			return;
+		// only a range taken from another list changes the sizes, counting it is O(n)
+		if (this != &x) {
+			size_type n = 0;
+			for (link_type node = first.node; node != last.node; node = node->next)
+				++n;
+			__size += n;
+			x.__size -= n;
+		}
+		transfer(pos.node, first.node, last.node);
+	}
+
+	template<typename T, typename Alloc>
+	template<typename Compare>
+	void list<T, Alloc>::merge(list<T, Alloc>& x, Compare cmp) {
+		if (this == &x)
+			return;
+		link_type first1 = begin().node, last1 = end().node;
+		link_type first2 = x.begin().node, last2 = x.end().node;
+		while (first1 != last1 && first2 != last2) {
+			if (cmp(first2->data, first1->data)) {
+				// move the whole run of x that goes before first1 at once
+				link_type run = first2->next;
+				while (run != last2 && cmp(run->data, first1->data))
+					run = run->next;
+				transfer(first1, first2, run);
+				first2 = run;
+			}
+			else
+				first1 = first1->next;
+		}
+		transfer(last1, first2, last2);
+		__size += x.__size;
+		x.__size = 0;
+	}
+
+	template<typename T, typename Alloc>
+	void list<T, Alloc>::reverse() {
+		link_type node = list_iterator.node;
+		// swap prev and next of every node including the header
+		do {
+			ezSTL::swap(node->prev, node->next);
+			node = node->prev;
+		} while (node != list_iterator.node);
+	}
+
+	template<typename T, typename Alloc>
+	template<typename BinaryPredicate>
+	void list<T, Alloc>::unique(BinaryPredicate pred) {
+		if (size() < 2)
+			return;
+		link_type first = begin().node, last = end().node;
+		link_type next = first->next;
+		while (next != last) {
+			if (pred(first->data, next->data))
+				destroy_node(next);
+			else
+				first = next;
+			next = first->next;
+		}
+	}
+
+	template<typename T, typename Alloc>
+	void list<T, Alloc>::remove(const_reference x) {
+		// x may refer to an element of the list, so compare by value before any node is released
+		T value = x;
+		remove_if([&value](const T& data) { return data == value; });
+	}
+
+	template<typename T, typename Alloc>
+	template<typename Predicate>
+	void list<T, Alloc>::remove_if(Predicate pred) {
+		link_type node = begin().node, last = end().node;
+		while (node != last) {
+			link_type next = node->next;
+			if (pred(node->data))
+				destroy_node(node);
+			node = next;
+		}
+	}
+
+	template<typename T, typename Alloc>
+	template<typename Compare>
+	typename list<T, Alloc>::link_type
+		list<T, Alloc>::merge_chain(link_type a, link_type b, Compare& cmp) {
+		link_type head = nullptr;
+		link_type* tail = &head;
+		while (a != nullptr && b != nullptr) {
+			if (cmp(b->data, a->data)) {
+				*tail = b;
+				b = b->next;
+			}
+			else {
+				*tail = a;
+				a = a->next;
+			}
+			tail = &(*tail)->next;
+		}
+		*tail = a != nullptr ? a : b;
+		return head;
+	}
+
+	template<typename T, typename Alloc>
+	template<typename Compare>
+	void list<T, Alloc>::sort(Compare cmp) {
+		if (size() < 2)
+			return;
+		link_type header = list_iterator.node;
+		// bottom up merge sort on a null terminated chain of next pointers,
+		// bins[i] is empty or holds a sorted run of 2^i nodes that precede the later ones
+		const int max_bins = sizeof(size_type) * 8 + 1;
+		link_type bins[max_bins] = {};
+		int fill = 0;
+		header->prev->next = nullptr;
+		link_type node = header->next;
+		while (node != nullptr) {
+			link_type carry = node;
+			node = node->next;
+			carry->next = nullptr;
+			int i = 0;
+			for (; i < fill && bins[i] != nullptr; ++i) {
+				carry = merge_chain(bins[i], carry, cmp);
+				bins[i] = nullptr;
+			}
+			bins[i] = carry;
+			if (i == fill)
+				++fill;
+		}
+		link_type result = nullptr;
+		for (int i = 0; i < fill; ++i)
+			if (bins[i] != nullptr)
+				result = result == nullptr ? bins[i] : merge_chain(bins[i], result, cmp);
+		// restore the prev pointers and close the ring
+		link_type prev = header;
+		for (node = result; node != nullptr; node = node->next) {
+			prev->next = node;
+			node->prev = prev;
+			prev = node;
+		}
+		prev->next = header;
+		header->prev = prev;
+	}
 }
 
 #endif // !EZSTL_LIST_H
@@ -1,16 +1,47 @@
 /*********************************************************************************************/
 // class map:
-// using rbtree as base container
+// using rbtree as base container, the pairs are ordered by Compare on their keys only
 // including some basic functions of map:
 //
 // 1. iterator begin() const;
 // 2. iterator end() const;
 // 3. size_type size() const;
 // 4. bool empty() const;
-// 5. iterator find(const T& v) const;
-// 6. void insert(const T& v);
-// 7. void erase(iterator pos);
-// 8. void clear();
+// 5. iterator find(const Key& k) const;
+// 6. iterator lower_bound(const Key& k) const;
+// 7. iterator upper_bound(const Key& k) const;
+// 8. pair<iterator, iterator> equal_range(const Key& k) const;
+// 9. pair<iterator, bool> insert(const pair<Key, Value>& v);
+// 10. iterator insert(iterator hint, const pair<Key, Value>& v);
+// 11. pair<iterator, bool> emplace(Args&&... args);
+// 12. iterator emplace_hint(iterator hint, Args&&... args);
+// 13. void insert(Iterator first, Iterator last);
+// 14. void erase(iterator pos);
+// 15. iterator erase(iterator first, iterator last);
+// 16. void for_each_in_range(const Key& lo, const Key& hi, Function f) const;
+// 17. void clear();
+// 18. Compare key_comp() const;
+// 19. value_compare value_comp() const;
+// 20. void merge(map& batch, const Fork& fork = Fork());
+// 21. Value& operator[] (const Key& k);
+// 22. Value& at(const Key& k) const;
+// 23. size_type count(const Key& k) const;
+// 24. bool contains(const Key& k) const;
+// 25. node_type extract(iterator pos);
+// 26. node_type extract(const Key& k);
+// 27. pair<iterator, bool> insert(node_type&& nh);
+// 28. void clone_from(const map& other, const Fork& fork = Fork());
+// 29. void swap(map& other);
+// 30. void deferred_clear(Reclaimer& reclaimer);
+// with Augment = rbtree_order_statistics:
+// 31. iterator nth(size_type k) const;
+// 32. size_type rank(const Key& k) const;
+// 33. size_type count_range(const Key& lo, const Key& hi) const;
+//
+// of equal keys in a range the first pair is inserted
+// merge moves the pairs of batch in, replacing the pairs of equal keys, and leaves batch empty
+// at throws std::out_of_range for a missing key; with a transparent Compare such as less<>,
+// the lookups, at, count and contains take any K comparable with Key
 
 #ifndef EZSTL_MAP_H
 #define EZSTL_MAP_H
@@ -19,20 +50,31 @@
 #include "memory.h"
 #include "rbtree.h"
 #include "utility.h"
+#include <stdexcept>
 
 namespace ezSTL {
-	template<typename Key, typename Value, typename Compare = less<pair<Key, Value>>, 
-		typename Alloc = allocator<__rbtree_node<pair<Key, Value>>>>
+	template<typename Key, typename Value, typename Compare = less<Key>,
+		typename Alloc = allocator<pair<Key, Value>>, typename Augment = rbtree_no_augment>
 	class map {
 	public:
+		using base_tree = rbtree<pair<Key, Value>, Compare, Alloc, Augment, select1st<pair<Key, Value>>>;
 		using size_type = unsigned int;
+		using key_type = Key;
 		using value_type = Value;
-		using iterator = __rbtree_iterator<pair<Key, Value>>;
+		using iterator = typename base_tree::iterator;
 		using const_iterator = const iterator;
+		using value_compare = typename base_tree::value_compare;
 		using difference_type = int;
+		using node_type = typename base_tree::node_type;
 	protected:
-		rbtree<pair<Key, Value>, Compare, Alloc> base_rbt;
+		base_tree base_rbt;
 	public:
+		// constructor
+		map() = default;
+		template<typename Iterator>
+		map(Iterator first, Iterator last) {
+			base_rbt.insert(first, last);
+		}
 
 		iterator begin() const {
 			return base_rbt.begin();
@@ -46,21 +88,161 @@ namespace ezSTL {
 		bool empty() const {
 			return base_rbt.empty();
 		}
-		// find a pair according a specific Key 
-		iterator find(const Key& v) const {
-			return base_rbt.find(make_pair(v, Value()));
+		// find a pair according a specific Key
+		iterator find(const Key& k) const {
+			return base_rbt.find(k);
+		}
+		// the first pair whose key is not less than k
+		iterator lower_bound(const Key& k) const {
+			return base_rbt.lower_bound(k);
+		}
+		// the first pair whose key is greater than k
+		iterator upper_bound(const Key& k) const {
+			return base_rbt.upper_bound(k);
+		}
+		pair<iterator, iterator> equal_range(const Key& k) const {
+			return base_rbt.equal_range(k);
+		}
+		// the lookups by any K comparable with Key, only with a transparent Compare
+		template<typename K, typename = typename __if_transparent<Compare, K>::type>
+		iterator find(const K& k) const {
+			return base_rbt.find(k);
+		}
+		template<typename K, typename = typename __if_transparent<Compare, K>::type>
+		iterator lower_bound(const K& k) const {
+			return base_rbt.lower_bound(k);
+		}
+		template<typename K, typename = typename __if_transparent<Compare, K>::type>
+		iterator upper_bound(const K& k) const {
+			return base_rbt.upper_bound(k);
+		}
+		template<typename K, typename = typename __if_transparent<Compare, K>::type>
+		pair<iterator, iterator> equal_range(const K& k) const {
+			return base_rbt.equal_range(k);
+		}
+		// insert a pair, nothing changes if the key exists
+		pair<iterator, bool> insert(const pair<Key, Value>& v) {
+			return base_rbt.insert(v);
 		}
-		// insert a pair
-		void insert(const pair<Key, Value>& v) {
-			base_rbt.insert(v);
+		// insert a pair, searching from the position before hint
+		iterator insert(iterator hint, const pair<Key, Value>& v) {
+			return base_rbt.insert(hint, v);
+		}
+		template<typename... Args>
+		pair<iterator, bool> emplace(Args&&... args) {
+			return base_rbt.emplace(ezSTL::forward<Args>(args)...);
+		}
+		template<typename... Args>
+		iterator emplace_hint(iterator hint, Args&&... args) {
+			return base_rbt.emplace_hint(hint, ezSTL::forward<Args>(args)...);
+		}
+		// insert a range of values, O(n) for a sorted range into an empty map
+		template<typename Iterator>
+		void insert(Iterator first, Iterator last) {
+			base_rbt.insert(first, last);
 		}
 		// erase an iterator
 		void erase(iterator pos) {
 			base_rbt.erase(pos);
 		}
+		// erase a range of iterators, return last
+		iterator erase(iterator first, iterator last) {
+			return base_rbt.erase(first, last);
+		}
+		// f(p) for every pair p with a key in [lo, hi)
+		template<typename Function>
+		void for_each_in_range(const Key& lo, const Key& hi, Function f) const {
+			base_rbt.for_each_in_range(lo, hi, f);
+		}
 		void clear() {
 			base_rbt.clear();
 		}
+		Compare key_comp() const {
+			return base_rbt.key_comp();
+		}
+		// orders the pairs by key
+		value_compare value_comp() const {
+			return base_rbt.value_comp();
+		}
+		// move the pairs of batch into this map, the values of batch win
+		template<typename Fork = serial_fork>
+		void merge(map& batch, const Fork& fork = Fork()) {
+			base_rbt.union_with(batch.base_rbt, true, fork);
+		}
+		// the value of k, a value initialized Value is inserted first if k is missing
+		Value& operator[] (const Key& k) {
+			iterator ite = base_rbt.lower_bound(k);
+			if (ite == end() || __compare_traits<Compare>::less(key_comp(), k, ite->first))
+				ite = base_rbt.emplace_hint(ite, k, Value());
+			return ite->second;
+		}
+		// the value of k, std::out_of_range if k is missing
+		Value& at(const Key& k) const {
+			return checked_value(base_rbt.find(k));
+		}
+		template<typename K, typename = typename __if_transparent<Compare, K>::type>
+		Value& at(const K& k) const {
+			return checked_value(base_rbt.find(k));
+		}
+		// 1 if k is in the map, 0 otherwise
+		size_type count(const Key& k) const {
+			return base_rbt.find(k) != end() ? 1 : 0;
+		}
+		template<typename K, typename = typename __if_transparent<Compare, K>::type>
+		size_type count(const K& k) const {
+			return base_rbt.find(k) != end() ? 1 : 0;
+		}
+		bool contains(const Key& k) const {
+			return base_rbt.find(k) != end();
+		}
+		template<typename K, typename = typename __if_transparent<Compare, K>::type>
+		bool contains(const K& k) const {
+			return base_rbt.find(k) != end();
+		}
+		// take the node of pos out of the map
+		node_type extract(iterator pos) {
+			return base_rbt.extract(pos);
+		}
+		// take the node of k out of the map, an empty handle if k is missing
+		node_type extract(const Key& k) {
+			return base_rbt.extract(k);
+		}
+		// link the node of nh into the map, it stays in nh if the key exists
+		pair<iterator, bool> insert(node_type&& nh) {
+			return base_rbt.insert(ezSTL::move(nh));
+		}
+		// replace the pairs with copies of the pairs of other
+		template<typename Fork = serial_fork>
+		void clone_from(const map& other, const Fork& fork = Fork()) {
+			base_rbt.clone_from(other.base_rbt, fork);
+		}
+		void swap(map& other) {
+			base_rbt.swap(other.base_rbt);
+		}
+		// empty the map now, reclaimer destroys the pairs later
+		template<typename Reclaimer>
+		void deferred_clear(Reclaimer& reclaimer) {
+			base_rbt.deferred_clear(reclaimer);
+		}
+		// the pair of the k-th smallest key counting from 0, end() if k >= size()
+		iterator nth(size_type k) const {
+			return base_rbt.nth(k);
+		}
+		// the number of keys less than k
+		size_type rank(const Key& k) const {
+			return base_rbt.rank(k);
+		}
+		// the number of keys in [lo, hi)
+		size_type count_range(const Key& lo, const Key& hi) const {
+			return base_rbt.count_range(lo, hi);
+		}
+
+	protected:
+		Value& checked_value(iterator ite) const {
+			if (ite == end())
+				throw std::out_of_range("ezSTL::map::at: key not found");
+			return ite->second;
+		}
 	};
 }
 
@@ -2,8 +2,10 @@
 // class allocator: a default simple allocacator, including four functions of allocator:
 // 1. pointer allocate(const size_type n = 1);
 // 2. void construct(pointer ptr, const_reference value);
+//    void construct(pointer ptr, Args&&... args);
 // 3. void destroy(pointer ptr);
 // 4. void deallocate(pointer ptr, size_type n = 1);
+// allocator<T>::rebind<U>::other is allocator<U>, containers use it to allocate their nodes
 //
 // class shared_ptr:
 // 1. T& operator* ();
@@ -51,6 +53,13 @@ namespace ezSTL {
 		using size_type = unsigned int;
 		using difference_type = int;
 
+		// the same allocator for another type
+		template<typename U>
+		class rebind {
+		public:
+			using other = allocator<U>;
+		};
+
 		// allocates storage
 		pointer allocate(const size_type n = 1) {
 			return static_cast<pointer>(::operator new(n * sizeof(value_type)));
@@ -59,6 +68,11 @@ namespace ezSTL {
 		void construct(pointer ptr, const_reference value) {
 			new(ptr) value_type(value);
 		}
+		// construct one object from arguments of its constructor
+		template<typename... Args>
+		void construct(pointer ptr, Args&&... args) {
+			new(ptr) value_type(ezSTL::forward<Args>(args)...);
+		}
 		// destroy one object
 		void destroy(pointer ptr) {
 			if (ptr) ptr->~T();
@@ -0,0 +1,92 @@
+/*********************************************************************************************/
+// class node_handle:
+// owns one node taken out of a container by extract, so the value can move to another
+// container of the same node type by insert without being copied, freed or allocated again
+// including some basic functions of node_handle:
+//
+// 1. bool empty() const;
+// 2. explicit operator bool() const;
+// 3. T& value() const;
+// 4. key_type& key() const;
+// 5. mapped_type& mapped() const;
+//
+// usage:
+// auto nh = active.extract(key);
+// nh.key() = new_key; // optional, the key may change while the node is out of the container
+// archive.insert(ezSTL::move(nh));
+//
+// key and mapped are only for pairs, the nodes of map and unordered_map; the value of a set node,
+// and the key of a map node, may be changed freely since the node is in no container;
+// a node handle is move only and destroys its node if it still owns one when it dies
+
+#ifndef EZSTL_NODE_HANDLE_H
+#define EZSTL_NODE_HANDLE_H
+
+namespace ezSTL {
+
+	// Node holds the value in data and is allocated and destroyed by NodeAlloc, as the container did
+	template<typename T, typename Node, typename NodeAlloc>
+	class node_handle {
+	public:
+		using value_type = T;
+
+		// constructor
+		node_handle() : node(nullptr) {}
+		// take a node unlinked from a container
+		explicit node_handle(Node* x) : node(x) {}
+		node_handle(const node_handle&) = delete;
+		node_handle(node_handle&& nh) noexcept : node(nh.node) {
+			nh.node = nullptr;
+		}
+		node_handle& operator=(const node_handle&) = delete;
+		node_handle& operator=(node_handle&& nh) noexcept {
+			if (this != &nh) {
+				reset();
+				node = nh.node;
+				nh.node = nullptr;
+			}
+			return *this;
+		}
+		// destructor
+		~node_handle() {
+			reset();
+		}
+
+		bool empty() const {
+			return node == nullptr;
+		}
+		explicit operator bool() const {
+			return node != nullptr;
+		}
+		T& value() const {
+			return node->data;
+		}
+		template<typename P = T>
+		typename P::first_type& key() const {
+			return node->data.first;
+		}
+		template<typename P = T>
+		typename P::second_type& mapped() const {
+			return node->data.second;
+		}
+		// give up the node to the container linking it
+		Node* release() {
+			Node* x = node;
+			node = nullptr;
+			return x;
+		}
+
+	protected:
+		void reset() {
+			if (node != nullptr) {
+				NodeAlloc().destroy(node);
+				NodeAlloc().deallocate(node);
+				node = nullptr;
+			}
+		}
+
+		Node* node;
+	};
+}
+
+#endif // !EZSTL_NODE_HANDLE_H
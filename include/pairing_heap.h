@@ -0,0 +1,230 @@
+/*********************************************************************************************/
+// class pairing_heap:
+// an addressable heap, using a multiway tree with two-pass pairing
+// cmp(a, b) == true means a is closer to top than b
+// push returns a handle which stays valid until the value is popped or erased
+//
+// 1. bool empty() const;
+// 2. size_type size() const;
+// 3. const_reference top() const;
+// 4. handle_type top_handle() const;
+// 5. handle_type push(const_reference x);
+//    handle_type push(value_type&& x);
+// 6. void pop();
+// 7. void update(handle_type h, const_reference x);
+// 8. void erase(handle_type h);
+// 9. const_reference get(handle_type h) const;
+// 10. void clear();
+
+#ifndef EZSTL_PAIRING_HEAP_H
+#define EZSTL_PAIRING_HEAP_H
+
+#include "functional.h"
+#include "memory.h"
+#include "utility.h"
+
+namespace ezSTL {
+
+	// node of pairing heap
+	template<typename T>
+	class __pairing_heap_node {
+	public:
+		using link_type = __pairing_heap_node<T>*;
+		__pairing_heap_node(const T& v) : child(nullptr), sibling(nullptr), prev(nullptr), value(v) {}
+		__pairing_heap_node(T&& v) : child(nullptr), sibling(nullptr), prev(nullptr), value(ezSTL::move(v)) {}
+		// leftmost child
+		link_type child;
+		// right sibling
+		link_type sibling;
+		// left sibling, or parent if it is the leftmost child
+		link_type prev;
+		T value;
+	};
+
+	template<typename T, typename Compare = less<T>, typename Alloc = allocator<__pairing_heap_node<T>>>
+	class pairing_heap {
+	public:
+		using value_type = T;
+		using size_type = unsigned int;
+		using link_type = __pairing_heap_node<T>*;
+		using handle_type = __pairing_heap_node<T>*;
+		using reference = T&;
+		using const_reference = const T&;
+
+	protected:
+		link_type root;
+		size_type __size;
+		Compare cmp;
+
+		// link two trees, the root with lower priority becomes the leftmost child of the other
+		link_type meld(link_type a, link_type b) {
+			if (cmp(b->value, a->value))
+				ezSTL::swap(a, b);
+			b->prev = a;
+			b->sibling = a->child;
+			if (a->child)
+				a->child->prev = b;
+			a->child = b;
+			return a;
+		}
+		// detach the subtree x from its parent and siblings, x is not root
+		void cut(link_type x) {
+			if (x->prev->child == x)
+				x->prev->child = x->sibling;
+			else
+				x->prev->sibling = x->sibling;
+			if (x->sibling)
+				x->sibling->prev = x->prev;
+			x->prev = nullptr;
+			x->sibling = nullptr;
+		}
+		// two-pass pairing of a list of siblings, return the new tree
+		link_type merge_pairs(link_type first);
+		// insert a detached node
+		void push_node(link_type x) {
+			root = root ? meld(root, x) : x;
+			++__size;
+		}
+		// detach node x from the heap
+		void remove_node(link_type x);
+
+	public:
+		pairing_heap() : root(nullptr), __size(0) {}
+		explicit pairing_heap(const Compare& c) : root(nullptr), __size(0), cmp(c) {}
+		pairing_heap(const pairing_heap<T, Compare, Alloc>&) = delete;
+		pairing_heap<T, Compare, Alloc>& operator=(const pairing_heap<T, Compare, Alloc>&) = delete;
+		~pairing_heap() {
+			clear();
+		}
+
+		bool empty() const {
+			return __size == 0;
+		}
+		size_type size() const {
+			return __size;
+		}
+		const_reference top() const {
+			return root->value;
+		}
+		handle_type top_handle() const {
+			return root;
+		}
+		const_reference get(handle_type h) const {
+			return h->value;
+		}
+		handle_type push(const_reference x) {
+			link_type z = Alloc().allocate();
+			Alloc().construct(z, x);
+			push_node(z);
+			return z;
+		}
+		handle_type push(value_type&& x) {
+			link_type z = Alloc().allocate();
+			Alloc().construct(z, ezSTL::move(x));
+			push_node(z);
+			return z;
+		}
+		void pop() {
+			erase(root);
+		}
+		void erase(handle_type h) {
+			remove_node(h);
+			Alloc().destroy(h);
+			Alloc().deallocate(h);
+		}
+		// change the value of h, O(1) if it moves towards top (decrease-key), O(log n) amortized otherwise
+		void update(handle_type h, const_reference x);
+		void clear();
+	};
+
+	template<typename T, typename Compare, typename Alloc>
+	typename pairing_heap<T, Compare, Alloc>::link_type pairing_heap<T, Compare, Alloc>::merge_pairs(link_type first) {
+		if (first == nullptr)
+			return nullptr;
+		// first pass: meld pairs from left to right, the results are chained in reverse order
+		link_type result = nullptr;
+		while (first) {
+			link_type a = first;
+			link_type b = a->sibling;
+			if (b == nullptr) {
+				a->prev = nullptr;
+				a->sibling = result;
+				result = a;
+				break;
+			}
+			first = b->sibling;
+			a->prev = a->sibling = nullptr;
+			b->prev = b->sibling = nullptr;
+			a = meld(a, b);
+			a->sibling = result;
+			result = a;
+		}
+		// second pass: meld from right to left
+		link_type tree = result;
+		result = result->sibling;
+		tree->sibling = nullptr;
+		while (result) {
+			link_type next = result->sibling;
+			result->sibling = nullptr;
+			tree = meld(tree, result);
+			result = next;
+		}
+		tree->prev = nullptr;
+		return tree;
+	}
+
+	template<typename T, typename Compare, typename Alloc>
+	void pairing_heap<T, Compare, Alloc>::remove_node(link_type x) {
+		if (x == root)
+			root = merge_pairs(x->child);
+		else {
+			cut(x);
+			link_type subtree = merge_pairs(x->child);
+			if (subtree)
+				root = meld(root, subtree);
+		}
+		x->child = nullptr;
+		--__size;
+	}
+
+	template<typename T, typename Compare, typename Alloc>
+	void pairing_heap<T, Compare, Alloc>::update(handle_type h, const_reference x) {
+		// decrease-key: cut the subtree and meld it with root, heap order inside it still holds
+		if (!cmp(h->value, x)) {
+			h->value = x;
+			if (h != root) {
+				cut(h);
+				root = meld(root, h);
+			}
+		}
+		// increase-key: children may now be closer to top, reinsert the node
+		else {
+			remove_node(h);
+			h->value = x;
+			push_node(h);
+		}
+	}
+
+	template<typename T, typename Compare, typename Alloc>
+	void pairing_heap<T, Compare, Alloc>::clear() {
+		// free nodes without recursion, each node's children are spliced into the list to visit
+		link_type list = root;
+		while (list) {
+			link_type x = list;
+			list = x->sibling;
+			if (x->child) {
+				link_type last = x->child;
+				while (last->sibling)
+					last = last->sibling;
+				last->sibling = list;
+				list = x->child;
+			}
+			Alloc().destroy(x);
+			Alloc().deallocate(x);
+		}
+		root = nullptr;
+		__size = 0;
+	}
+}
+
+#endif // !EZSTL_PAIRING_HEAP_H
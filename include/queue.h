@@ -11,20 +11,46 @@
 // 6. void pop();
 //
 // class priority_queue:
-// using vector as base container
+// using vector as base container, a d-ary heap (binary by default)
+// cmp(a, b) == true means a is closer to top than b
 // including some basic functions of priority_queue:
 //
 // 1. bool empty() const;
 // 2. size_type size() const;
 // 3. reference top() const;
 // 4. void push(const_reference x);
-// 5. void pop();
+//    void push(value_type&& x);
+// 5. void emplace(Args&&... args);
+// 6. void pop();
+// 7. void reserve(size_type n);
+// 8. priority_queue(InputIterator first, InputIterator last), O(n) heapify
+//
+// class indexed_priority_queue:
+// an addressable priority_queue on the same vector based d-ary heap,
+// push returns a handle which can be used to change or remove the value later, the handle
+// carries a generation so that it is never mistaken for a later push reusing its slot
+//
+// 1. bool empty() const;
+// 2. size_type size() const;
+// 3. const_reference top() const;
+// 4. handle_type top_handle() const;
+// 5. handle_type push(const_reference x);
+//    handle_type push(value_type&& x);
+// 6. void pop();
+// 7. bool update(handle_type h, const_reference x);  false if h was popped or erased
+// 8. bool erase(handle_type h);                      false if h was popped or erased
+// 9. bool contains(handle_type h) const;
+// 10. const_reference get(handle_type h) const;
+// 11. void reserve(size_type n);
+// 12. void clear();
 
 #ifndef EZSTL_QUEUE_H
 #define EZSTL_QUEUE_H
 
 #include "list.h"
+#include "vector.h"
 #include "functional.h"
+#include "utility.h"
 
 namespace ezSTL {
 
@@ -59,8 +85,101 @@ namespace ezSTL {
 		}
 	};
 
-	template<typename T, typename Compare = less<T>>
+	// heap functions on a random access range, shared by the vector based heaps
+	// in a d-ary heap, children of index i are i * Arity + 1, ..., i * Arity + Arity
+	// elements are moved into a "hole" instead of being swapped level by level
+	// Tracker is called as track(element, index) whenever an element is placed at a new index
+
+	// tracker doing nothing, used by priority_queue
+	class __heap_no_tracking {
+	public:
+		template<typename T>
+		void operator()(const T&, unsigned int) const {}
+	};
+
+	// move the hole up from index hole until value can be placed, return the final index of value
+	template<unsigned int Arity, typename RandomIterator, typename T, typename Compare, typename Tracker>
+	inline unsigned int __heap_sift_up(RandomIterator first, unsigned int hole, T&& value, Compare& cmp, Tracker& track) {
+		while (hole > 0) {
+			unsigned int parent = (hole - 1) / Arity;
+			if (!cmp(value, first[parent]))
+				break;
+			first[hole] = ezSTL::move(first[parent]);
+			track(first[hole], hole);
+			hole = parent;
+		}
+		first[hole] = ezSTL::move(value);
+		track(first[hole], hole);
+		return hole;
+	}
+
+	// index of the child closest to top among the children of parent, child must exist
+	template<unsigned int Arity, typename RandomIterator, typename Compare>
+	inline unsigned int __heap_best_child(RandomIterator first, unsigned int parent, unsigned int n, Compare& cmp) {
+		unsigned int child = parent * Arity + 1;
+		unsigned int last = n - child > Arity ? child + Arity : n;
+		unsigned int best = child;
+		for (++child; child < last; ++child)
+			if (cmp(first[child], first[best]))
+				best = child;
+		return best;
+	}
+
+	// move the hole down from index hole in [0, n) until value can be placed, return the final index of value
+	template<unsigned int Arity, typename RandomIterator, typename T, typename Compare, typename Tracker>
+	inline unsigned int __heap_sift_down(RandomIterator first, unsigned int hole, unsigned int n, T&& value,
+		Compare& cmp, Tracker& track) {
+		// compare as unsigned long long, hole * Arity may overflow for huge heaps
+		while ((unsigned long long)hole * Arity + 1 < n) {
+			unsigned int best = __heap_best_child<Arity>(first, hole, n, cmp);
+			if (!cmp(first[best], value))
+				break;
+			first[hole] = ezSTL::move(first[best]);
+			track(first[hole], hole);
+			hole = best;
+		}
+		first[hole] = ezSTL::move(value);
+		track(first[hole], hole);
+		return hole;
+	}
+
+	// remove the top of heap [0, n + 1) and place value (the old last element) into [0, n)
+	// the hole goes down to a leaf without comparing with value, and then value goes up,
+	// since the old last element usually belongs near the bottom
+	template<unsigned int Arity, typename RandomIterator, typename T, typename Compare, typename Tracker>
+	inline void __heap_pop_hole(RandomIterator first, unsigned int n, T&& value, Compare& cmp, Tracker& track) {
+		unsigned int hole = 0;
+		while ((unsigned long long)hole * Arity + 1 < n) {
+			unsigned int best = __heap_best_child<Arity>(first, hole, n, cmp);
+			first[hole] = ezSTL::move(first[best]);
+			track(first[hole], hole);
+			hole = best;
+		}
+		__heap_sift_up<Arity>(first, hole, ezSTL::move(value), cmp, track);
+	}
+
+	// Floyd's bottom-up heap construction of [0, n), O(n)
+	template<unsigned int Arity, typename RandomIterator, typename Compare, typename Tracker>
+	inline void __make_heap(RandomIterator first, unsigned int n, Compare& cmp, Tracker& track) {
+		if (n < 2) {
+			if (n == 1)
+				track(first[0], 0);
+			return;
+		}
+		for (unsigned int i = (n - 2) / Arity + 1; i-- > 0;) {
+			auto value = ezSTL::move(first[i]);
+			__heap_sift_down<Arity>(first, i, n, ezSTL::move(value), cmp, track);
+		}
+		// sift down tracks the values it moves into leaf slots, not the leaves it leaves in place,
+		// so track every leaf again
+		for (unsigned int i = (n - 2) / Arity + 1; i < n; ++i)
+			track(first[i], i);
+	}
+
+	// Arity: number of children of each node, 4 or 8 makes a shallower and cache friendlier heap
+	template<typename T, typename Compare = less<T>, unsigned int Arity = 2>
 	class priority_queue {
+		static_assert(Arity >= 2, "priority_queue needs at least 2 children per node");
 	protected:
 		vector<T, allocator<T>> base_vector;
 		Compare cmp;
@@ -70,6 +189,17 @@ namespace ezSTL {
 		using reference = T&;
 		using const_reference = const T&;
 
+		priority_queue() = default;
+		explicit priority_queue(const Compare& c) : cmp(c) {}
+		// build heap from a range in O(n)
+		template<typename InputIterator>
+		priority_queue(InputIterator first, InputIterator last, const Compare& c = Compare()) : cmp(c) {
+			for (; first != last; ++first)
+				base_vector.push_back(*first);
+			__heap_no_tracking track;
+			__make_heap<Arity>(base_vector.begin(), size(), cmp, track);
+		}
+
 		bool empty() const {
 			return base_vector.empty();
 		}
@@ -79,44 +209,208 @@ namespace ezSTL {
 		reference top() const {
 			return base_vector.front();
 		}
+		void reserve(size_type n) {
+			base_vector.reserve(n);
+		}
 		void push(const_reference x) {
-			base_vector.push_back(x);
-			// percolateUp
-			for (size_type i = size() - 1; i > 0;) {
-				// swap new inserted value and its parent
-				if (cmp(base_vector[i], base_vector[(i - 1) / 2])) {
-					ezSTL::swap(base_vector[i], base_vector[(i - 1) / 2]);
-					i = (i - 1) / 2;
-				}
-				else break;
-			}
+			emplace(x);
+		}
+		void push(value_type&& x) {
+			emplace(ezSTL::move(x));
+		}
+		template<typename... Args>
+		void emplace(Args&&... args) {
+			// percolate up, the new value is kept aside while parents move into the hole
+			base_vector.emplace_back(ezSTL::forward<Args>(args)...);
+			value_type value = ezSTL::move(base_vector.back());
+			__heap_no_tracking track;
+			__heap_sift_up<Arity>(base_vector.begin(), size() - 1, ezSTL::move(value), cmp, track);
 		}
 		void pop() {
-			size_type i = 0;
-			base_vector[0] = base_vector[size() - 1];
+			value_type value = ezSTL::move(base_vector.back());
 			base_vector.pop_back();
-			// percolateDown
-			// if it has both left child and right child
-			while (i * 2 + 2 < size()) {
-				if (cmp(base_vector[i * 2 + 1], base_vector[i]) &&
-					!cmp(base_vector[i * 2 + 2], base_vector[i * 2 + 1])) {
-					ezSTL::swap(base_vector[i], base_vector[i * 2 + 1]);
-					i = i * 2 + 1;
-				}
-				else if (cmp(base_vector[i * 2 + 2], base_vector[i]) &&
-					!cmp(base_vector[i * 2 + 1], base_vector[i * 2 + 2])) {
-					ezSTL::swap(base_vector[i], base_vector[i * 2 + 2]);
-					i = i * 2 + 2;
-				}
-				else break;
+			// percolate down
+			if (!empty()) {
+				__heap_no_tracking track;
+				__heap_pop_hole<Arity>(base_vector.begin(), size(), ezSTL::move(value), cmp, track);
 			}
-			// if it has only left child
-			if (i * 2 + 1 < size()) {
-				if (cmp(base_vector[i * 2 + 1], base_vector[i]))
-					ezSTL::swap(base_vector[i], base_vector[i * 2 + 1]);
+		}
+	};
+
+	// handle of a value in indexed_priority_queue, the generation tells a reused slot from the released one,
+	// a default constructed handle is contained in no queue
+	class __indexed_heap_handle {
+	public:
+		__indexed_heap_handle() : index(static_cast<unsigned int>(-1)), generation(0) {}
+		__indexed_heap_handle(unsigned int i, unsigned int g) : index(i), generation(g) {}
+		unsigned int index;
+		unsigned int generation;
+	};
+
+	// element of indexed_priority_queue, value with the index of the handle it belongs to
+	template<typename T>
+	class __indexed_heap_entry {
+	public:
+		__indexed_heap_entry() = default;
+		__indexed_heap_entry(const T& v, unsigned int h) : value(v), handle(h) {}
+		__indexed_heap_entry(T&& v, unsigned int h) : value(ezSTL::move(v)), handle(h) {}
+		T value;
+		unsigned int handle;
+	};
+
+	// compare entries by their values
+	template<typename T, typename Compare>
+	class __indexed_heap_compare {
+	public:
+		explicit __indexed_heap_compare(Compare& c) : cmp(c) {}
+		bool operator()(const __indexed_heap_entry<T>& x, const __indexed_heap_entry<T>& y) {
+			return cmp(x.value, y.value);
+		}
+	private:
+		Compare& cmp;
+	};
+
+	// record the index of each moved entry in the position table
+	class __indexed_heap_tracking {
+	public:
+		explicit __indexed_heap_tracking(vector<unsigned int>& p) : position(p) {}
+		template<typename Entry>
+		void operator()(const Entry& e, unsigned int index) const {
+			position[e.handle] = index;
+		}
+	private:
+		vector<unsigned int>& position;
+	};
+
+	template<typename T, typename Compare = less<T>, unsigned int Arity = 2>
+	class indexed_priority_queue {
+		static_assert(Arity >= 2, "indexed_priority_queue needs at least 2 children per node");
+	public:
+		using value_type = T;
+		using size_type = unsigned int;
+		using handle_type = __indexed_heap_handle;
+		using reference = T&;
+		using const_reference = const T&;
+		// position of an erased or popped handle
+		static const size_type npos = static_cast<size_type>(-1);
+
+	protected:
+		using entry = __indexed_heap_entry<T>;
+		vector<entry, allocator<entry>> heap;
+		// position[i] is the index in heap of the value of handle slot i, or npos
+		vector<size_type> position;
+		// generation[i] is the generation of the live handle of slot i, bumped when it is released
+		vector<unsigned int> generation;
+		// handle slots which can be reused
+		vector<unsigned int> free_handles;
+		Compare cmp;
+
+		unsigned int new_handle() {
+			if (free_handles.empty()) {
+				position.push_back(npos);
+				generation.push_back(0);
+				return position.size() - 1;
+			}
+			unsigned int i = free_handles.back();
+			free_handles.pop_back();
+			return i;
+		}
+		void release_handle(unsigned int i) {
+			position[i] = npos;
+			++generation[i];
+			free_handles.push_back(i);
+		}
+		// put value at index hole, going up or down as needed
+		void place(size_type hole, entry&& value) {
+			__indexed_heap_compare<T, Compare> entry_cmp(cmp);
+			__indexed_heap_tracking track(position);
+			if (hole > 0 && entry_cmp(value, heap[(hole - 1) / Arity]))
+				__heap_sift_up<Arity>(heap.begin(), hole, ezSTL::move(value), entry_cmp, track);
+			else
+				__heap_sift_down<Arity>(heap.begin(), hole, size(), ezSTL::move(value), entry_cmp, track);
+		}
+		// remove the entry at index
+		void remove_at(size_type index) {
+			release_handle(heap[index].handle);
+			entry last = ezSTL::move(heap.back());
+			heap.pop_back();
+			if (index < size())
+				place(index, ezSTL::move(last));
+		}
+
+	public:
+		indexed_priority_queue() = default;
+		explicit indexed_priority_queue(const Compare& c) : cmp(c) {}
+
+		bool empty() const {
+			return heap.empty();
+		}
+		size_type size() const {
+			return heap.size();
+		}
+		const_reference top() const {
+			return heap.front().value;
+		}
+		handle_type top_handle() const {
+			unsigned int i = heap.front().handle;
+			return handle_type(i, generation[i]);
+		}
+		bool contains(handle_type h) const {
+			return h.index < position.size() && generation[h.index] == h.generation && position[h.index] != npos;
+		}
+		const_reference get(handle_type h) const {
+			return heap[position[h.index]].value;
+		}
+		void reserve(size_type n) {
+			heap.reserve(n);
+			position.reserve(n);
+			generation.reserve(n);
+		}
+		handle_type push(const_reference x) {
+			return push(value_type(x));
+		}
+		handle_type push(value_type&& x) {
+			unsigned int i = new_handle();
+			heap.emplace_back(ezSTL::move(x), i);
+			entry value = ezSTL::move(heap.back());
+			__indexed_heap_compare<T, Compare> entry_cmp(cmp);
+			__indexed_heap_tracking track(position);
+			__heap_sift_up<Arity>(heap.begin(), size() - 1, ezSTL::move(value), entry_cmp, track);
+			return handle_type(i, generation[i]);
+		}
+		void pop() {
+			release_handle(heap.front().handle);
+			entry value = ezSTL::move(heap.back());
+			heap.pop_back();
+			if (!empty()) {
+				__indexed_heap_compare<T, Compare> entry_cmp(cmp);
+				__indexed_heap_tracking track(position);
+				__heap_pop_hole<Arity>(heap.begin(), size(), ezSTL::move(value), entry_cmp, track);
 			}
 		}
+		// change the value of handle h, moving it up (decrease-key) or down in O(log n)
+		bool update(handle_type h, const_reference x) {
+			if (!contains(h))
+				return false;
+			place(position[h.index], entry(x, h.index));
+			return true;
+		}
+		bool erase(handle_type h) {
+			if (!contains(h))
+				return false;
+			remove_at(position[h.index]);
+			return true;
+		}
+		// the handles given out so far stay released, so none of them is contained after clear
+		void clear() {
+			for (size_type i = 0; i < heap.size(); ++i)
+				release_handle(heap[i].handle);
+			heap.clear();
+		}
 	};
+
+	template<typename T, typename Compare, unsigned int Arity>
+	const typename indexed_priority_queue<T, Compare, Arity>::size_type indexed_priority_queue<T, Compare, Arity>::npos;
 }
 
 #endif // !EZSTL_QUEUE_H
@@ -0,0 +1,125 @@
+/*********************************************************************************************/
+// class radix_heap:
+// a min heap for unsigned integral keys which are popped in non-decreasing order,
+// as in timer and event processing. a pushed key must not be less than the key of the last top()
+// keys are put into buckets by the highest bit differing from the last popped key,
+// push is O(1) and pop is O(log(max key)) amortized, without comparing elements one by one
+// including some basic functions of priority_queue:
+//
+// 1. bool empty() const;
+// 2. size_type size() const;
+// 3. const_reference top() const;
+// 4. void push(const Key& key, const Value& value);
+//    void push(const_reference x);
+// 5. void pop();
+// 6. void clear();
+
+#ifndef EZSTL_RADIX_HEAP_H
+#define EZSTL_RADIX_HEAP_H
+
+#include "utility.h"
+#include "vector.h"
+
+namespace ezSTL {
+
+	template<typename Key, typename Value>
+	class radix_heap {
+		// buckets follow the bits of the keys, a negative key would go after every positive one
+		static_assert(static_cast<Key>(-1) > static_cast<Key>(0), "radix_heap needs an unsigned integral Key");
+	public:
+		using key_type = Key;
+		using value_type = pair<Key, Value>;
+		using size_type = unsigned int;
+		using reference = value_type&;
+		using const_reference = const value_type&;
+
+	protected:
+		enum { bucket_number = sizeof(Key) * 8 + 1 };
+		// buckets[0] holds keys equal to last, buckets[i] holds keys whose highest bit
+		// differing from last is bit i - 1. buckets are refilled lazily by top() and pop()
+		mutable vector<value_type> buckets[bucket_number];
+		// key of the last top(), no key less than it may be pushed
+		mutable Key last;
+		size_type __size;
+
+		static unsigned int bucket_index(const Key& key, const Key& last) {
+			return __bit_width(static_cast<Key>(key ^ last));
+		}
+		// refill buckets[0] from the first non-empty bucket
+		void pull() const;
+
+	public:
+		radix_heap() : last(0), __size(0) {}
+		radix_heap(const radix_heap&) = default;
+		radix_heap(radix_heap&& h) noexcept : last(h.last), __size(h.__size) {
+			for (unsigned int i = 0; i < bucket_number; ++i)
+				buckets[i] = ezSTL::move(h.buckets[i]);
+			h.last = 0;
+			h.__size = 0;
+		}
+		radix_heap& operator=(const radix_heap&) = default;
+		// h is left empty, as after clear()
+		radix_heap& operator=(radix_heap&& h) noexcept {
+			if (this != &h) {
+				for (unsigned int i = 0; i < bucket_number; ++i)
+					buckets[i] = ezSTL::move(h.buckets[i]);
+				last = h.last;
+				__size = h.__size;
+				h.last = 0;
+				h.__size = 0;
+			}
+			return *this;
+		}
+
+		bool empty() const {
+			return __size == 0;
+		}
+		size_type size() const {
+			return __size;
+		}
+		// the element with minimum key
+		const_reference top() const {
+			if (buckets[0].empty())
+				pull();
+			return buckets[0].back();
+		}
+		void push(const Key& key, const Value& value) {
+			push(value_type(key, value));
+		}
+		void push(const_reference x) {
+			buckets[bucket_index(x.first, last)].push_back(x);
+			++__size;
+		}
+		void pop() {
+			if (buckets[0].empty())
+				pull();
+			buckets[0].pop_back();
+			--__size;
+		}
+		void clear() {
+			for (unsigned int i = 0; i < bucket_number; ++i)
+				buckets[i].clear();
+			last = 0;
+			__size = 0;
+		}
+	};
+
+	template<typename Key, typename Value>
+	void radix_heap<Key, Value>::pull() const {
+		unsigned int i = 1;
+		while (buckets[i].empty())
+			++i;
+		// the minimum key of the bucket becomes last, and all its elements move to lower buckets
+		vector<value_type>& bucket = buckets[i];
+		Key new_last = bucket[0].first;
+		for (size_type j = 1; j < bucket.size(); ++j)
+			if (bucket[j].first < new_last)
+				new_last = bucket[j].first;
+		last = new_last;
+		for (size_type j = 0; j < bucket.size(); ++j)
+			buckets[bucket_index(bucket[j].first, last)].push_back(ezSTL::move(bucket[j]));
+		bucket.clear();
+	}
+}
+
+#endif // !EZSTL_RADIX_HEAP_H
@@ -6,12 +6,51 @@
 // 2. iterator end() const;
 // 3. size_type size() const;
 // 4. bool empty() const;
-// 5. iterator find(const T& v) const;
-// 6. void insert(const T& v);
-// 7. void erase(iterator pos);
-// 8. void clear();
+// 5. iterator find(const K& k) const;
+// 6. iterator lower_bound(const K& k) const;
+// 7. iterator upper_bound(const K& k) const;
+// 8. pair<iterator, iterator> equal_range(const K& k) const;
+// 9. pair<iterator, bool> insert(const T& v);
+// 10. iterator insert(iterator hint, const T& v);
+// 11. pair<iterator, bool> emplace(Args&&... args);
+// 12. iterator emplace_hint(iterator hint, Args&&... args);
+// 13. void insert(Iterator first, Iterator last);
+// 14. void erase(iterator pos);
+// 15. iterator erase(iterator first, iterator last);
+// 16. void for_each_in_range(const K& lo, const K& hi, Function f) const;
+// 17. void clear();
+// 18. Compare key_comp() const;
+// 19. value_compare value_comp() const;
+// 20. void union_with(rbtree& other, bool replace = false, const Fork& fork = Fork());
+// 21. void intersect_with(rbtree& other, const Fork& fork = Fork());
+// 22. void subtract(rbtree& other, const Fork& fork = Fork());
+// 23. iterator nth(size_type k) const;
+// 24. size_type rank(const K& k) const;
+// 25. size_type count_range(const K& lo, const K& hi) const;
+// 26. node_type extract(iterator pos);
+// 27. node_type extract(const K& k);
+// 28. pair<iterator, bool> insert(node_type&& nh);
+// 29. void clone_from(const rbtree& other, const Fork& fork = Fork());
+// 30. void swap(rbtree& other);
+// 31. void deferred_clear(Reclaimer& reclaimer);
 // only for debug:
-// 9. bool isRBTree();
+// 32. bool isRBTree();
+//
+// values are unique, inserting a value equal to an existing one changes nothing and returns the existing one
+// insert(first, last) into an empty tree builds it in O(n), a range that is not sorted is copied
+// and sorted with ezSTL::stable_sort first; of equal values the first is kept
+// union_with, intersect_with and subtract relink the nodes of both trees and leave other empty,
+// O(m lg(n / m + 1)) for trees of m <= n values; fork runs the two halves of every step
+// KeyOfValue gives the key of a value, identity<T> for set and select1st for map, Compare orders the keys
+// Compare is a less functor or a three-way comparator, see __compare_traits in functional.h
+// a copy is cloned in O(n) in the same shape; moving and swap are O(1), a moved from tree gets a new header
+// deferred_clear empties the tree in O(1) and hands the detached nodes to reclaimer
+//
+// Augment chooses the data kept in every node:
+// rbtree_no_augment: nothing
+// rbtree_order_statistics: the size of every subtree, for nth, rank and count_range in O(lgn)
+// __interval_max_end (interval_map.h): the largest interval end in every subtree, for the overlap queries
+// rbtree_threaded: the previous and next nodes in order, ++ and -- follow one link
 
 #ifndef EZSTL_RBTREE_H
 #define EZSTL_RBTREE_H
@@ -19,7 +58,11 @@
 #include "functional.h"
 #include "iterator.h"
 #include "memory.h"
+#include "node_handle.h"
 #include "utility.h"
+#include "vector.h"
+#include "algorithm.h"
+#include <cstdint>
 
 namespace ezSTL {
 
@@ -28,45 +71,663 @@ namespace ezSTL {
 	const __rbtree_color_type __rbtree_red = false;
 	const __rbtree_color_type __rbtree_black = true;
 
-	// node of RB Tree
-	template<typename T>
-	class __rbtree_node {
+	// links of a node of RB Tree, shared by rbtree nodes and intrusive_rbtree hooks
+	// the tree algorithms below only touch these links
+	// the color is kept in the lowest bit of the parent pointer, always 0 in the address of a node,
+	// so a node carries three words of links and no padded flag: 32 bytes instead of 40 for an unsigned
+	class __rbtree_node_base {
 	public:
-		__rbtree_node(const T& t) : color(__rbtree_red), parent(nullptr), left(nullptr), right(nullptr), data(t) {}
-		// some type definition
 		using color_type = __rbtree_color_type;
-		using value_type = T;
-		using pointer = __rbtree_node<value_type>*;
+		using base_ptr = __rbtree_node_base*;
+
+		__rbtree_node_base() : parent_color(0), left(nullptr), right(nullptr) {}
 
 		// data members
-		color_type color;
-		pointer parent;
-		pointer left;
-		pointer right;
-		value_type data;
+		uintptr_t parent_color;
+		base_ptr left;
+		base_ptr right;
+
+		base_ptr parent() const {
+			return reinterpret_cast<base_ptr>(parent_color & ~uintptr_t(1));
+		}
+		color_type color() const {
+			return (parent_color & 1) != 0;
+		}
+		void set_parent(base_ptr p) {
+			parent_color = reinterpret_cast<uintptr_t>(p) | (parent_color & 1);
+		}
+		void set_color(color_type c) {
+			parent_color = (parent_color & ~uintptr_t(1)) | (c ? 1 : 0);
+		}
+		// assign both without reading parent_color, for a node whose links are not initialized yet
+		void set_parent_and_color(base_ptr p, color_type c) {
+			parent_color = reinterpret_cast<uintptr_t>(p) | (c ? 1 : 0);
+		}
 
 		// find the minimum value
-		static pointer minimum(pointer x) {
+		static base_ptr minimum(base_ptr x) {
 			while (x->left != nullptr)
 				x = x->left;
 			return x;
 		}
 
 		// find the maximum value
-		static pointer maximum(pointer x) {
+		static base_ptr maximum(base_ptr x) {
 			while (x->right != nullptr)
 				x = x->right;
 			return x;
 		}
 	};
 
+	// augmentation policies of rbtree: Augment::node_base is the base class of the nodes, Augment::update(x)
+	// recomputes the data kept in x from its children and Augment::check(x) tells if it is up to date;
+	// the tree algorithms call update bottom up on every node whose subtree changes, i.e. on the path
+	// of an inserted or removed node and on both nodes of a rotation, and only if enabled is true;
+	// if threaded is true the nodes derive from __rbtree_threaded_node_base and the links to the
+	// previous and next nodes in order are kept by every insert and erase
+
+	// no augmentation, nodes hold nothing more and nothing is updated
+	class rbtree_no_augment {
+	public:
+		using node_base = __rbtree_node_base;
+		static const bool enabled = false;
+		static const bool threaded = false;
+		static void update(__rbtree_node_base*) {}
+		static bool check(const __rbtree_node_base*) {
+			return true;
+		}
+	};
+
+	// links of a node counting the nodes of its subtree, itself included
+	class __rbtree_counted_node_base : public __rbtree_node_base {
+	public:
+		__rbtree_counted_node_base() : count(1) {}
+		unsigned int count;
+	};
+
+	// order statistics: subtree sizes give the k-th value and the rank of a value in O(lgn)
+	class rbtree_order_statistics {
+	public:
+		using node_base = __rbtree_counted_node_base;
+		static const bool enabled = true;
+		static const bool threaded = false;
+		static unsigned int count(const __rbtree_node_base* x) {
+			return x ? static_cast<const __rbtree_counted_node_base*>(x)->count : 0;
+		}
+		static void update(__rbtree_node_base* x) {
+			static_cast<__rbtree_counted_node_base*>(x)->count = count(x->left) + count(x->right) + 1;
+		}
+		static bool check(const __rbtree_node_base* x) {
+			return count(x) == count(x->left) + count(x->right) + 1;
+		}
+	};
+
+	// links of a node with its neighbours in order, the header is the next of the rightmost node
+	// and the previous of the leftmost node, so the nodes and the header form a ring
+	class __rbtree_threaded_node_base : public __rbtree_node_base {
+	public:
+		__rbtree_threaded_node_base() : next(nullptr), prev(nullptr) {}
+		base_ptr next;
+		base_ptr prev;
+	};
+
+	// threaded iteration: ++ and -- follow one link instead of climbing the parent links,
+	// two more words per node, set operations and copies thread the result in O(n) more
+	class rbtree_threaded {
+	public:
+		using node_base = __rbtree_threaded_node_base;
+		static const bool enabled = false;
+		static const bool threaded = true;
+		static void update(__rbtree_node_base*) {}
+		static bool check(const __rbtree_node_base* x);
+	};
+
+	// node of RB Tree, NodeBase holds the links and the data of the augmentation
+	template<typename T, typename NodeBase = __rbtree_node_base>
+	class __rbtree_node : public NodeBase {
+	public:
+		template<typename... Args>
+		explicit __rbtree_node(Args&&... args) : data(ezSTL::forward<Args>(args)...) {}
+		// some type definition
+		using value_type = T;
+		using pointer = __rbtree_node<value_type, NodeBase>*;
+
+		value_type data;
+	};
+
+	// the header of a tree is a red node whose parent is the root, left is the leftmost node
+	// and right is the rightmost node; the parent of the root is the header
+
+	// next node in order, the next of the rightmost node is the header
+	inline __rbtree_node_base* __rbtree_increment(__rbtree_node_base* node) {
+		// if it has right node
+		if (node->right != nullptr) {
+			node = node->right;
+			while (node->left != nullptr)
+				node = node->left;
+		}
+		else {
+			__rbtree_node_base* parent_node = node->parent();
+			while (node == parent_node->right) {
+				node = parent_node;
+				parent_node = parent_node->parent();
+			}
+			if (node->right != parent_node)
+				node = parent_node;
+		}
+		return node;
+	}
+
+	// previous node in order, the previous of the header is the rightmost node
+	inline __rbtree_node_base* __rbtree_decrement(__rbtree_node_base* node) {
+		// present node is header
+		if (node->color() == __rbtree_red && node->parent()->parent() == node)
+			node = node->right;
+		// if node has left child
+		else if (node->left != nullptr) {
+			node = node->left;
+			while (node->right != nullptr)
+				node = node->right;
+		}
+		else {
+			__rbtree_node_base* parent_node = node->parent();
+			while (node == parent_node->left) {
+				node = parent_node;
+				parent_node = parent_node->parent();
+			}
+			node = parent_node;
+		}
+		return node;
+	}
+
+	// next and previous node in order, one link for the threaded nodes
+	inline __rbtree_node_base* __rbtree_next(__rbtree_node_base* node) {
+		return __rbtree_increment(node);
+	}
+	inline __rbtree_node_base* __rbtree_next(__rbtree_threaded_node_base* node) {
+		return node->next;
+	}
+	inline __rbtree_node_base* __rbtree_prev(__rbtree_node_base* node) {
+		return __rbtree_decrement(node);
+	}
+	inline __rbtree_node_base* __rbtree_prev(__rbtree_threaded_node_base* node) {
+		return node->prev;
+	}
+
+	// link the threaded nodes x and y as neighbours in order, x before y
+	inline void __rbtree_thread(__rbtree_node_base* x, __rbtree_node_base* y) {
+		static_cast<__rbtree_threaded_node_base*>(x)->next = y;
+		static_cast<__rbtree_threaded_node_base*>(y)->prev = x;
+	}
+
+	// the links of x agree with the order, and so does the previous link of the next node
+	inline bool rbtree_threaded::check(const __rbtree_node_base* x) {
+		const __rbtree_threaded_node_base* node = static_cast<const __rbtree_threaded_node_base*>(x);
+		return node->next == __rbtree_increment(const_cast<__rbtree_node_base*>(x)) &&
+			static_cast<const __rbtree_threaded_node_base*>(node->next)->prev == x &&
+			static_cast<const __rbtree_threaded_node_base*>(node->prev)->next == x;
+	}
+
+	// update x and its ancestors up to end, end excluded, bottom up
+	template<typename Augment>
+	inline void __rbtree_update_path(__rbtree_node_base* x, __rbtree_node_base* end) {
+		if (Augment::enabled)
+			for (; x != end; x = x->parent())
+				Augment::update(x);
+	}
+
+	template<typename Augment = rbtree_no_augment>
+	inline void __rbtree_rotate_left(__rbtree_node_base* z, __rbtree_node_base*& root) {
+		__rbtree_node_base* y = z->right;
+		z->right = y->left;
+		if (y->left)
+			y->left->set_parent(z);
+		y->set_parent(z->parent());
+		// change root
+		if (z == root)
+			root = y;
+		else if (z == z->parent()->left)
+			z->parent()->left = y;
+		else
+			z->parent()->right = y;
+		y->left = z;
+		z->set_parent(y);
+		if (Augment::enabled) {
+			Augment::update(z);
+			Augment::update(y);
+		}
+	}
+
+	template<typename Augment = rbtree_no_augment>
+	inline void __rbtree_rotate_right(__rbtree_node_base* z, __rbtree_node_base*& root) {
+		__rbtree_node_base* y = z->left;
+		z->left = y->right;
+		if (y->right)
+			y->right->set_parent(z);
+		y->set_parent(z->parent());
+		// change root
+		if (z == root)
+			root = y;
+		else if (z == z->parent()->right)
+			z->parent()->right = y;
+		else
+			z->parent()->left = y;
+		y->right = z;
+		z->set_parent(y);
+		if (Augment::enabled) {
+			Augment::update(z);
+			Augment::update(y);
+		}
+	}
+
+	// now is red with black children and may have a red parent, recolor and rotate up to root
+	template<typename Augment = rbtree_no_augment>
+	inline void __rbtree_insert_fixup(__rbtree_node_base* now, __rbtree_node_base*& root) {
+		while (now != root && now->parent()->color() == __rbtree_red) {
+			__rbtree_node_base* grandparent = now->parent()->parent();
+			if (now->parent() == grandparent->left) {
+				__rbtree_node_base* uncle = grandparent->right;
+				// if parent and uncle are both red, case 1
+				if (uncle && uncle->color() == __rbtree_red) {
+					now->parent()->set_color(__rbtree_black);
+					uncle->set_color(__rbtree_black);
+					grandparent->set_color(__rbtree_red);
+					now = grandparent;
+				}
+				// if no uncle or uncle is black
+				else {
+					// if now is a right child, case 2
+					if (now == now->parent()->right) {
+						now = now->parent();
+						__rbtree_rotate_left<Augment>(now, root);
+					}
+					// if now is a left child, case 3
+					now->parent()->set_color(__rbtree_black);
+					grandparent->set_color(__rbtree_red);
+					__rbtree_rotate_right<Augment>(grandparent, root);
+				}
+			}
+			else {
+				__rbtree_node_base* uncle = grandparent->left;
+				// if parent and uncle are both red
+				if (uncle && uncle->color() == __rbtree_red) {
+					now->parent()->set_color(__rbtree_black);
+					uncle->set_color(__rbtree_black);
+					grandparent->set_color(__rbtree_red);
+					now = grandparent;
+				}
+				// if no uncle or uncle is black
+				else {
+					// if now is a left child
+					if (now == now->parent()->left) {
+						now = now->parent();
+						__rbtree_rotate_right<Augment>(now, root);
+					}
+					now->parent()->set_color(__rbtree_black);
+					grandparent->set_color(__rbtree_red);
+					__rbtree_rotate_left<Augment>(grandparent, root);
+				}
+			}
+		}
+		// root is always black
+		root->set_color(__rbtree_black);
+	}
+
+	// link now as the left or right child of parent, keep leftmost and rightmost of header, then fix up
+	// parent is the header only when the tree is empty, and then insert_left must be true
+	template<typename Augment = rbtree_no_augment>
+	inline void __rbtree_insert_and_rebalance(bool insert_left, __rbtree_node_base* now,
+		__rbtree_node_base* parent, __rbtree_node_base& header) {
+		now->set_parent_and_color(parent, __rbtree_red);
+		now->left = nullptr;
+		now->right = nullptr;
+		if (insert_left) {
+			parent->left = now;
+			// if it is an empty tree
+			if (parent == &header) {
+				header.set_parent(now);
+				header.right = now;
+			}
+			else if (parent == header.left)
+				header.left = now;
+		}
+		else {
+			parent->right = now;
+			if (parent == header.right)
+				header.right = now;
+		}
+		if (Augment::threaded) {
+			// a left child goes right before its parent, a right child right after it
+			__rbtree_node_base* prev = insert_left ? static_cast<__rbtree_threaded_node_base*>(parent)->prev : parent;
+			__rbtree_node_base* next = static_cast<__rbtree_threaded_node_base*>(prev)->next;
+			__rbtree_thread(prev, now);
+			__rbtree_thread(now, next);
+		}
+		__rbtree_update_path<Augment>(now, &header);
+		// the root is packed with the color of the header, the fix up works on a copy
+		__rbtree_node_base* root = header.parent();
+		__rbtree_insert_fixup<Augment>(now, root);
+		header.set_parent(root);
+	}
+
+	// unlink z from the tree and fix up, z is replaced by relinking its successor,
+	// so no node other than z changes its position in the order and iterators stay valid
+	template<typename Augment = rbtree_no_augment>
+	inline void __rbtree_rebalance_for_erase(__rbtree_node_base* z, __rbtree_node_base& header) {
+		// the root is packed with the color of the header, the fix up works on a copy
+		__rbtree_node_base* root = header.parent();
+		if (Augment::threaded)
+			__rbtree_thread(static_cast<__rbtree_threaded_node_base*>(z)->prev, static_cast<__rbtree_threaded_node_base*>(z)->next);
+		// todelete: node leaving its position, son: child taking its place, father: parent of son
+		__rbtree_node_base* todelete = z;
+		__rbtree_node_base* son = nullptr;
+		__rbtree_node_base* father = nullptr;
+		if (todelete->left == nullptr)
+			son = todelete->right;
+		else if (todelete->right == nullptr)
+			son = todelete->left;
+		else {
+			todelete = todelete->right;
+			while (todelete->left != nullptr)
+				todelete = todelete->left;
+			son = todelete->right;
+		}
+		if (todelete != z) {
+			// relink the successor todelete in place of z
+			z->left->set_parent(todelete);
+			todelete->left = z->left;
+			if (todelete != z->right) {
+				father = todelete->parent();
+				if (son)
+					son->set_parent(father);
+				father->left = son;
+				todelete->right = z->right;
+				z->right->set_parent(todelete);
+			}
+			else
+				father = todelete;
+			if (root == z)
+				root = todelete;
+			else if (z->parent()->left == z)
+				z->parent()->left = todelete;
+			else
+				z->parent()->right = todelete;
+			todelete->set_parent(z->parent());
+			// the color is a property of the position
+			__rbtree_color_type color = todelete->color();
+			todelete->set_color(z->color());
+			z->set_color(color);
+		}
+		else {
+			father = z->parent();
+			if (son)
+				son->set_parent(father);
+			if (root == z)
+				root = son;
+			else if (father->left == z)
+				father->left = son;
+			else
+				father->right = son;
+			// adjust leftmost and rightmost, they always have at most one child
+			if (header.left == z)
+				header.left = z->right == nullptr ? father : __rbtree_node_base::minimum(son);
+			if (header.right == z)
+				header.right = z->left == nullptr ? father : __rbtree_node_base::maximum(son);
+		}
+		header.set_parent(root);
+		// every subtree that lost a node is on the path from father up, the successor included
+		__rbtree_update_path<Augment>(father, &header);
+		// if the removed position is black, then fix up
+		if (z->color() == __rbtree_red)
+			return;
+		while (son != root && (!son || son->color() == __rbtree_black)) {
+			__rbtree_node_base* brother = nullptr;
+			if (son == father->left) {
+				brother = father->right;
+				// case 1: color of brother is red
+				if (brother->color() == __rbtree_red) {
+					brother->set_color(__rbtree_black);
+					father->set_color(__rbtree_red);
+					__rbtree_rotate_left<Augment>(father, root);
+					brother = father->right;
+				}
+				// case 2: color of brother's sons are both black
+				if ((!brother->left || brother->left->color() == __rbtree_black) &&
+					(!brother->right || brother->right->color() == __rbtree_black)) {
+					brother->set_color(__rbtree_red);
+					son = father;
+					father = father->parent();
+				}
+				else {
+					// case 3: color of brother's right son is black
+					if (!brother->right || brother->right->color() == __rbtree_black) {
+						brother->set_color(__rbtree_red);
+						if (brother->left)
+							brother->left->set_color(__rbtree_black);
+						__rbtree_rotate_right<Augment>(brother, root);
+						brother = father->right;
+					}
+					// case 4: color of brother's left son is black
+					brother->set_color(father->color());
+					father->set_color(__rbtree_black);
+					if (brother->right)
+						brother->right->set_color(__rbtree_black);
+					__rbtree_rotate_left<Augment>(father, root);
+					break;
+				}
+			}
+			// similar as above, only change left to right, change right to left
+			else {
+				brother = father->left;
+				if (brother->color() == __rbtree_red) {
+					brother->set_color(__rbtree_black);
+					father->set_color(__rbtree_red);
+					__rbtree_rotate_right<Augment>(father, root);
+					brother = father->left;
+				}
+				if ((!brother->right || brother->right->color() == __rbtree_black) &&
+					(!brother->left || brother->left->color() == __rbtree_black)) {
+					brother->set_color(__rbtree_red);
+					son = father;
+					father = father->parent();
+				}
+				else {
+					if (!brother->left || brother->left->color() == __rbtree_black) {
+						brother->set_color(__rbtree_red);
+						if (brother->right)
+							brother->right->set_color(__rbtree_black);
+						__rbtree_rotate_left<Augment>(brother, root);
+						brother = father->left;
+					}
+					brother->set_color(father->color());
+					father->set_color(__rbtree_black);
+					if (brother->left)
+						brother->left->set_color(__rbtree_black);
+					__rbtree_rotate_right<Augment>(father, root);
+					break;
+				}
+			}
+		}
+		if (son)
+			son->set_color(__rbtree_black);
+		header.set_parent(root);
+	}
+
+	// link the first n nodes of chain, a list of nodes in order through their right links, into a perfectly
+	// balanced tree and return its root, chain moves past the used nodes; O(n)
+	// the sizes of the two subtrees of any node differ by at most one, so every NIL node is at depth
+	// red_depth or red_depth + 1, and coloring the nodes at red_depth red and the others black is valid
+	template<typename Augment = rbtree_no_augment>
+	inline __rbtree_node_base* __rbtree_link_balanced(__rbtree_node_base*& chain, unsigned int n,
+		unsigned int depth, unsigned int red_depth) {
+		if (n == 0)
+			return nullptr;
+		__rbtree_node_base* left = __rbtree_link_balanced<Augment>(chain, n / 2, depth + 1, red_depth);
+		__rbtree_node_base* x = chain;
+		chain = chain->right;
+		__rbtree_node_base* right = __rbtree_link_balanced<Augment>(chain, n - n / 2 - 1, depth + 1, red_depth);
+		x->left = left;
+		x->right = right;
+		if (left)
+			left->set_parent(x);
+		if (right)
+			right->set_parent(x);
+		x->set_color(depth == red_depth ? __rbtree_red : __rbtree_black);
+		if (Augment::enabled)
+			Augment::update(x);
+		return x;
+	}
+
+	// the join based operations below work on subtrees detached from any header: the parent link of a root
+	// is ignored and left unset, a root may be red, and nullptr is the empty tree
+
+	// number of black nodes on the path from x down its left links, NIL excluded; O(lgn)
+	inline unsigned int __rbtree_spine_black_height(const __rbtree_node_base* x) {
+		unsigned int height = 0;
+		for (; x != nullptr; x = x->left)
+			if (x->color() == __rbtree_black)
+				++height;
+		return height;
+	}
+
+	// join l, the unlinked node k and r, every value of l goes before k and every value of r after it;
+	// k replaces the first black node of the same black height as the lower tree on the inner spine
+	// of the higher tree, which keeps the black heights, and the insertion fix up repairs a red parent;
+	// returns the root of the joined tree, O(|bh(l) - bh(r)| + 1)
+	template<typename Augment = rbtree_no_augment>
+	inline __rbtree_node_base* __rbtree_join(__rbtree_node_base* l, __rbtree_node_base* k, __rbtree_node_base* r) {
+		// with black roots the children of k are black
+		if (l) {
+			l->set_color(__rbtree_black);
+			l->set_parent(nullptr);
+		}
+		if (r) {
+			r->set_color(__rbtree_black);
+			r->set_parent(nullptr);
+		}
+		unsigned int left_height = __rbtree_spine_black_height(l);
+		unsigned int right_height = __rbtree_spine_black_height(r);
+		__rbtree_node_base* root = nullptr;
+		__rbtree_node_base* parent = nullptr;
+		k->set_color(__rbtree_red);
+		if (left_height >= right_height) {
+			// walk down the right spine of l
+			root = l;
+			__rbtree_node_base* x = l;
+			unsigned int height = left_height;
+			while (x != nullptr && !(x->color() == __rbtree_black && height == right_height)) {
+				if (x->color() == __rbtree_black)
+					--height;
+				parent = x;
+				x = x->right;
+			}
+			k->left = x;
+			k->right = r;
+			if (parent)
+				parent->right = k;
+		}
+		else {
+			// walk down the left spine of r
+			root = r;
+			__rbtree_node_base* x = r;
+			unsigned int height = right_height;
+			while (x != nullptr && !(x->color() == __rbtree_black && height == left_height)) {
+				if (x->color() == __rbtree_black)
+					--height;
+				parent = x;
+				x = x->left;
+			}
+			k->left = l;
+			k->right = x;
+			if (parent)
+				parent->left = k;
+		}
+		k->set_parent(parent);
+		if (k->left)
+			k->left->set_parent(k);
+		if (k->right)
+			k->right->set_parent(k);
+		if (parent == nullptr)
+			root = k;
+		__rbtree_update_path<Augment>(k, nullptr);
+		__rbtree_insert_fixup<Augment>(k, root);
+		return root;
+	}
+
+	// unlink the last node of the tree x and return it, rest is the tree of the other nodes; O(lgn)
+	template<typename Augment = rbtree_no_augment>
+	inline __rbtree_node_base* __rbtree_split_last(__rbtree_node_base* x, __rbtree_node_base*& rest) {
+		if (x->right == nullptr) {
+			rest = x->left;
+			return x;
+		}
+		__rbtree_node_base* left = x->left;
+		__rbtree_node_base* last = __rbtree_split_last<Augment>(x->right, rest);
+		rest = __rbtree_join<Augment>(left, x, rest);
+		return last;
+	}
+
+	// join l and r without a node between them, every value of l goes before every value of r; O(lgn)
+	template<typename Augment = rbtree_no_augment>
+	inline __rbtree_node_base* __rbtree_join2(__rbtree_node_base* l, __rbtree_node_base* r) {
+		if (l == nullptr)
+			return r;
+		__rbtree_node_base* rest = nullptr;
+		__rbtree_node_base* last = __rbtree_split_last<Augment>(l, rest);
+		return __rbtree_join<Augment>(rest, last, r);
+	}
+
+	// runs the two independent halves of a join based set operation one after the other,
+	// parallel_fork in thread_pool.h runs them on a thread_pool
+	class serial_fork {
+	public:
+		template<typename F1, typename F2>
+		void operator()(unsigned int, const F1& f1, const F2& f2) const {
+			f1();
+			f2();
+		}
+	};
+
+	// number of black nodes on every path from x down to a NIL node, NIL included,
+	// 0 if the subtree breaks a red-black property
+	inline unsigned int __rbtree_black_height(const __rbtree_node_base* x) {
+		if (x == nullptr)
+			return 1;
+		// a red node must not have a red child
+		if (x->color() == __rbtree_red &&
+			((x->left && x->left->color() == __rbtree_red) || (x->right && x->right->color() == __rbtree_red)))
+			return 0;
+		if ((x->left && x->left->parent() != x) || (x->right && x->right->parent() != x))
+			return 0;
+		unsigned int left_height = __rbtree_black_height(x->left);
+		unsigned int right_height = __rbtree_black_height(x->right);
+		if (left_height == 0 || left_height != right_height)
+			return 0;
+		return left_height + (x->color() == __rbtree_black ? 1 : 0);
+	}
+
+	// judge if the tree under header is a RBTree, only for debug
+	inline bool __rbtree_is_valid(const __rbtree_node_base* header) {
+		const __rbtree_node_base* root = header->parent();
+		if (root == nullptr)
+			return header->left == header && header->right == header;
+		// root is black and the leftmost and rightmost are recorded in header
+		if (root->color() != __rbtree_black || root->parent() != header)
+			return false;
+		if (header->left != __rbtree_node_base::minimum(const_cast<__rbtree_node_base*>(root)) ||
+			header->right != __rbtree_node_base::maximum(const_cast<__rbtree_node_base*>(root)))
+			return false;
+		// the number of black nodes in any path must be the same
+		return __rbtree_black_height(root) != 0;
+	}
+
 	// iterator of RB Tree
-	template<typename T>
+	template<typename T, typename NodeBase = __rbtree_node_base>
 	class __rbtree_iterator : public iterator<bidirectional_iterator_tag, T> {
 	public:
-		using iterator = __rbtree_iterator<T>;
-		using self = __rbtree_iterator<T>;
-		using link_type = __rbtree_node<T>*;
+		using iterator = __rbtree_iterator<T, NodeBase>;
+		using self = __rbtree_iterator<T, NodeBase>;
+		using link_type = __rbtree_node<T, NodeBase>*;
 		using pointer = T*;
 		using reference = T&;
 		using difference_type = int;
@@ -96,49 +757,19 @@ namespace ezSTL {
 			return &(operator*());
 		}
 		self& operator++() {
-			// if it has right node
-			if (node->right != nullptr) {
-				node = node->right;
-				while (node->left != nullptr)
-					node = node->left;
-			}
-			else {
-				link_type parent_node = node->parent;
-				while (node == parent_node->right) {
-					node = parent_node;
-					parent_node = parent_node->parent;
-				}
-				if (node->right != parent_node)
-					node = parent_node;
-			}
+			node = static_cast<link_type>(__rbtree_next(node));
 			return *this;
 		}
-		self& operator++(int) {
+		self operator++(int) {
 			self temp = *this;
 			++(*this);
 			return temp;
 		}
 		self& operator--() {
-			// present node is header
-			if (node->color == __rbtree_red && node->parent->parent == node)
-				node = node->right;
-			// if node has left child
-			else if (node->left != nullptr) {
-				node = node->left;
-				while (node->right != nullptr)
-					node = node->right;
-			}
-			else {
-				link_type parent_node = node->parent;
-				while (node == parent_node->left) {
-					node = parent_node;
-					parent_node = parent_node->parent;
-				}
-				node = parent_node;
-			}
+			node = static_cast<link_type>(__rbtree_prev(node));
 			return *this;
 		}
-		self& operator--(int) {
+		self operator--(int) {
 			self temp = *this;
 			--(*this);
 			return temp;
@@ -146,32 +777,41 @@ namespace ezSTL {
 
 		self operator+ (difference_type n) const {
 			self temp = *this;
-			advance(temp, n);
+			ezSTL::advance(temp, n);
 			return temp;
 		}
 
 		self operator-(difference_type n) const {
 			self temp = *this;
-			advance(temp, -n);
+			ezSTL::advance(temp, -n);
 			return temp;
 		}
 	};
 
 	// RB Tree class
-	template<typename T, typename Compare = less<T>, typename Alloc = allocator<__rbtree_node<T>>>
+	// Alloc is rebound to the node type, Augment is an augmentation policy,
+	// KeyOfValue gives the key of a value and Compare orders the keys
+	template<typename T, typename Compare = less<T>, typename Alloc = allocator<T>, typename Augment = rbtree_no_augment,
+		typename KeyOfValue = identity<T>>
 	class rbtree {
 	
 	public:
 		// some type definition for rbtree
-		using rbtree_node = __rbtree_node<T>;
-		using link_type = __rbtree_node<T>*;
+		using rbtree_node = __rbtree_node<T, typename Augment::node_base>;
+		using link_type = rbtree_node*;
+		using base_ptr = __rbtree_node_base*;
+		using const_base_ptr = const __rbtree_node_base*;
+		using node_allocator = typename Alloc::template rebind<rbtree_node>::other;
 		using size_type = unsigned int;
+		using key_type = typename KeyOfValue::key_type;
 		using value_type = T;
-		using iterator = __rbtree_iterator<T>;
+		using value_compare = __key_value_compare<T, Compare, KeyOfValue>;
+		using iterator = __rbtree_iterator<T, typename Augment::node_base>;
 		using const_iterator = const iterator;
 		using reference = value_type&;
 		using const_reference = const T&;
 		using difference_type = int;
+		using node_type = node_handle<T, rbtree_node, node_allocator>;
 
 	protected:
 		// data members of rbtree
@@ -182,40 +822,102 @@ namespace ezSTL {
 	public:
 		// constructor
 		rbtree() : __size(0) {
-			header.node = Alloc().allocate();
-			header.node->color = __rbtree_red;
-			header.node->parent = nullptr;
+			// the header holds no value, only its links are initialized
+			header.node = node_allocator().allocate();
+			header.node->set_parent_and_color(nullptr, __rbtree_red);
 			header.node->left = header.node;
 			header.node->right = header.node;
+			if (Augment::threaded)
+				__rbtree_thread(header.node, header.node);
+		}
+		rbtree(const rbtree& t) : rbtree() {
+			clone_from(t);
+		}
+		// the nodes are taken over in O(1) and t gets a new empty header, whose allocation may throw
+		rbtree(rbtree&& t) : rbtree() {
+			swap(t);
+		}
+		rbtree& operator=(const rbtree& t) {
+			if (this != &t)
+				clone_from(t);
+			return *this;
+		}
+		rbtree& operator=(rbtree&& t) noexcept {
+			if (this != &t) {
+				clear();
+				swap(t);
+			}
+			return *this;
 		}
-		rbtree(const rbtree<T, Compare, Alloc>& t) {}
-		rbtree(rbtree<T, Compare, Alloc>&& t) noexcept {}
-		rbtree<T, Compare, Alloc>& operator=(const rbtree<T, Compare, Alloc>& t) {}
-		rbtree<T, Compare, Alloc>& operator=(rbtree<T, Compare, Alloc>&& t) noexcept {}
 		~rbtree() {
 			clear();
+			node_allocator().deallocate(header.node);
 		}
 
 	protected:
 		// some common functions for header
 		link_type root() const {
-			return header.node->parent;
+			return static_cast<link_type>(header.node->parent());
 		}
 		link_type leftmost() const {
-			return header.node->left;
+			return static_cast<link_type>(header.node->left);
 		}
 		link_type rightmost() const {
-			return header.node->right;
-		}
-		// rotate
-		void left_rotate(link_type z);
-		void right_rotate(link_type z);
-		// fixup after inserting a new value
-		void insert_fixup(link_type z);
-		// fixup after deleting a value
-		void delete_fixup(link_type father, link_type son);
-		void dfs_clear(link_type root);
-		bool dfs_isRBTree(link_type root, unsigned int count_of_black_now, const unsigned int count_of_black);
+			return static_cast<link_type>(header.node->right);
+		}
+		static const value_type& value(base_ptr x) {
+			return static_cast<link_type>(x)->data;
+		}
+		static const key_type& key(base_ptr x) {
+			return KeyOfValue()(value(x));
+		}
+		// x < y, and negative, zero or positive for x < y, x == y and x > y, by Compare of either kind
+		template<typename A, typename B>
+		bool less_than(const A& x, const B& y) const {
+			return __compare_traits<Compare>::less(cmp, x, y);
+		}
+		template<typename A, typename B>
+		int compare(const A& x, const B& y) const {
+			return __compare_traits<Compare>::compare(cmp, x, y);
+		}
+		template<typename... Args>
+		link_type create_node(Args&&... args) {
+			link_type z = node_allocator().allocate();
+			node_allocator().construct(z, ezSTL::forward<Args>(args)...);
+			return z;
+		}
+		static void destroy_node(link_type z) {
+			node_allocator().destroy(z);
+			node_allocator().deallocate(z);
+		}
+		// position to insert a value of key k: first is nullptr and second the parent of the new node,
+		// or first is the node of key k and second is nullptr
+		pair<base_ptr, base_ptr> get_insert_unique_pos(const key_type& k) const;
+		pair<base_ptr, base_ptr> get_insert_hint_unique_pos(iterator hint, const key_type& k) const;
+		// link z under parent, as left child if x is not nullptr or z goes before parent
+		iterator insert_node(base_ptr x, base_ptr parent, link_type z);
+		// build the tree from sorted values, the tree must be empty
+		template<typename Iterator>
+		void build_from_sorted(Iterator first, Iterator last);
+		// make the detached tree x of n nodes the whole tree
+		void set_root(base_ptr x, size_type n);
+		// link every node with its neighbours in order, O(n), only with a threaded Augment
+		void thread_all();
+		// split the detached tree x into the trees l of keys before k and r of keys after k,
+		// equal is the node of key k, or nullptr
+		void split(base_ptr x, const key_type& k, base_ptr& l, base_ptr& equal, base_ptr& r) const;
+		// join based set operations on detached trees, return the root of the result and count the destroyed nodes
+		template<typename Fork>
+		base_ptr union_subtrees(base_ptr a, base_ptr b, bool keep_b, unsigned int depth, const Fork& fork, size_type& destroyed);
+		template<typename Fork>
+		base_ptr intersect_subtrees(base_ptr a, base_ptr b, bool keep_b, unsigned int depth, const Fork& fork, size_type& destroyed);
+		template<typename Fork>
+		base_ptr difference_subtrees(base_ptr a, base_ptr b, unsigned int depth, const Fork& fork, size_type& destroyed);
+		// destroy the nodes of the tree x, return the number of them, O(n) without recursion
+		static size_type destroy_subtree(base_ptr x);
+		// copy the tree x with its shape and colors, the copy of x gets parent p
+		template<typename Fork>
+		base_ptr clone_subtree(const_base_ptr x, base_ptr p, unsigned int depth, const Fork& fork);
 
 	public:
 		// some outer interfaces
@@ -232,351 +934,728 @@ namespace ezSTL {
 			return __size;
 		}
 
-		iterator find(const value_type& v) const;
-		void insert(const value_type& v);
+		// the lookups take a key, or anything Compare compares with keys
+		template<typename K>
+		iterator find(const K& k) const;
+		template<typename K>
+		iterator lower_bound(const K& k) const;
+		template<typename K>
+		iterator upper_bound(const K& k) const;
+		template<typename K>
+		pair<iterator, iterator> equal_range(const K& k) const;
+		pair<iterator, bool> insert(const value_type& v);
+		iterator insert(iterator hint, const value_type& v);
+		template<typename... Args>
+		pair<iterator, bool> emplace(Args&&... args);
+		template<typename... Args>
+		iterator emplace_hint(iterator hint, Args&&... args);
+		template<typename Iterator>
+		void insert(Iterator first, Iterator last);
 		void erase(iterator pos);
+		iterator erase(iterator first, iterator last);
+		template<typename K, typename Function>
+		void for_each_in_range(const K& lo, const K& hi, Function f) const;
 		void clear();
+		template<typename Reclaimer>
+		void deferred_clear(Reclaimer& reclaimer);
+		Compare key_comp() const {
+			return cmp;
+		}
+		value_compare value_comp() const {
+			return value_compare(cmp);
+		}
+		template<typename Fork = serial_fork>
+		void union_with(rbtree& other, bool replace = false, const Fork& fork = Fork());
+		template<typename Fork = serial_fork>
+		void intersect_with(rbtree& other, const Fork& fork = Fork());
+		template<typename Fork = serial_fork>
+		void subtract(rbtree& other, const Fork& fork = Fork());
+
+		// order statistics, only with Augment = rbtree_order_statistics
+		iterator nth(size_type k) const;
+		template<typename K>
+		size_type rank(const K& k) const;
+		template<typename K>
+		size_type count_range(const K& lo, const K& hi) const;
+
+		// node handles: take a node out of the tree, or link one in
+		node_type extract(iterator pos) {
+			__rbtree_rebalance_for_erase<Augment>(pos.node, *header.node);
+			--__size;
+			return node_type(static_cast<link_type>(pos.node));
+		}
+		template<typename K>
+		node_type extract(const K& k) {
+			iterator ite = find(k);
+			return ite == end() ? node_type() : extract(ite);
+		}
+		pair<iterator, bool> insert(node_type&& nh);
+
+		// replace the values of this tree with copies of the values of other, in the same shape
+		template<typename Fork = serial_fork>
+		void clone_from(const rbtree& other, const Fork& fork = Fork());
+		// exchange the trees, no node moves
+		void swap(rbtree& other) {
+			ezSTL::swap(header.node, other.header.node);
+			ezSTL::swap(__size, other.__size);
+			ezSTL::swap(cmp, other.cmp);
+		}
 
 		// interface for debug
 		// judge if the present tree is a RBTree
-		bool isRBTree();
+		bool isRBTree() const {
+			if (!__rbtree_is_valid(header.node))
+				return false;
+			// the data of the augmentation must be up to date in every node
+			for (iterator ite = begin(); ite != end(); ++ite)
+				if (!Augment::check(ite.node))
+					return false;
+			return true;
+		}
 	};
 
 	// find a value, O(lgn)
-	template<typename T, typename Compare, typename Alloc>
-	typename rbtree<T, Compare, Alloc>::iterator rbtree<T, Compare, Alloc>::find(const value_type& v) const {
-		link_type x = root();
+	template<typename T, typename Compare, typename Alloc, typename Augment, typename KeyOfValue>
+	template<typename K>
+	typename rbtree<T, Compare, Alloc, Augment, KeyOfValue>::iterator rbtree<T, Compare, Alloc, Augment, KeyOfValue>::find(const K& k) const {
+		base_ptr x = root();
 		while (x != nullptr) {
-			if (cmp(v, x->data))
+			int c = compare(k, key(x));
+			if (c < 0)
 				x = x->left;
-			else if (cmp(x->data, v))
+			else if (c > 0)
 				x = x->right;
 			else
-				return iterator(x);
+				return iterator(static_cast<link_type>(x));
 		}
 		return end();
 	}
 
-	template<typename T, typename Compare, typename Alloc>
-	void rbtree<T, Compare, Alloc>::insert(const value_type& v) {
-		// z : node to be inserted
-		link_type z = Alloc().allocate();
-		Alloc().construct(z, v);
-		// y : parent node of z
-		link_type y = nullptr;
-		// x : node used to find proper position
-		link_type x = root();
-		// find the proper position to insert
+	// the first value whose key is not less than k, end() if none; O(lgn)
+	template<typename T, typename Compare, typename Alloc, typename Augment, typename KeyOfValue>
+	template<typename K>
+	typename rbtree<T, Compare, Alloc, Augment, KeyOfValue>::iterator rbtree<T, Compare, Alloc, Augment, KeyOfValue>::lower_bound(const K& k) const {
+		// y : the last node not less than k on the search path
+		base_ptr y = header.node;
+		base_ptr x = root();
 		while (x != nullptr) {
-			y = x;
-			if (cmp(v, x->data))
-				x = x->left;
-			else if(cmp(x->data, v))
+			if (less_than(key(x), k))
 				x = x->right;
-			// if v == x->data , renew it
 			else {
-				x->data = v;
-				return;
+				y = x;
+				x = x->left;
 			}
 		}
-		z->parent = y;
-		// if it is an empty tree
-		if (y == nullptr) {
-			header.node->parent = z;
-			header.node->left = z;
-			header.node->right = z;
-			z->parent = header.node;
-		}
-		else if (cmp(v, y->data))
-			y->left = z;
-		else y->right = z;
-		// fix up
-		insert_fixup(z);
-		// adjust header: left and right
-		if (empty() || cmp(v, leftmost()->data))
-			header.node->left = z;
-		if (empty() || cmp(rightmost()->data, v))
-			header.node->right = z;
-		++__size;
+		return iterator(static_cast<link_type>(y));
 	}
 
-	template<typename T, typename Compare, typename Alloc>
-	void rbtree<T, Compare, Alloc>::erase(iterator pos) {
-		// adjust leftmost and rightmost
-		if (pos == begin())
-			header.node->left = (pos + 1).node;
-		if(pos == (end() - 1))
-			header.node->right = (pos - 1).node;
-		link_type todelete = nullptr;
-		if (pos.node->left == nullptr || pos.node->right == nullptr)
-			todelete = pos.node;
-		else
-			todelete = (pos + 1).node;
-		
-		// son: son of node todelete, father: parent of son
-		link_type son = nullptr, father = nullptr;
-		if (todelete->left != nullptr)
-			son = todelete->left;
-		else
-			son = todelete->right;
-		if (son)
-			son->parent = todelete->parent;
-		father = todelete->parent;
-		if (todelete == father->left)
-			father->left = son;
-		else if(todelete == father->right)
-			father->right = son;
-		if (todelete == root())
-			header.node->parent = son;
-		// copy data from node to be deleted to pos
-		if (todelete != pos.node)
-			pos.node->data = todelete->data;
-		// if the deleted node is black, then fix up
-		if (todelete->color == __rbtree_black)
-			delete_fixup(father, son);
-		// deallocate node
-		Alloc().destroy(todelete);
-		Alloc().deallocate(todelete);
-		--__size;
+	// the first value whose key is greater than k, end() if none; O(lgn)
+	template<typename T, typename Compare, typename Alloc, typename Augment, typename KeyOfValue>
+	template<typename K>
+	typename rbtree<T, Compare, Alloc, Augment, KeyOfValue>::iterator rbtree<T, Compare, Alloc, Augment, KeyOfValue>::upper_bound(const K& k) const {
+		// y : the last node greater than k on the search path
+		base_ptr y = header.node;
+		base_ptr x = root();
+		while (x != nullptr) {
+			if (less_than(k, key(x))) {
+				y = x;
+				x = x->left;
+			}
+			else
+				x = x->right;
+		}
+		return iterator(static_cast<link_type>(y));
 	}
 
-	template<typename T, typename Compare, typename Alloc>
-	void rbtree<T, Compare, Alloc>::clear() {
-		// dfs clear
-		if (root())
-			dfs_clear(root());
-		header.node->left = header.node;
-		header.node->right = header.node->right;
-		header.node->parent = nullptr;
-		header.node->color = __rbtree_red;
-		__size = 0;
+	// the range of values whose key is equal to k, empty or one value as keys are unique; O(lgn)
+	template<typename T, typename Compare, typename Alloc, typename Augment, typename KeyOfValue>
+	template<typename K>
+	pair<typename rbtree<T, Compare, Alloc, Augment, KeyOfValue>::iterator, typename rbtree<T, Compare, Alloc, Augment, KeyOfValue>::iterator>
+		rbtree<T, Compare, Alloc, Augment, KeyOfValue>::equal_range(const K& k) const {
+		iterator first = lower_bound(k);
+		iterator last = first;
+		if (last != end() && !less_than(k, key(last.node)))
+			++last;
+		return pair<iterator, iterator>(first, last);
 	}
 
-	template<typename T, typename Compare, typename Alloc>
-	void rbtree<T, Compare, Alloc>::left_rotate(link_type z) {
-		link_type y = z->right;
-		z->right = y->left;
-		if (y->left)
-			y->left->parent = z;
-		y->parent = z->parent;
-		// change root
-		if (z == root())
-			header.node->parent = y;
-		else if (z == z->parent->left)
-			z->parent->left = y;
-		else if (z == z->parent->right)
-			z->parent->right = y;
-		y->left = z;
-		z->parent = y;
+	template<typename T, typename Compare, typename Alloc, typename Augment, typename KeyOfValue>
+	pair<typename rbtree<T, Compare, Alloc, Augment, KeyOfValue>::base_ptr, typename rbtree<T, Compare, Alloc, Augment, KeyOfValue>::base_ptr>
+		rbtree<T, Compare, Alloc, Augment, KeyOfValue>::get_insert_unique_pos(const key_type& k) const {
+		// y : parent node of the new node
+		base_ptr y = header.node;
+		// x : node used to find proper position
+		base_ptr x = root();
+		bool go_left = true;
+		// one comparison per level; a three-way comparison stops at the equal node, a less functor
+		// checks equality once at the bottom
+		while (x != nullptr) {
+			y = x;
+			if (__compare_traits<Compare>::three_way) {
+				int c = compare(k, key(x));
+				if (c == 0)
+					return pair<base_ptr, base_ptr>(x, nullptr);
+				go_left = c < 0;
+			}
+			else
+				go_left = less_than(k, key(x));
+			x = go_left ? x->left : x->right;
+		}
+		if (__compare_traits<Compare>::three_way)
+			return pair<base_ptr, base_ptr>(nullptr, y);
+		// j : the greatest node not greater than k, if any
+		iterator j(static_cast<link_type>(y));
+		if (go_left) {
+			if (j == begin())
+				return pair<base_ptr, base_ptr>(nullptr, y);
+			--j;
+		}
+		if (less_than(key(j.node), k))
+			return pair<base_ptr, base_ptr>(nullptr, y);
+		return pair<base_ptr, base_ptr>(j.node, nullptr);
 	}
 
-	template<typename T, typename Compare, typename Alloc>
-	void rbtree<T, Compare, Alloc>::right_rotate(link_type z) {
-		link_type y = z->left;
-		z->left = y->right;
-		if (y->right)
-			y->right->parent = z;
-		y->parent = z->parent;
-		// change root
-		if (z == root())
-			header.node->parent = y;
-		else if (z == z->parent->left)
-			z->parent->left = y;
-		else if (z == z->parent->right)
-			z->parent->right = y;
-		y->right = z;
-		z->parent = y;
-	}
-
-	template<typename T, typename Compare, typename Alloc>
-	void rbtree<T, Compare, Alloc>::insert_fixup(link_type now) {
-		while (now != root() && now->parent->color == __rbtree_red) {
-			if (now->parent == now->parent->parent->left) {
-				link_type uncle = now->parent->parent->right;
-				// if  parent and uncle are both red, case 1
-				if (uncle && uncle->color == __rbtree_red) {
-					now->parent->color = __rbtree_black;
-					uncle->color = __rbtree_black;
-					now->parent->parent->color = __rbtree_red;
-					now = now->parent->parent;
-				}
-				// if no uncle or uncle is black
-				else {
-					// if now is a right child, case 2
-					if (now == now->parent->right) {
-						now = now->parent;
-						left_rotate(now);
-					}
-					// if now is a left child, case 3
-					now->parent->color = __rbtree_black;
-					now->parent->parent->color = __rbtree_red;
-					right_rotate(now->parent->parent);
-				}
+	template<typename T, typename Compare, typename Alloc, typename Augment, typename KeyOfValue>
+	pair<typename rbtree<T, Compare, Alloc, Augment, KeyOfValue>::base_ptr, typename rbtree<T, Compare, Alloc, Augment, KeyOfValue>::base_ptr>
+		rbtree<T, Compare, Alloc, Augment, KeyOfValue>::get_insert_hint_unique_pos(iterator hint, const key_type& k) const {
+		using pos_type = pair<base_ptr, base_ptr>;
+		// hint is end(): the fast path for ascending values is appending after the rightmost node
+		if (hint == end()) {
+			if (size() > 0 && less_than(key(rightmost()), k))
+				return pos_type(nullptr, rightmost());
+			return get_insert_unique_pos(k);
+		}
+		// k goes before hint: check the node before hint
+		int c = compare(k, key(hint.node));
+		if (c < 0) {
+			if (hint.node == leftmost())
+				return pos_type(leftmost(), leftmost());
+			iterator before = hint - 1;
+			if (less_than(key(before.node), k)) {
+				// k goes between before and hint, one of them has a free slot on that side
+				if (before.node->right == nullptr)
+					return pos_type(nullptr, before.node);
+				return pos_type(hint.node, hint.node);
 			}
-			else {
-				link_type uncle = now->parent->parent->left;
-				// if  parent and uncle are both red
-				if (uncle && uncle->color == __rbtree_red) {
-					now->parent->color = __rbtree_black;
-					uncle->color = __rbtree_black;
-					now->parent->parent->color = __rbtree_red;
-					now = now->parent->parent;
-				}
-				// if no uncle or uncle is black
-				else {
-					// if now is a left child
-					if (now == now->parent->left) {
-						now = now->parent;
-						right_rotate(now);
-					}
-					now->parent->color = __rbtree_black;
-					now->parent->parent->color = __rbtree_red;
-					left_rotate(now->parent->parent);
-				}
+			return get_insert_unique_pos(k);
+		}
+		// k goes after hint: check the node after hint
+		if (c > 0) {
+			if (hint.node == rightmost())
+				return pos_type(nullptr, rightmost());
+			iterator after = hint + 1;
+			if (less_than(k, key(after.node))) {
+				if (hint.node->right == nullptr)
+					return pos_type(nullptr, hint.node);
+				return pos_type(after.node, after.node);
 			}
+			return get_insert_unique_pos(k);
 		}
-		// root is always black
-		root()->color = __rbtree_black;
+		// equal to hint
+		return pos_type(hint.node, nullptr);
 	}
 
-	template<typename T, typename Compare, typename Alloc>
-	void rbtree<T, Compare, Alloc>::delete_fixup(link_type father, link_type son) {
-		while (son != root() && (!son || son->color == __rbtree_black)) {
-			link_type brother = nullptr;
-			if (son == father->left) {
-				brother = father->right;
-				// case 1: color of brother is red
-				if (brother->color == __rbtree_red) {
-					brother->color = __rbtree_black;
-					father->color = __rbtree_red;
-					left_rotate(father);
-					brother = father->right;
-				}
-				// case 2: color of brother's sons are both black
-				if ((!brother->left || brother->left->color == __rbtree_black) &&
-					(!brother->right || brother->right->color == __rbtree_black)) {
-					brother->color = __rbtree_red;
-					son = father;
-					father = father->parent;
-				}
-				else {
-					// case 3: color of brother's right son is black
-					if (!brother->right || brother->right->color == __rbtree_black) {
-						brother->color = __rbtree_red;
-						if (brother->left)
-							brother->left->color = __rbtree_black;
-						right_rotate(brother);
-						brother = father->right;
-					}
-					// case 4: color of brother's left son is black
-					brother->color = father->color;
-					father->color = __rbtree_black;
-					if (brother->right)
-						brother->right->color = __rbtree_black;
-					left_rotate(father);
-					break;
-				}
+	template<typename T, typename Compare, typename Alloc, typename Augment, typename KeyOfValue>
+	typename rbtree<T, Compare, Alloc, Augment, KeyOfValue>::iterator
+		rbtree<T, Compare, Alloc, Augment, KeyOfValue>::insert_node(base_ptr x, base_ptr parent, link_type z) {
+		bool insert_left = x != nullptr || parent == header.node || less_than(key(z), key(parent));
+		__rbtree_insert_and_rebalance<Augment>(insert_left, z, parent, *header.node);
+		++__size;
+		return iterator(z);
+	}
+
+	template<typename T, typename Compare, typename Alloc, typename Augment, typename KeyOfValue>
+	pair<typename rbtree<T, Compare, Alloc, Augment, KeyOfValue>::iterator, bool> rbtree<T, Compare, Alloc, Augment, KeyOfValue>::insert(const value_type& v) {
+		// find the position first, a node is allocated only when v is new
+		pair<base_ptr, base_ptr> pos = get_insert_unique_pos(KeyOfValue()(v));
+		if (pos.second == nullptr)
+			return pair<iterator, bool>(iterator(static_cast<link_type>(pos.first)), false);
+		return pair<iterator, bool>(insert_node(pos.first, pos.second, create_node(v)), true);
+	}
+
+	template<typename T, typename Compare, typename Alloc, typename Augment, typename KeyOfValue>
+	typename rbtree<T, Compare, Alloc, Augment, KeyOfValue>::iterator rbtree<T, Compare, Alloc, Augment, KeyOfValue>::insert(iterator hint, const value_type& v) {
+		pair<base_ptr, base_ptr> pos = get_insert_hint_unique_pos(hint, KeyOfValue()(v));
+		if (pos.second == nullptr)
+			return iterator(static_cast<link_type>(pos.first));
+		return insert_node(pos.first, pos.second, create_node(v));
+	}
+
+	template<typename T, typename Compare, typename Alloc, typename Augment, typename KeyOfValue>
+	pair<typename rbtree<T, Compare, Alloc, Augment, KeyOfValue>::iterator, bool> rbtree<T, Compare, Alloc, Augment, KeyOfValue>::insert(node_type&& nh) {
+		if (nh.empty())
+			return pair<iterator, bool>(end(), false);
+		// the node is linked as it is, the handle keeps it if the key exists
+		pair<base_ptr, base_ptr> pos = get_insert_unique_pos(KeyOfValue()(nh.value()));
+		if (pos.second == nullptr)
+			return pair<iterator, bool>(iterator(static_cast<link_type>(pos.first)), false);
+		return pair<iterator, bool>(insert_node(pos.first, pos.second, nh.release()), true);
+	}
+
+	template<typename T, typename Compare, typename Alloc, typename Augment, typename KeyOfValue>
+	template<typename... Args>
+	pair<typename rbtree<T, Compare, Alloc, Augment, KeyOfValue>::iterator, bool> rbtree<T, Compare, Alloc, Augment, KeyOfValue>::emplace(Args&&... args) {
+		// the value is only known once the node is built
+		link_type z = create_node(ezSTL::forward<Args>(args)...);
+		pair<base_ptr, base_ptr> pos = get_insert_unique_pos(key(z));
+		if (pos.second == nullptr) {
+			destroy_node(z);
+			return pair<iterator, bool>(iterator(static_cast<link_type>(pos.first)), false);
+		}
+		return pair<iterator, bool>(insert_node(pos.first, pos.second, z), true);
+	}
+
+	template<typename T, typename Compare, typename Alloc, typename Augment, typename KeyOfValue>
+	template<typename... Args>
+	typename rbtree<T, Compare, Alloc, Augment, KeyOfValue>::iterator rbtree<T, Compare, Alloc, Augment, KeyOfValue>::emplace_hint(iterator hint, Args&&... args) {
+		link_type z = create_node(ezSTL::forward<Args>(args)...);
+		pair<base_ptr, base_ptr> pos = get_insert_hint_unique_pos(hint, key(z));
+		if (pos.second == nullptr) {
+			destroy_node(z);
+			return iterator(static_cast<link_type>(pos.first));
+		}
+		return insert_node(pos.first, pos.second, z);
+	}
+
+	template<typename T, typename Compare, typename Alloc, typename Augment, typename KeyOfValue>
+	template<typename Iterator>
+	void rbtree<T, Compare, Alloc, Augment, KeyOfValue>::insert(Iterator first, Iterator last) {
+		// a non empty tree: insert one by one, hinting the position after the previous value,
+		// which makes sorted values O(1) each
+		if (!empty()) {
+			iterator hint = end();
+			for (; first != last; ++first) {
+				hint = insert(hint, *first);
+				++hint;
 			}
-			// similar as above, only change left to right, change right to left
+			return;
+		}
+		// an empty tree: build it from sorted values in O(n)
+		if (ezSTL::is_sorted(first, last, value_comp())) {
+			build_from_sorted(first, last);
+			return;
+		}
+		vector<value_type> buffer;
+		for (; first != last; ++first)
+			buffer.push_back(*first);
+		// stable, so the first of equal values stays in front and is the one kept
+		ezSTL::stable_sort(buffer.begin(), buffer.end(), value_comp());
+		build_from_sorted(buffer.begin(), buffer.end());
+	}
+
+	template<typename T, typename Compare, typename Alloc, typename Augment, typename KeyOfValue>
+	template<typename Iterator>
+	void rbtree<T, Compare, Alloc, Augment, KeyOfValue>::build_from_sorted(Iterator first, Iterator last) {
+		// create the nodes in order, chained through the right links, skipping values equal to the previous one
+		base_ptr chain = nullptr;
+		base_ptr* tail = &chain;
+		base_ptr prev = nullptr;
+		size_type n = 0;
+		for (; first != last; ++first) {
+			if (prev != nullptr && !less_than(key(prev), KeyOfValue()(*first)))
+				continue;
+			link_type z = create_node(*first);
+			*tail = z;
+			tail = &z->right;
+			prev = z;
+			++n;
+		}
+		if (n == 0)
+			return;
+		base_ptr leftmost_node = chain;
+		base_ptr root_node = __rbtree_link_balanced<Augment>(chain, n, 0, __bit_width(n) - 1);
+		root_node->set_color(__rbtree_black);
+		root_node->set_parent(header.node);
+		header.node->set_parent(root_node);
+		header.node->left = leftmost_node;
+		header.node->right = prev;
+		__size = n;
+		thread_all();
+	}
+
+	template<typename T, typename Compare, typename Alloc, typename Augment, typename KeyOfValue>
+	void rbtree<T, Compare, Alloc, Augment, KeyOfValue>::erase(iterator pos) {
+		// relink the tree around pos, then release its node
+		__rbtree_rebalance_for_erase<Augment>(pos.node, *header.node);
+		destroy_node(pos.node);
+		--__size;
+	}
+
+	template<typename T, typename Compare, typename Alloc, typename Augment, typename KeyOfValue>
+	typename rbtree<T, Compare, Alloc, Augment, KeyOfValue>::iterator rbtree<T, Compare, Alloc, Augment, KeyOfValue>::erase(iterator first, iterator last) {
+		if (first == begin() && last == end()) {
+			clear();
+			return end();
+		}
+		// a short range is erased node by node
+		iterator ite = first;
+		for (int steps = 0; ite != last && steps < 8; ++steps)
+			++ite;
+		if (ite == last) {
+			while (first != last)
+				erase(first++);
+			return last;
+		}
+		// split off the values before first, then the values from last on, and join the two sides at last;
+		// first is the node equal to the key it is split by, so is last
+		base_ptr l, equal, r;
+		split(root(), key(first.node), l, equal, r);
+		base_ptr middle = r;
+		if (last != end()) {
+			base_ptr last_node;
+			split(r, key(last.node), middle, last_node, r);
+			l = __rbtree_join<Augment>(l, last_node, r);
+		}
+		if (Augment::threaded)
+			__rbtree_thread(__rbtree_prev(first.node), last.node);
+		size_type destroyed = destroy_subtree(middle) + 1;
+		destroy_node(static_cast<link_type>(first.node));
+		set_root(l, __size - destroyed);
+		return last;
+	}
+
+	// f(value) for every value with a key in [lo, hi) in order
+	template<typename T, typename Compare, typename Alloc, typename Augment, typename KeyOfValue>
+	template<typename K, typename Function>
+	void rbtree<T, Compare, Alloc, Augment, KeyOfValue>::for_each_in_range(const K& lo, const K& hi, Function f) const {
+		if (!less_than(lo, hi))
+			return;
+		// the scan stops at the first node not less than hi, found once so the loop compares no values
+		base_ptr stop = lower_bound(hi).node;
+		// the nodes whose left subtree is being visited, at most one per level,
+		// and a tree of less than 2^32 nodes is at most 64 levels high
+		base_ptr stack[2 * sizeof(size_type) * 8];
+		int top = 0;
+		base_ptr x = root();
+		while (x != nullptr) {
+			if (less_than(key(x), lo))
+				x = x->right;
 			else {
-				brother = father->left;
-				if (brother->color == __rbtree_red) {
-					brother->color = __rbtree_black;
-					father->color = __rbtree_red;
-					right_rotate(father);
-					brother = father->left;
-				}
-				if ((!brother->right || brother->right->color == __rbtree_black) &&
-					(!brother->left || brother->left->color == __rbtree_black)) {
-					brother->color = __rbtree_red;
-					son = father;
-					father = father->parent;
-				}
-				else {
-					if (!brother->left || brother->left->color == __rbtree_black) {
-						brother->color = __rbtree_red;
-						if (brother->right)
-							brother->right->color = __rbtree_black;
-						left_rotate(brother);
-						brother = father->left;
-					}
-					brother->color = father->color;
-					father->color = __rbtree_black;
-					if (brother->left)
-						brother->left->color = __rbtree_black;
-					right_rotate(father);
-					break;
-				}
+				stack[top++] = x;
+				x = x->left;
 			}
 		}
-		if (son)
-			son->color = __rbtree_black;
-	}
-
-	template<typename T, typename Compare, typename Alloc>
-	void rbtree<T, Compare, Alloc>::dfs_clear(link_type root) {
-		// dfs clear left and right
-		if (root->left)
-			dfs_clear(root->left);
-		if (root->right)
-			dfs_clear(root->right);
-		Alloc().destroy(root);
-		Alloc().deallocate(root);
-	}
-
-	// interface for debug
-	template<typename T, typename Compare, typename Alloc>
-	bool rbtree<T, Compare, Alloc>::isRBTree() {
-		if (empty()) return true;
-		// if root is not black, return false
-		if (root()->color != __rbtree_black)
-			return false;
-		// if a node is red and its left or right is not black, return false
-		for (auto ite = begin(); ite != end(); ++ite) {
-			if (ite.node->color == __rbtree_red) {
-				if (ite.node->left != nullptr && ite.node->left->color != __rbtree_black)
-					return false;
-				if (ite.node->right != nullptr && ite.node->right->color != __rbtree_black)
-					return false;
+		while (top > 0) {
+			x = stack[--top];
+			if (x == stop)
+				return;
+			f(static_cast<link_type>(x)->data);
+			for (x = x->right; x != nullptr; x = x->left)
+				stack[top++] = x;
+		}
+	}
+
+	template<typename T, typename Compare, typename Alloc, typename Augment, typename KeyOfValue>
+	void rbtree<T, Compare, Alloc, Augment, KeyOfValue>::set_root(base_ptr x, size_type n) {
+		header.node->set_parent(x);
+		__size = n;
+		if (x == nullptr) {
+			header.node->left = header.node;
+			header.node->right = header.node;
+			if (Augment::threaded)
+				__rbtree_thread(header.node, header.node);
+			return;
+		}
+		x->set_parent(header.node);
+		x->set_color(__rbtree_black);
+		header.node->left = __rbtree_node_base::minimum(x);
+		header.node->right = __rbtree_node_base::maximum(x);
+	}
+
+	template<typename T, typename Compare, typename Alloc, typename Augment, typename KeyOfValue>
+	void rbtree<T, Compare, Alloc, Augment, KeyOfValue>::thread_all() {
+		if (!Augment::threaded)
+			return;
+		base_ptr prev = header.node;
+		for (base_ptr x = header.node->left; x != header.node; x = __rbtree_increment(x)) {
+			__rbtree_thread(prev, x);
+			prev = x;
+		}
+		__rbtree_thread(prev, header.node);
+	}
+
+	template<typename T, typename Compare, typename Alloc, typename Augment, typename KeyOfValue>
+	void rbtree<T, Compare, Alloc, Augment, KeyOfValue>::split(base_ptr x, const key_type& k, base_ptr& l, base_ptr& equal, base_ptr& r) const {
+		if (x == nullptr) {
+			l = equal = r = nullptr;
+			return;
+		}
+		base_ptr x_left = x->left;
+		base_ptr x_right = x->right;
+		int c = compare(k, key(x));
+		if (c < 0) {
+			split(x_left, k, l, equal, r);
+			r = __rbtree_join<Augment>(r, x, x_right);
+		}
+		else if (c > 0) {
+			split(x_right, k, l, equal, r);
+			l = __rbtree_join<Augment>(x_left, x, l);
+		}
+		else {
+			l = x_left;
+			equal = x;
+			r = x_right;
+		}
+	}
+
+	template<typename T, typename Compare, typename Alloc, typename Augment, typename KeyOfValue>
+	template<typename Fork>
+	typename rbtree<T, Compare, Alloc, Augment, KeyOfValue>::base_ptr rbtree<T, Compare, Alloc, Augment, KeyOfValue>::union_subtrees(base_ptr a, base_ptr b,
+		bool keep_b, unsigned int depth, const Fork& fork, size_type& destroyed) {
+		destroyed = 0;
+		if (a == nullptr)
+			return b;
+		if (b == nullptr)
+			return a;
+		// split b by the root of a, then unite the two sides independently
+		base_ptr l, equal, r;
+		split(b, key(a), l, equal, r);
+		base_ptr a_left = a->left;
+		base_ptr a_right = a->right;
+		size_type left_destroyed = 0;
+		size_type right_destroyed = 0;
+		fork(depth,
+			[&] { l = union_subtrees(a_left, l, keep_b, depth + 1, fork, left_destroyed); },
+			[&] { r = union_subtrees(a_right, r, keep_b, depth + 1, fork, right_destroyed); });
+		destroyed = left_destroyed + right_destroyed;
+		if (equal != nullptr) {
+			++destroyed;
+			if (keep_b)
+				ezSTL::swap(a, equal);
+			destroy_node(static_cast<link_type>(equal));
+		}
+		return __rbtree_join<Augment>(l, a, r);
+	}
+
+	template<typename T, typename Compare, typename Alloc, typename Augment, typename KeyOfValue>
+	template<typename Fork>
+	typename rbtree<T, Compare, Alloc, Augment, KeyOfValue>::base_ptr rbtree<T, Compare, Alloc, Augment, KeyOfValue>::intersect_subtrees(base_ptr a, base_ptr b,
+		bool keep_b, unsigned int depth, const Fork& fork, size_type& destroyed) {
+		if (a == nullptr || b == nullptr) {
+			destroyed = destroy_subtree(a) + destroy_subtree(b);
+			return nullptr;
+		}
+		base_ptr l, equal, r;
+		split(b, key(a), l, equal, r);
+		base_ptr a_left = a->left;
+		base_ptr a_right = a->right;
+		size_type left_destroyed = 0;
+		size_type right_destroyed = 0;
+		fork(depth,
+			[&] { l = intersect_subtrees(a_left, l, keep_b, depth + 1, fork, left_destroyed); },
+			[&] { r = intersect_subtrees(a_right, r, keep_b, depth + 1, fork, right_destroyed); });
+		destroyed = left_destroyed + right_destroyed + 1;
+		// the root of a stays only if b has it too
+		if (equal == nullptr) {
+			destroy_node(static_cast<link_type>(a));
+			return __rbtree_join2<Augment>(l, r);
+		}
+		if (keep_b)
+			ezSTL::swap(a, equal);
+		destroy_node(static_cast<link_type>(equal));
+		return __rbtree_join<Augment>(l, a, r);
+	}
+
+	template<typename T, typename Compare, typename Alloc, typename Augment, typename KeyOfValue>
+	template<typename Fork>
+	typename rbtree<T, Compare, Alloc, Augment, KeyOfValue>::base_ptr rbtree<T, Compare, Alloc, Augment, KeyOfValue>::difference_subtrees(base_ptr a, base_ptr b,
+		unsigned int depth, const Fork& fork, size_type& destroyed) {
+		if (a == nullptr || b == nullptr) {
+			destroyed = destroy_subtree(b);
+			return a;
+		}
+		// split a by the root of b, the root of b and its equal in a are both removed
+		base_ptr l, equal, r;
+		split(a, key(b), l, equal, r);
+		base_ptr b_left = b->left;
+		base_ptr b_right = b->right;
+		size_type left_destroyed = 0;
+		size_type right_destroyed = 0;
+		fork(depth,
+			[&] { l = difference_subtrees(l, b_left, depth + 1, fork, left_destroyed); },
+			[&] { r = difference_subtrees(r, b_right, depth + 1, fork, right_destroyed); });
+		destroyed = left_destroyed + right_destroyed + 1;
+		destroy_node(static_cast<link_type>(b));
+		if (equal != nullptr) {
+			++destroyed;
+			destroy_node(static_cast<link_type>(equal));
+		}
+		return __rbtree_join2<Augment>(l, r);
+	}
+
+	template<typename T, typename Compare, typename Alloc, typename Augment, typename KeyOfValue>
+	template<typename Fork>
+	void rbtree<T, Compare, Alloc, Augment, KeyOfValue>::union_with(rbtree& other, bool replace, const Fork& fork) {
+		if (this == &other)
+			return;
+		// split the larger tree by the values of the smaller one
+		base_ptr a = root();
+		base_ptr b = other.root();
+		bool keep_b = replace;
+		if (other.size() < size()) {
+			ezSTL::swap(a, b);
+			keep_b = !replace;
+		}
+		size_type n = size() + other.size();
+		size_type destroyed = 0;
+		base_ptr x = union_subtrees(a, b, keep_b, 0, fork, destroyed);
+		other.set_root(nullptr, 0);
+		set_root(x, n - destroyed);
+		thread_all();
+	}
+
+	template<typename T, typename Compare, typename Alloc, typename Augment, typename KeyOfValue>
+	template<typename Fork>
+	void rbtree<T, Compare, Alloc, Augment, KeyOfValue>::intersect_with(rbtree& other, const Fork& fork) {
+		if (this == &other)
+			return;
+		base_ptr a = root();
+		base_ptr b = other.root();
+		bool keep_b = false;
+		if (other.size() < size()) {
+			ezSTL::swap(a, b);
+			keep_b = true;
+		}
+		size_type n = size() + other.size();
+		size_type destroyed = 0;
+		base_ptr x = intersect_subtrees(a, b, keep_b, 0, fork, destroyed);
+		other.set_root(nullptr, 0);
+		set_root(x, n - destroyed);
+		thread_all();
+	}
+
+	template<typename T, typename Compare, typename Alloc, typename Augment, typename KeyOfValue>
+	template<typename Fork>
+	void rbtree<T, Compare, Alloc, Augment, KeyOfValue>::subtract(rbtree& other, const Fork& fork) {
+		if (this == &other) {
+			clear();
+			return;
+		}
+		size_type n = size() + other.size();
+		size_type destroyed = 0;
+		base_ptr x = difference_subtrees(root(), other.root(), 0, fork, destroyed);
+		other.set_root(nullptr, 0);
+		set_root(x, n - destroyed);
+		thread_all();
+	}
+
+	// the k-th value counting from 0, end() if k >= size(); O(lgn)
+	template<typename T, typename Compare, typename Alloc, typename Augment, typename KeyOfValue>
+	typename rbtree<T, Compare, Alloc, Augment, KeyOfValue>::iterator rbtree<T, Compare, Alloc, Augment, KeyOfValue>::nth(size_type k) const {
+		base_ptr x = root();
+		while (x != nullptr) {
+			size_type left_count = Augment::count(x->left);
+			if (k < left_count)
+				x = x->left;
+			else if (k == left_count)
+				return iterator(static_cast<link_type>(x));
+			else {
+				k -= left_count + 1;
+				x = x->right;
 			}
-				
 		}
-		link_type x = root();
-		unsigned int count_of_black = 0;
-		// count the number of black nodes in a path
+		return end();
+	}
+
+	// the number of values whose key is less than k; O(lgn)
+	template<typename T, typename Compare, typename Alloc, typename Augment, typename KeyOfValue>
+	template<typename K>
+	typename rbtree<T, Compare, Alloc, Augment, KeyOfValue>::size_type rbtree<T, Compare, Alloc, Augment, KeyOfValue>::rank(const K& k) const {
+		size_type result = 0;
+		base_ptr x = root();
 		while (x != nullptr) {
-			if (x->color == __rbtree_black)
-				++count_of_black;
-			x = x->left;
-		}
-		// NIL node is black
-		++count_of_black;
-		// if the number of black nodes in any path are different, return false
-		return dfs_isRBTree(root(), 0, count_of_black);
-	}
-
-	template<typename T, typename Compare, typename Alloc>
-	bool rbtree<T, Compare, Alloc>::dfs_isRBTree(link_type root, unsigned int count_of_black_now, const unsigned int count_of_black) {
-		// if root is black, count plus 1
-		if (root->color == __rbtree_black)
-			++count_of_black_now;
-		// left or right is nullptr
-		if (root->left == nullptr && root->right == nullptr) {
-			++count_of_black_now;
-			if (count_of_black_now != count_of_black)
-				return false;
-			else return true;
+			if (less_than(key(x), k)) {
+				result += Augment::count(x->left) + 1;
+				x = x->right;
+			}
+			else
+				x = x->left;
 		}
-		// left and right are not nullptr
+		return result;
+	}
+
+	// the number of values with a key in [lo, hi); O(lgn)
+	template<typename T, typename Compare, typename Alloc, typename Augment, typename KeyOfValue>
+	template<typename K>
+	typename rbtree<T, Compare, Alloc, Augment, KeyOfValue>::size_type
+		rbtree<T, Compare, Alloc, Augment, KeyOfValue>::count_range(const K& lo, const K& hi) const {
+		if (!less_than(lo, hi))
+			return 0;
+		return rank(hi) - rank(lo);
+	}
+
+	template<typename T, typename Compare, typename Alloc, typename Augment, typename KeyOfValue>
+	void rbtree<T, Compare, Alloc, Augment, KeyOfValue>::clear() {
+		destroy_subtree(root());
+		set_root(nullptr, 0);
+	}
+
+	// O(1) here, the nodes are destroyed by the thread of reclaimer
+	template<typename T, typename Compare, typename Alloc, typename Augment, typename KeyOfValue>
+	template<typename Reclaimer>
+	void rbtree<T, Compare, Alloc, Augment, KeyOfValue>::deferred_clear(Reclaimer& reclaimer) {
+		base_ptr x = root();
+		set_root(nullptr, 0);
+		if (x != nullptr)
+			reclaimer.submit([x] { destroy_subtree(x); });
+	}
+
+	// the node is built from the value only, so the color and the data of Augment are set here;
+	// nodes are allocated in preorder, parent before children
+	template<typename T, typename Compare, typename Alloc, typename Augment, typename KeyOfValue>
+	template<typename Fork>
+	typename rbtree<T, Compare, Alloc, Augment, KeyOfValue>::base_ptr rbtree<T, Compare, Alloc, Augment, KeyOfValue>::clone_subtree(
+		const_base_ptr x, base_ptr p, unsigned int depth, const Fork& fork) {
+		if (x == nullptr)
+			return nullptr;
+		link_type z = create_node(static_cast<const rbtree_node*>(x)->data);
+		z->set_parent_and_color(p, x->color());
+		if (x->left != nullptr && x->right != nullptr)
+			fork(depth,
+				[&] { z->left = clone_subtree(x->left, z, depth + 1, fork); },
+				[&] { z->right = clone_subtree(x->right, z, depth + 1, fork); });
 		else {
-			if (root->left == nullptr)
-				return count_of_black_now + 1 == count_of_black && dfs_isRBTree(root->right, count_of_black_now, count_of_black);
-			else if (root->right == nullptr)
-				return count_of_black_now + 1 == count_of_black && dfs_isRBTree(root->left, count_of_black_now, count_of_black);
-			else
-				return dfs_isRBTree(root->left, count_of_black_now, count_of_black) && dfs_isRBTree(root->right, count_of_black_now, count_of_black);
+			z->left = clone_subtree(x->left, z, depth + 1, fork);
+			z->right = clone_subtree(x->right, z, depth + 1, fork);
+		}
+		if (Augment::enabled)
+			Augment::update(z);
+		return z;
+	}
+
+	// O(n), no comparison and no rotation
+	template<typename T, typename Compare, typename Alloc, typename Augment, typename KeyOfValue>
+	template<typename Fork>
+	void rbtree<T, Compare, Alloc, Augment, KeyOfValue>::clone_from(const rbtree& other, const Fork& fork) {
+		if (this == &other)
+			return;
+		clear();
+		cmp = other.cmp;
+		set_root(clone_subtree(other.root(), nullptr, 0, fork), other.__size);
+		thread_all();
+	}
+
+	template<typename T, typename Compare, typename Alloc, typename Augment, typename KeyOfValue>
+	typename rbtree<T, Compare, Alloc, Augment, KeyOfValue>::size_type rbtree<T, Compare, Alloc, Augment, KeyOfValue>::destroy_subtree(base_ptr x) {
+		// rotate the left child up until x has none, then x goes and its right subtree is next,
+		// so no stack is needed and every node is visited at most twice
+		size_type n = 0;
+		while (x != nullptr) {
+			if (x->left != nullptr) {
+				base_ptr y = x->left;
+				x->left = y->right;
+				y->right = x;
+				x = y;
+			}
+			else {
+				base_ptr next = x->right;
+				destroy_node(static_cast<link_type>(x));
+				++n;
+				x = next;
+			}
 		}
+		return n;
 	}
 }
 
-#endif // !EZSTL_RBTREE_H
\ No newline at end of file
+#endif // !EZSTL_RBTREE_H
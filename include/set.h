@@ -8,9 +8,38 @@
 // 3. size_type size() const;
 // 4. bool empty() const;
 // 5. iterator find(const T& v) const;
-// 6. void insert(const T& v);
-// 7. void erase(iterator pos);
-// 8. void clear();
+// 6. iterator lower_bound(const T& v) const;
+// 7. iterator upper_bound(const T& v) const;
+// 8. pair<iterator, iterator> equal_range(const T& v) const;
+// 9. pair<iterator, bool> insert(const T& v);
+// 10. iterator insert(iterator hint, const T& v);
+// 11. pair<iterator, bool> emplace(Args&&... args);
+// 12. iterator emplace_hint(iterator hint, Args&&... args);
+// 13. void insert(Iterator first, Iterator last);
+// 14. void erase(iterator pos);
+// 15. iterator erase(iterator first, iterator last);
+// 16. void for_each_in_range(const T& lo, const T& hi, Function f) const;
+// 17. void clear();
+// 18. value_compare value_comp() const;
+// 19. void set_union(set& other, const Fork& fork = Fork());
+// 20. void set_intersection(set& other, const Fork& fork = Fork());
+// 21. void set_difference(set& other, const Fork& fork = Fork());
+// 22. size_type count(const T& v) const;
+// 23. bool contains(const T& v) const;
+// 24. node_type extract(iterator pos);
+// 25. node_type extract(const T& v);
+// 26. pair<iterator, bool> insert(node_type&& nh);
+// 27. void clone_from(const set& other, const Fork& fork = Fork());
+// 28. void swap(set& other);
+// 29. void deferred_clear(Reclaimer& reclaimer);
+// with Augment = rbtree_order_statistics:
+// 30. iterator nth(size_type k) const;
+// 31. size_type rank(const T& v) const;
+// 32. size_type count_range(const T& lo, const T& hi) const;
+//
+// of equal values in a range the first is inserted
+// the set operations move or destroy the nodes of other and leave it empty
+// with a transparent Compare such as less<>, the lookups, count and contains take any K comparable with T
 
 #ifndef EZSTL_SET_H
 #define EZSTL_SET_H
@@ -18,22 +47,31 @@
 #include "functional.h"
 #include "memory.h"
 #include "rbtree.h"
+#include "utility.h"
 
 namespace ezSTL {
-	template<typename T, typename Compare = less<T>, typename Alloc = allocator<__rbtree_node<T>>>
+	template<typename T, typename Compare = less<T>, typename Alloc = allocator<T>, typename Augment = rbtree_no_augment>
 	class set {
 	public:
 		using size_type = unsigned int;
 		using value_type = T;
-		using iterator = __rbtree_iterator<T>;
+		using iterator = typename rbtree<T, Compare, Alloc, Augment>::iterator;
 		using const_iterator = const iterator;
 		using reference = value_type&;
 		using const_reference = const T&;
+		using value_compare = typename rbtree<T, Compare, Alloc, Augment>::value_compare;
 		using difference_type = int;
+		using node_type = typename rbtree<T, Compare, Alloc, Augment>::node_type;
 	protected:
-		rbtree<T, Compare, Alloc> base_rbt;
+		rbtree<T, Compare, Alloc, Augment> base_rbt;
 	public:
-		
+		// constructor
+		set() = default;
+		template<typename Iterator>
+		set(Iterator first, Iterator last) {
+			base_rbt.insert(first, last);
+		}
+
 		iterator begin() const {
 			return base_rbt.begin();
 		}
@@ -50,17 +88,142 @@ namespace ezSTL {
 		iterator find(const T& v) const {
 			return base_rbt.find(v);
 		}
-		// insert a value
-		void insert(const T& v) {
-			base_rbt.insert(v);
+		// the first value not less than v
+		iterator lower_bound(const T& v) const {
+			return base_rbt.lower_bound(v);
+		}
+		// the first value greater than v
+		iterator upper_bound(const T& v) const {
+			return base_rbt.upper_bound(v);
+		}
+		pair<iterator, iterator> equal_range(const T& v) const {
+			return base_rbt.equal_range(v);
+		}
+		// the lookups by any K comparable with T, only with a transparent Compare
+		template<typename K, typename = typename __if_transparent<Compare, K>::type>
+		iterator find(const K& k) const {
+			return base_rbt.find(k);
+		}
+		template<typename K, typename = typename __if_transparent<Compare, K>::type>
+		iterator lower_bound(const K& k) const {
+			return base_rbt.lower_bound(k);
+		}
+		template<typename K, typename = typename __if_transparent<Compare, K>::type>
+		iterator upper_bound(const K& k) const {
+			return base_rbt.upper_bound(k);
+		}
+		template<typename K, typename = typename __if_transparent<Compare, K>::type>
+		pair<iterator, iterator> equal_range(const K& k) const {
+			return base_rbt.equal_range(k);
+		}
+		// 1 if v is in the set, 0 otherwise
+		size_type count(const T& v) const {
+			return base_rbt.find(v) != end() ? 1 : 0;
+		}
+		template<typename K, typename = typename __if_transparent<Compare, K>::type>
+		size_type count(const K& k) const {
+			return base_rbt.find(k) != end() ? 1 : 0;
+		}
+		bool contains(const T& v) const {
+			return base_rbt.find(v) != end();
+		}
+		template<typename K, typename = typename __if_transparent<Compare, K>::type>
+		bool contains(const K& k) const {
+			return base_rbt.find(k) != end();
+		}
+		// insert a value, nothing changes if an equal value exists
+		pair<iterator, bool> insert(const T& v) {
+			return base_rbt.insert(v);
+		}
+		// insert a value, searching from the position before hint
+		iterator insert(iterator hint, const T& v) {
+			return base_rbt.insert(hint, v);
+		}
+		template<typename... Args>
+		pair<iterator, bool> emplace(Args&&... args) {
+			return base_rbt.emplace(ezSTL::forward<Args>(args)...);
+		}
+		template<typename... Args>
+		iterator emplace_hint(iterator hint, Args&&... args) {
+			return base_rbt.emplace_hint(hint, ezSTL::forward<Args>(args)...);
+		}
+		// insert a range of values, O(n) for a sorted range into an empty set
+		template<typename Iterator>
+		void insert(Iterator first, Iterator last) {
+			base_rbt.insert(first, last);
 		}
 		// erase an iterator
 		void erase(iterator pos) {
 			base_rbt.erase(pos);
 		}
+		// erase a range of iterators, return last
+		iterator erase(iterator first, iterator last) {
+			return base_rbt.erase(first, last);
+		}
+		// f(v) for every value v in [lo, hi)
+		template<typename Function>
+		void for_each_in_range(const T& lo, const T& hi, Function f) const {
+			base_rbt.for_each_in_range(lo, hi, f);
+		}
 		void clear() {
 			base_rbt.clear();
 		}
+		// orders the values by Compare, true for v < w with a three-way Compare too
+		value_compare value_comp() const {
+			return base_rbt.value_comp();
+		}
+		// this = this | other
+		template<typename Fork = serial_fork>
+		void set_union(set& other, const Fork& fork = Fork()) {
+			base_rbt.union_with(other.base_rbt, false, fork);
+		}
+		// this = this & other
+		template<typename Fork = serial_fork>
+		void set_intersection(set& other, const Fork& fork = Fork()) {
+			base_rbt.intersect_with(other.base_rbt, fork);
+		}
+		// this = this - other
+		template<typename Fork = serial_fork>
+		void set_difference(set& other, const Fork& fork = Fork()) {
+			base_rbt.subtract(other.base_rbt, fork);
+		}
+		// take the node of pos out of the set
+		node_type extract(iterator pos) {
+			return base_rbt.extract(pos);
+		}
+		// take the node of v out of the set, an empty handle if v is missing
+		node_type extract(const T& v) {
+			return base_rbt.extract(v);
+		}
+		// link the node of nh into the set, it stays in nh if an equal value exists
+		pair<iterator, bool> insert(node_type&& nh) {
+			return base_rbt.insert(ezSTL::move(nh));
+		}
+		// replace the values with copies of the values of other
+		template<typename Fork = serial_fork>
+		void clone_from(const set& other, const Fork& fork = Fork()) {
+			base_rbt.clone_from(other.base_rbt, fork);
+		}
+		void swap(set& other) {
+			base_rbt.swap(other.base_rbt);
+		}
+		// empty the set now, reclaimer destroys the values later
+		template<typename Reclaimer>
+		void deferred_clear(Reclaimer& reclaimer) {
+			base_rbt.deferred_clear(reclaimer);
+		}
+		// the k-th smallest value counting from 0, end() if k >= size()
+		iterator nth(size_type k) const {
+			return base_rbt.nth(k);
+		}
+		// the number of values less than v
+		size_type rank(const T& v) const {
+			return base_rbt.rank(v);
+		}
+		// the number of values in [lo, hi)
+		size_type count_range(const T& lo, const T& hi) const {
+			return base_rbt.count_range(lo, hi);
+		}
 	};
 }
 
@@ -0,0 +1,349 @@
+/*********************************************************************************************/
+// class static_index:
+// an immutable search index over a sorted sequence, the values laid out in Eytzinger order:
+// the array holds a complete binary search tree level by level, the children of index k are
+// 2k and 2k + 1 and the root is index 1; a search walks down from the root with one conditional
+// move per level, and the values a few levels below fit in one cache line, so the line four
+// levels down (for unsigned values) is prefetched while the levels in between are compared;
+// a few unused values in front of the array make index 0, before the root, start a cache line,
+// so every block of descendants is one whole line when sizeof(T) divides 64 and the allocator
+// returns multiples of sizeof(T) (operator new does up to 16 bytes); for other sizes a block
+// may cross into the next line and the search prefetches both lines
+// including some basic functions of static_index:
+//
+// 1. iterator begin() const;
+// 2. iterator end() const;
+// 3. size_type size() const;
+// 4. bool empty() const;
+// 5. iterator find(const T& v) const;
+// 6. iterator lower_bound(const T& v) const;
+// 7. iterator upper_bound(const T& v) const;
+// 8. void find_batch(Iterator first, Iterator last, Output out) const;
+// 9. void lower_bound_batch(Iterator first, Iterator last, Output out) const;
+// 10. size_type bytes_used() const;
+//
+// usage:
+// static_index<unsigned> index(sorted.begin(), sorted.end()); // or (s.begin(), s.end()) of a set
+// auto ite = index.find(42);
+//
+// the range of the constructor must be sorted by Compare; the iterators walk the values in
+// sorted order, each step climbs or descends the implicit tree;
+// the batch functions run a group of searches level by level in lockstep, the cache misses
+// of the searches in a group overlap, and write one iterator per query to out
+
+#ifndef EZSTL_STATIC_INDEX_H
+#define EZSTL_STATIC_INDEX_H
+
+#include "functional.h"
+#include "iterator.h"
+#include "memory.h"
+#include "utility.h"
+#include "vector.h"
+#include "algorithm.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace ezSTL {
+
+	// number of descendants of one index that share a cache line: the largest power of two
+	// not above 64 / sizeof(T), at least 1; line_sized if they fill a line of their own once
+	// index 0 starts a line, which the padding in front of index 0 can arrange
+	template<typename T>
+	class __static_index_block {
+	public:
+		static constexpr unsigned int fit(unsigned int n, unsigned int p) {
+			return p * 2 <= n ? fit(n, p * 2) : p;
+		}
+		static constexpr unsigned int value = sizeof(T) >= 64 ? 1 : fit(64 / sizeof(T), 1);
+		static constexpr bool line_sized = 64 % sizeof(T) == 0 && sizeof(T) <= alignof(std::max_align_t);
+	};
+
+	// the index a search ends on after it went down past the leaves: strip the right turns
+	// taken after the last left turn, and that left turn, what is left is the answer, 0 for none
+	inline unsigned int __static_index_climb(unsigned int k) {
+#if defined(__GNUC__)
+		return k >> __builtin_ffs(~k);
+#else
+		while (k & 1)
+			k >>= 1;
+		return k >> 1;
+#endif
+	}
+
+	// static_index iterator, in-order walk of the implicit tree, index 0 for end()
+	template<typename T>
+	class __static_index_iterator : public iterator<bidirectional_iterator_tag, T> {
+	public:
+		using self = __static_index_iterator<T>;
+		using pointer = const T*;
+		using reference = const T&;
+		using difference_type = int;
+
+		// base[1..n] is the tree
+		const T* base;
+		unsigned int n;
+		unsigned int k;
+
+		__static_index_iterator() = default;
+		__static_index_iterator(const T* b, unsigned int size, unsigned int index) : base(b), n(size), k(index) {}
+
+		bool operator== (const self& x) const {
+			return k == x.k;
+		}
+		bool operator!= (const self& x) const {
+			return k != x.k;
+		}
+		reference operator*() const {
+			return base[k];
+		}
+		pointer operator->() const {
+			return &(operator*());
+		}
+		// the leftmost index of the subtree of k
+		static unsigned int leftmost(unsigned int k, unsigned int n) {
+			while (2 * k <= n)
+				k = 2 * k;
+			return k;
+		}
+		static unsigned int rightmost(unsigned int k, unsigned int n) {
+			while (2 * k + 1 <= n)
+				k = 2 * k + 1;
+			return k;
+		}
+		// go to the in-order successor: the leftmost of the right subtree, or up past the right children
+		self& operator++() {
+			if (2 * k + 1 <= n)
+				k = leftmost(2 * k + 1, n);
+			else {
+				while (k & 1)
+					k >>= 1;
+				k >>= 1;
+			}
+			return *this;
+		}
+		self operator++(int) {
+			self temp = *this;
+			++(*this);
+			return temp;
+		}
+		// --end() is the largest value
+		self& operator--() {
+			if (k == 0)
+				k = rightmost(1, n);
+			else if (2 * k <= n)
+				k = rightmost(2 * k, n);
+			else {
+				while (k != 1 && !(k & 1))
+					k >>= 1;
+				k >>= 1;
+			}
+			return *this;
+		}
+		self operator--(int) {
+			self temp = *this;
+			--(*this);
+			return temp;
+		}
+	};
+
+	// class static_index
+	template<typename T, typename Compare = less<T>, typename Alloc = allocator<T>>
+	class static_index {
+	public:
+		using size_type = unsigned int;
+		using value_type = T;
+		using iterator = __static_index_iterator<T>;
+		using const_iterator = const iterator;
+		using reference = const T&;
+		using const_reference = const T&;
+		using difference_type = int;
+	protected:
+		// tree[shift + 1..shift + n] in Eytzinger order, the values before are not read,
+		// shift puts index 0 at the start of a cache line
+		vector<T, Alloc> tree;
+		size_type shift;
+		size_type n;
+		Compare cmp;
+		enum { block = __static_index_block<T>::value, batch = 8 };
+
+		// the array of the implicit tree, root at index 1
+		const T* base() const {
+			return tree.begin() + shift;
+		}
+		// the block of the descendants of index k a few levels down, one line or two;
+		// the choice is made at compile time, a test in the loop makes gcc drop the prefetches
+		void prefetch_block(size_type k) const {
+			__prefetch(base() + k * block);
+			if (!__static_index_block<T>::line_sized)
+				__prefetch(reinterpret_cast<const char*>(base() + (k + 1) * block) - 1);
+		}
+		// the shift which puts index 0 at the start of a cache line, 0 if the array cannot be aligned
+		size_type aligned_shift() const {
+			size_type misalignment = static_cast<size_type>(reinterpret_cast<uintptr_t>(tree.begin()) % 64);
+			if (!__static_index_block<T>::line_sized || tree.empty() || misalignment % sizeof(T) != 0)
+				return 0;
+			return (64 - misalignment) % 64 / sizeof(T);
+		}
+		// move the values into line with a new array, after a copy
+		void realign() {
+			size_type s = aligned_shift();
+			if (s < shift)
+				for (size_type i = 0; i <= n; ++i)
+					tree[s + i] = ezSTL::move(tree[shift + i]);
+			else if (s > shift)
+				for (size_type i = n + 1; i > 0; --i)
+					tree[s + i - 1] = ezSTL::move(tree[shift + i - 1]);
+			shift = s;
+		}
+	public:
+		// constructor
+		static_index() : shift(0), n(0) {}
+		template<typename Iterator>
+		static_index(Iterator first, Iterator last);
+		// a copy has its own array, which needs its own shift
+		static_index(const static_index& x) : tree(x.tree), shift(x.shift), n(x.n), cmp(x.cmp) {
+			realign();
+		}
+		// a move keeps the array and its shift, x is left empty
+		static_index(static_index&& x) noexcept : tree(ezSTL::move(x.tree)), shift(x.shift), n(x.n), cmp(x.cmp) {
+			x.shift = 0;
+			x.n = 0;
+		}
+		static_index& operator=(const static_index& x) {
+			if (this != &x) {
+				tree = x.tree;
+				shift = x.shift;
+				n = x.n;
+				cmp = x.cmp;
+				realign();
+			}
+			return *this;
+		}
+		static_index& operator=(static_index&& x) noexcept {
+			if (this != &x) {
+				tree = ezSTL::move(x.tree);
+				shift = x.shift;
+				n = x.n;
+				cmp = x.cmp;
+				x.shift = 0;
+				x.n = 0;
+			}
+			return *this;
+		}
+
+		iterator begin() const {
+			return iterator(base(), n, n == 0 ? 0 : iterator::leftmost(1, n));
+		}
+		iterator end() const {
+			return iterator(base(), n, 0);
+		}
+		size_type size() const {
+			return n;
+		}
+		bool empty() const {
+			return n == 0;
+		}
+		// find a value
+		iterator find(const T& v) const {
+			size_type k = lower_index(v);
+			return iterator(base(), n, k != 0 && !cmp(v, base()[k]) ? k : 0);
+		}
+		// the first value not less than v
+		iterator lower_bound(const T& v) const {
+			return iterator(base(), n, lower_index(v));
+		}
+		// the first value greater than v
+		iterator upper_bound(const T& v) const {
+			size_type k = 1;
+			while (k <= n) {
+				prefetch_block(k);
+				k = 2 * k + (cmp(v, base()[k]) ? 0 : 1);
+			}
+			return iterator(base(), n, __static_index_climb(k));
+		}
+		// *out++ = find(v) for every v in [first, last)
+		template<typename Iterator, typename Output>
+		void find_batch(Iterator first, Iterator last, Output out) const {
+			search_batch(first, last, out, true);
+		}
+		// *out++ = lower_bound(v) for every v in [first, last)
+		template<typename Iterator, typename Output>
+		void lower_bound_batch(Iterator first, Iterator last, Output out) const {
+			search_batch(first, last, out, false);
+		}
+		// bytes taken by the array and the index object
+		size_type bytes_used() const {
+			return sizeof(*this) + tree.capacity() * sizeof(T);
+		}
+
+	protected:
+		// index of the first value not less than v, 0 if there is none
+		size_type lower_index(const T& v) const {
+			size_type k = 1;
+			while (k <= n) {
+				prefetch_block(k);
+				k = 2 * k + (cmp(base()[k], v) ? 1 : 0);
+			}
+			return __static_index_climb(k);
+		}
+		template<typename Iterator, typename Output>
+		void search_batch(Iterator first, Iterator last, Output& out, bool exact) const;
+	};
+
+	template<typename T, typename Compare, typename Alloc>
+	template<typename Iterator>
+	static_index<T, Compare, Alloc>::static_index(Iterator first, Iterator last) : shift(0), n(0) {
+		vector<T, Alloc> sorted;
+		for (; first != last; ++first)
+			sorted.push_back(*first);
+		n = sorted.size();
+		if (n == 0)
+			return;
+		// index 0 is never read, the root is at index 1; up to a cache line of values in front
+		// moves index 0 to the start of a line
+		size_type padding = __static_index_block<T>::line_sized ? 64 / sizeof(T) - 1 : 0;
+		tree.reserve(padding + n + 1);
+		for (size_type i = 0; i <= padding + n; ++i)
+			tree.push_back(sorted[0]);
+		shift = aligned_shift();
+		// the i-th value in sorted order goes to the i-th index of the in-order walk
+		size_type i = 0;
+		for (iterator ite = begin(); ite != end(); ++ite)
+			tree[shift + ite.k] = ezSTL::move(sorted[i++]);
+	}
+
+	template<typename T, typename Compare, typename Alloc>
+	template<typename Iterator, typename Output>
+	void static_index<T, Compare, Alloc>::search_batch(Iterator first, Iterator last, Output& out, bool exact) const {
+		const T* values[batch];
+		size_type k[batch];
+		while (first != last) {
+			int m = 0;
+			for (; m < batch && first != last; ++m, ++first) {
+				values[m] = &*first;
+				k[m] = 1;
+			}
+			// every search of the group goes down one level per round, a search that left the tree stays put
+			bool going = n > 0;
+			while (going) {
+				going = false;
+				for (int j = 0; j < m; ++j) {
+					size_type x = k[j];
+					if (x <= n) {
+						prefetch_block(x);
+						k[j] = 2 * x + (cmp(base()[x], *values[j]) ? 1 : 0);
+						going = true;
+					}
+				}
+			}
+			for (int j = 0; j < m; ++j) {
+				size_type x = __static_index_climb(k[j]);
+				if (exact && x != 0 && cmp(*values[j], base()[x]))
+					x = 0;
+				*out++ = iterator(base(), n, x);
+			}
+		}
+	}
+}
+
+#endif // !EZSTL_STATIC_INDEX_H
@@ -15,6 +15,27 @@
 // 10. test_set_map_efficiency();
 // 11. test_algorithm();
 // 12. test_algorithm_efficiency();
+// 13. test_thread_pool();
+// 14. test_thread_pool_efficiency();
+// 15. test_priority_queue_efficiency();
+// 16. test_addressable_heap();
+// 17. test_addressable_heap_efficiency();
+// 18. test_radix_heap();
+// 19. test_radix_heap_efficiency();
+// 20. test_timing_wheel();
+// 21. test_timing_wheel_efficiency();
+// 22. test_list_efficiency();
+// 23. test_unrolled_list();
+// 24. test_unrolled_list_efficiency();
+// 25. test_intrusive_containers();
+// 26. test_intrusive_containers_efficiency();
+// 27. test_forward_list();
+// 28. test_forward_list_efficiency();
+// 29. test_btree();
+// 30. test_flat_containers();
+// 31. test_static_index();
+// 32. test_arena_set();
+// 33. test_interval_map();
 
 #ifndef EZSTL_TEST_H
 #define EZSTL_TEST_H
@@ -22,14 +43,29 @@
 #include "utility.h"
 #include "vector.h"
 #include "list.h"
+#include "forward_list.h"
+#include "unrolled_list.h"
+#include "intrusive_list.h"
+#include "intrusive_rbtree.h"
 #include "stack.h"
 #include "queue.h"
+#include "pairing_heap.h"
+#include "radix_heap.h"
+#include "timing_wheel.h"
 #include "rbtree.h"
 #include "set.h"
 #include "map.h"
+#include "btree_set.h"
+#include "btree_map.h"
+#include "flat_set.h"
+#include "flat_map.h"
+#include "static_index.h"
+#include "arena_set.h"
+#include "interval_map.h"
 #include "unordered_map.h"
 #include "memory.h"
 #include "algorithm.h"
+#include "thread_pool.h"
 #include <string>
 #include <iostream>
 #include <cstdlib>
@@ -40,9 +76,92 @@
 #include <vector>
 #include <algorithm>
 #include <random>
+#include <queue>
+#include <list>
+#include <forward_list>
+#include <unordered_map>
+#include <chrono>
+#include <atomic>
 
 namespace ezSTL {
 
+	// session object of the intrusive container tests, sits in a tree by id and in an lru list at once
+	class __test_session {
+	public:
+		unsigned int id;
+		unsigned long long bytes;
+		intrusive_rbtree_hook tree_hook;
+		intrusive_list_hook lru_hook;
+		bool operator<(const __test_session& s) const {
+			return id < s.id;
+		}
+	};
+
+	// std allocator counting the bytes it holds, for the memory per element of the std containers
+	class __test_allocated_bytes {
+	public:
+		static long long bytes;
+	};
+	long long __test_allocated_bytes::bytes = 0;
+
+	template<typename T>
+	class __test_counting_allocator : public __test_allocated_bytes {
+	public:
+		using value_type = T;
+		__test_counting_allocator() = default;
+		template<typename U>
+		__test_counting_allocator(const __test_counting_allocator<U>&) {}
+		T* allocate(std::size_t n) {
+			bytes += n * sizeof(T);
+			return static_cast<T*>(::operator new(n * sizeof(T)));
+		}
+		void deallocate(T* p, std::size_t n) {
+			bytes -= n * sizeof(T);
+			::operator delete(p);
+		}
+		template<typename U>
+		bool operator== (const __test_counting_allocator<U>&) const {
+			return true;
+		}
+		template<typename U>
+		bool operator!= (const __test_counting_allocator<U>&) const {
+			return false;
+		}
+	};
+
+	// orders pairs by their first members only, pairs of equal first members are equal values
+	class __test_less_first {
+	public:
+		template<typename Pair>
+		bool operator()(const Pair& x, const Pair& y) const {
+			return x.first < y.first;
+		}
+	};
+
+	// string comparators counting their calls, for the comparisons per search of set and map
+	class __test_compare_count {
+	public:
+		static unsigned long long calls;
+	};
+	unsigned long long __test_compare_count::calls = 0;
+
+	class __test_counting_less : public __test_compare_count {
+	public:
+		bool operator()(const std::string& x, const std::string& y) const {
+			++calls;
+			return x < y;
+		}
+	};
+
+	class __test_counting_three_way : public __test_compare_count {
+	public:
+		using is_three_way = void;
+		int operator()(const std::string& x, const std::string& y) const {
+			++calls;
+			return x.compare(y);
+		}
+	};
+
 	class test {
 	public:
 		// ultility
@@ -54,6 +173,10 @@ namespace ezSTL {
 		static void continue_next_test();
 		static void begin_timer();
 		static void end_timer(std::string str, int number);
+		// wall clock timer, used by multithreaded tests since clock() sums the time of all threads
+		static std::chrono::steady_clock::time_point wallStartTime;
+		static void begin_wall_timer();
+		static double end_wall_timer(std::string str, int number);
 		// vector test
 		template<typename T>
 		static void print_vector(vector<T>& v);
@@ -62,6 +185,22 @@ namespace ezSTL {
 		template<typename T>
 		static void print_list(list<T>& l);
 		static void test_list();
+		static void test_list_efficiency();
+		// forward_list test
+		template<typename T>
+		static void print_forward_list(forward_list<T>& l);
+		static void test_forward_list();
+		static void test_forward_list_efficiency();
+		// unrolled_list test
+		template<typename T, unsigned int NodeCapacity>
+		static void print_unrolled_list(unrolled_list<T, NodeCapacity>& l);
+		static void test_unrolled_list();
+		static void test_unrolled_list_efficiency();
+		// intrusive containers test
+		static void print_sessions(intrusive_rbtree<__test_session, &__test_session::tree_hook>& tree,
+			intrusive_list<__test_session, &__test_session::lru_hook>& lru);
+		static void test_intrusive_containers();
+		static void test_intrusive_containers_efficiency();
 		// stack test
 		template<typename T>
 		static void print_stack(stack<T>& s);
@@ -71,21 +210,50 @@ namespace ezSTL {
 		static void print_queue(queue<T>& q);
 		static void test_queue();
 		// priority_queue test
-		template<typename T, typename Compare>
-		static void print_priority_queue(priority_queue<T, Compare>& q);
+		template<typename T, typename Compare, unsigned int Arity>
+		static void print_priority_queue(priority_queue<T, Compare, Arity>& q);
 		static void test_priority_queue();
+		template<typename PriorityQueue>
+		static void priority_queue_push_pop(PriorityQueue& pq, std::string name, const std::vector<unsigned>& data);
+		static void test_priority_queue_efficiency();
+		// addressable heap test(indexed_priority_queue, pairing_heap)
+		template<typename Heap>
+		static void test_decrease_key(Heap& h, std::string name);
+		static void test_addressable_heap();
+		static void test_addressable_heap_efficiency();
+		// radix heap test
+		static void test_radix_heap();
+		static void test_radix_heap_efficiency();
+		// timing wheel test
+		static void test_timing_wheel();
+		static void test_timing_wheel_efficiency();
 		// rbtree test
-		template<typename T, typename Compare>
-		static void print_rbtree(rbtree<T, Compare>& rbt);
+		template<typename T, typename Compare, typename Alloc, typename Augment>
+		static void print_rbtree(rbtree<T, Compare, Alloc, Augment>& rbt);
 		static void test_rbtree();
 		// set test
-		template<typename T, typename Compare>
-		static void print_set(set<T, Compare>& s);
+		template<typename T, typename Compare, typename Alloc, typename Augment>
+		static void print_set(set<T, Compare, Alloc, Augment>& s);
 		static void test_set();
 		// map
-		template<typename K, typename V>
-		static void print_map(map<K, V>& m);
+		template<typename K, typename V, typename Compare, typename Alloc, typename Augment>
+		static void print_map(map<K, V, Compare, Alloc, Augment>& m);
 		static void test_map();
+		template<typename T, typename Compare, typename Alloc, unsigned int NodeBytes>
+		static void print_btree_set(btree_set<T, Compare, Alloc, NodeBytes>& s);
+		static void test_btree();
+		template<typename T, typename Compare, typename Alloc>
+		static void print_flat_set(flat_set<T, Compare, Alloc>& s);
+		static void test_flat_containers();
+		static void test_static_index();
+		static void test_arena_set();
+		static void test_interval_map();
+		template<typename Pair, typename Map, typename Bytes>
+		static void map_insert_find_erase(Map& m, std::string name, const std::vector<unsigned>& keys,
+			const std::vector<unsigned>& queries, Bytes bytes_used);
+		template<typename Set>
+		static void set_insert_find_strings(Set& s, std::string name, const std::vector<std::string>& keys,
+			const std::vector<std::string>& queries);
 		// unordered_map test
 		template<typename Key, typename Value>
 		static void print_unordered_map(unordered_map<Key, Value>& um);
@@ -105,10 +273,16 @@ namespace ezSTL {
 		// algorithm test
 		static void test_algorithm();
 		static void test_algorithm_efficiency();
+		// thread pool test
+		static unsigned long long serial_fib(unsigned int n);
+		static unsigned long long parallel_fib(thread_pool& pool, unsigned int n);
+		static void test_thread_pool();
+		static void test_thread_pool_efficiency();
 	};
 
 	clock_t test::startTime = 0;
 	clock_t test::endTime = 0;
+	std::chrono::steady_clock::time_point test::wallStartTime;
 
 	void test::start_info(std::string s) {
 		std::string asterisk = "********************************";
@@ -138,6 +312,16 @@ namespace ezSTL {
 		std::cout << str << " " + std::to_string(max_number) + " total time : " << (double)(endTime - startTime) / CLOCKS_PER_SEC << "s" << std::endl;
 	}
 
+	void test::begin_wall_timer() {
+		wallStartTime = std::chrono::steady_clock::now();
+	}
+
+	double test::end_wall_timer(std::string str, int max_number) {
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - wallStartTime;
+		std::cout << str << " " + std::to_string(max_number) + " total time : " << elapsed.count() << "s" << std::endl;
+		return elapsed.count();
+	}
+
 	template<typename T>
 	void test::print_vector(vector<T>& v) {
 		std::cout << "size: " << v.size();
@@ -198,6 +382,23 @@ namespace ezSTL {
 		y = ezSTL::move(x);
 		print_vector(y);
 		print_vector(x);
+		test_info("vector   push_back and emplace_back of its own elements when full");
+		vector<std::string> strs;
+		for (int i = 0; i < 4; ++i)
+			strs.push_back(std::to_string(i));
+		// each of these grows the vector
+		strs.push_back(strs[0]);
+		for (int i = 5; i < 8; ++i)
+			strs.push_back(std::to_string(i));
+		strs.push_back(ezSTL::move(strs[1]));
+		for (int i = 9; i < 16; ++i)
+			strs.push_back(std::to_string(i));
+		strs.emplace_back(strs[2]);
+		std::cout << "size: " << strs.size() << " ; capacity: " << strs.capacity() << std::endl << "vector: ";
+		for (auto ite = strs.begin(); ite != strs.end(); ++ite)
+			std::cout << "\"" << *ite << "\" ";
+		std::cout << std::endl;
+		std::cout << "copies are right : " << (strs[4] == "0" && strs[8] == "1" && strs[16] == "2") << std::endl;
 		test_info("vector   clear");
 		v.clear();
 		print_vector(v);
@@ -275,10 +476,613 @@ namespace ezSTL {
 		test_info("list   clear");
 		l.clear();
 		print_list(l);
+		test_info("list   sort");
+		for (int i = 0; i < 8; ++i)
+			l.push_back(rand() % 10);
+		list<int> m;
+		for (int i = 0; i < 6; ++i)
+			m.push_back(rand() % 10);
+		print_list(l);
+		l.sort();
+		m.sort();
+		print_list(l);
+		print_list(m);
+		test_info("list   merge");
+		l.merge(m);
+		print_list(l);
+		print_list(m);
+		test_info("list   unique");
+		l.unique();
+		print_list(l);
+		test_info("list   reverse");
+		l.reverse();
+		print_list(l);
+		test_info("list   remove_if (odd numbers)");
+		l.remove_if([](int x) { return x % 2 != 0; });
+		print_list(l);
+		test_info("list   splice");
+		for (int i = 0; i < 3; ++i)
+			m.push_back(-i);
+		std::cout << "splice the whole list before the second element" << std::endl;
+		l.splice(l.begin() + 1, m);
+		print_list(l);
+		print_list(m);
+		std::cout << "splice the first element to the end" << std::endl;
+		l.splice(l.end(), l, l.begin());
+		print_list(l);
+		std::cout << "splice the last three elements to another list" << std::endl;
+		m.splice(m.begin(), l, l.end() - 3, l.end());
+		print_list(l);
+		print_list(m);
 		finish_info("list");
 		continue_next_test();
 	}
 
+	void test::test_list_efficiency() {
+		const int max_number = 1000000;
+		const int batch_size = 50000;
+		std::string cmpstl = "SGI STL";
+		//std::string cmpstl = "PJ STL";
+		std::default_random_engine e((unsigned)time(0));
+		std::uniform_int_distribution<int> u;
+		std::vector<int> data;
+		for (int i = 0; i < max_number; ++i)
+			data.push_back(u(e));
+		start_info("efficiency of list (sort, merge batches, move to front)");
+		test_info("sort");
+		{
+			list<int> l;
+			for (int i = 0; i < max_number; ++i)
+				l.push_back(data[i]);
+			begin_timer();
+			l.sort();
+			end_timer("ezSTL::list", max_number);
+		}
+		{
+			std::list<int> l(data.begin(), data.end());
+			begin_timer();
+			l.sort();
+			end_timer(cmpstl + "::list", max_number);
+		}
+		// merge sorted batches into one list
+		test_info("merge sorted batches of " + std::to_string(batch_size));
+		{
+			list<int> l;
+			unsigned long long checksum = 0;
+			begin_timer();
+			for (int i = 0; i < max_number; i += batch_size) {
+				list<int> batch;
+				for (int j = i; j < i + batch_size; ++j)
+					batch.push_back(data[j]);
+				batch.sort();
+				l.merge(batch);
+			}
+			end_timer("ezSTL::list", max_number);
+			for (auto ite = l.begin(); ite != l.end(); ++ite)
+				checksum = checksum * 31 + *ite;
+			std::cout << "checksum : " << checksum << std::endl;
+		}
+		{
+			std::list<int> l;
+			unsigned long long checksum = 0;
+			begin_timer();
+			for (int i = 0; i < max_number; i += batch_size) {
+				std::list<int> batch(data.begin() + i, data.begin() + i + batch_size);
+				batch.sort();
+				l.merge(batch);
+			}
+			end_timer(cmpstl + "::list", max_number);
+			for (auto ite = l.begin(); ite != l.end(); ++ite)
+				checksum = checksum * 31 + *ite;
+			std::cout << "checksum : " << checksum << std::endl;
+		}
+		// LRU like access: move the touched element to the front, by relinking or by copying
+		test_info("move to front");
+		{
+			const int lru_size = 1000;
+			list<int> l;
+			vector<list<int>::iterator> position;
+			for (int i = 0; i < lru_size; ++i) {
+				l.push_back(i);
+				position.push_back(l.end() - 1);
+			}
+			begin_timer();
+			for (int i = 0; i < max_number * 10; ++i) {
+				int x = data[i % max_number] % lru_size;
+				l.splice(l.begin(), l, position[x]);
+			}
+			end_timer("ezSTL::list splice", max_number * 10);
+			std::cout << "front : " << l.front() << std::endl;
+		}
+		{
+			const int lru_size = 1000;
+			list<int> l;
+			vector<list<int>::iterator> position;
+			for (int i = 0; i < lru_size; ++i) {
+				l.push_back(i);
+				position.push_back(l.end() - 1);
+			}
+			begin_timer();
+			for (int i = 0; i < max_number * 10; ++i) {
+				int x = data[i % max_number] % lru_size;
+				l.erase(position[x]);
+				l.push_front(x);
+				position[x] = l.begin();
+			}
+			end_timer("ezSTL::list erase and push_front", max_number * 10);
+			std::cout << "front : " << l.front() << std::endl;
+		}
+		finish_info("efficiency of list");
+		continue_next_test();
+	}
+
+	template<typename T>
+	void test::print_forward_list(forward_list<T>& l) {
+		std::cout << "size: " << distance(l.begin(), l.end());
+		std::cout << " ; empty: " << l.empty();
+		if (!l.empty()) std::cout << " ; front: " << l.front();
+		std::cout << std::endl << "forward_list: ";
+		for (auto ite = l.begin(); ite != l.end(); ++ite)
+			std::cout << *ite << " ";
+		std::cout << std::endl;
+	}
+
+	void test::test_forward_list() {
+		srand((unsigned int)time(NULL));
+		start_info("forward_list");
+		forward_list<int> l;
+		print_forward_list(l);
+		test_info("forward_list   push_front");
+		for (int i = 0; i < 6; ++i) {
+			l.push_front(rand() % 10);
+			print_forward_list(l);
+		}
+		test_info("forward_list   pop_front");
+		l.pop_front();
+		print_forward_list(l);
+		test_info("forward_list   insert_after");
+		for (int i = 0; i < 3; ++i) {
+			int randn = rand() % 5;
+			std::cout << "insert number " << -randn << " after index:" << randn;
+			auto res_ite = l.insert_after(l.begin() + randn, -randn);
+			std::cout << "  ;  inserted number(obtained by return iterator): " << *res_ite << std::endl;
+			print_forward_list(l);
+		}
+		test_info("forward_list   erase_after");
+		for (int i = 0; i < 2; ++i) {
+			int randn = rand() % 5;
+			std::cout << "erase after index:" << randn << std::endl;
+			l.erase_after(l.begin() + randn);
+			print_forward_list(l);
+		}
+		test_info("forward_list   sort");
+		l.sort();
+		print_forward_list(l);
+		test_info("forward_list   merge");
+		forward_list<int> m;
+		for (int i = 0; i < 4; ++i)
+			m.push_front(rand() % 10);
+		m.sort();
+		print_forward_list(m);
+		l.merge(m);
+		print_forward_list(l);
+		print_forward_list(m);
+		test_info("forward_list   reverse");
+		l.reverse();
+		print_forward_list(l);
+		test_info("forward_list   remove_if (odd numbers)");
+		l.remove_if([](int x) { return x % 2 != 0; });
+		print_forward_list(l);
+		test_info("forward_list   splice_after");
+		for (int i = 0; i < 3; ++i)
+			m.push_front(-i);
+		std::cout << "splice the whole list after the first element" << std::endl;
+		l.splice_after(l.begin(), m);
+		print_forward_list(l);
+		print_forward_list(m);
+		std::cout << "splice the second element to the front of another list" << std::endl;
+		m.splice_after(m.before_begin(), l, l.begin());
+		print_forward_list(l);
+		print_forward_list(m);
+		test_info("forward_list   copy constructor");
+		forward_list<int> w(l);
+		print_forward_list(w);
+		test_info("forward_list   move constructor");
+		forward_list<int> u(ezSTL::move(w));
+		print_forward_list(u);
+		print_forward_list(w);
+		test_info("forward_list   clear");
+		l.clear();
+		print_forward_list(l);
+		finish_info("forward_list");
+		continue_next_test();
+	}
+
+	void test::test_forward_list_efficiency() {
+		const int max_number = 1000000;
+		const int hash_number = 5000000;
+		std::string cmpstl = "SGI STL";
+		//std::string cmpstl = "PJ STL";
+		std::default_random_engine e((unsigned)time(0));
+		std::uniform_int_distribution<int> u;
+		std::vector<int> data;
+		for (int i = 0; i < hash_number; ++i)
+			data.push_back(u(e));
+		start_info("efficiency of forward_list");
+		test_info("memory per element");
+		std::cout << "list<int> node : " << sizeof(list<int>::list_node) << " bytes ; forward_list<int> node : "
+			<< sizeof(forward_list<int>::list_node) << " bytes" << std::endl;
+		std::cout << "list<pair<int, int>> node : " << sizeof(list<pair<int, int>>::list_node) << " bytes ; forward_list<pair<int, int>> node : "
+			<< sizeof(forward_list<pair<int, int>>::list_node) << " bytes" << std::endl;
+		// an empty bucket used to be a pointer to a heap allocated list, a non empty one also held the list and its header node
+		std::cout << "hash bucket with list : " << sizeof(list<pair<int, int>>*) << " bytes, plus "
+			<< sizeof(list<pair<int, int>>) + sizeof(list<pair<int, int>>::list_node) << " bytes when not empty ; with forward_list : "
+			<< sizeof(forward_list<pair<int, int>>) << " bytes" << std::endl;
+		test_info("push_front and sort");
+		{
+			list<int> l;
+			begin_timer();
+			for (int i = 0; i < max_number; ++i)
+				l.push_front(data[i]);
+			l.sort();
+			end_timer("ezSTL::list", max_number);
+		}
+		{
+			forward_list<int> l;
+			begin_timer();
+			for (int i = 0; i < max_number; ++i)
+				l.push_front(data[i]);
+			l.sort();
+			end_timer("ezSTL::forward_list", max_number);
+		}
+		{
+			std::forward_list<int> l;
+			begin_timer();
+			for (int i = 0; i < max_number; ++i)
+				l.push_front(data[i]);
+			l.sort();
+			end_timer(cmpstl + "::forward_list", max_number);
+		}
+		test_info("unordered_map (forward_list buckets) insert and find");
+		{
+			unordered_map<int, int> um;
+			begin_timer();
+			for (int i = 0; i < hash_number; ++i)
+				um.insert(make_pair(data[i], i));
+			end_timer("ezSTL::unordered_map inserting", hash_number);
+			long long sum = 0;
+			begin_timer();
+			for (int i = 0; i < hash_number; ++i)
+				sum += *um.find(data[i]);
+			end_timer("ezSTL::unordered_map finding", hash_number);
+			std::cout << "size : " << um.size() << " ; checksum : " << sum << std::endl;
+		}
+		{
+			std::unordered_map<int, int> um;
+			begin_timer();
+			for (int i = 0; i < hash_number; ++i)
+				um[data[i]] = i;
+			end_timer(cmpstl + "::unordered_map inserting", hash_number);
+			long long sum = 0;
+			begin_timer();
+			for (int i = 0; i < hash_number; ++i)
+				sum += um.find(data[i])->second;
+			end_timer(cmpstl + "::unordered_map finding", hash_number);
+			std::cout << "size : " << um.size() << " ; checksum : " << sum << std::endl;
+		}
+		finish_info("efficiency of forward_list");
+		continue_next_test();
+	}
+
+	template<typename T, unsigned int NodeCapacity>
+	void test::print_unrolled_list(unrolled_list<T, NodeCapacity>& l) {
+		std::cout << "size: " << l.size();
+		std::cout << " ; nodes: " << l.node_count();
+		std::cout << " ; empty: " << l.empty();
+		if (!l.empty()) std::cout << " ; front: " << l.front();
+		if (!l.empty()) std::cout << " ; back: " << l.back();
+		std::cout << std::endl << "unrolled_list: ";
+		for (auto ite = l.begin(); ite != l.end(); ++ite)
+			std::cout << *ite << ((ite + 1).index == 0 ? " | " : " ");
+		std::cout << std::endl;
+	}
+
+	void test::test_unrolled_list() {
+		srand((unsigned int)time(NULL));
+		start_info("unrolled_list (4 elements per node)");
+		unrolled_list<int, 4> l;
+		print_unrolled_list(l);
+		test_info("unrolled_list   push_back");
+		for (int i = 0; i < 6; ++i) {
+			l.push_back(rand() % 100);
+			print_unrolled_list(l);
+		}
+		test_info("unrolled_list   push_front");
+		for (int i = 0; i < 3; ++i) {
+			l.push_front(rand() % 100);
+			print_unrolled_list(l);
+		}
+		test_info("unrolled_list   insert");
+		for (int i = 0; i < 5; ++i) {
+			int randn = rand() % l.size();
+			std::cout << "insert number " << -randn << " in index:" << randn;
+			auto res_ite = l.insert(l.begin() + randn, -randn);
+			std::cout << "  ;  inserted number(obtained by return iterator): " << *res_ite << std::endl;
+			print_unrolled_list(l);
+		}
+		test_info("unrolled_list   erase");
+		for (int i = 0; i < 8; ++i) {
+			int randn = rand() % l.size();
+			std::cout << "erase in index:" << randn;
+			auto res_ite = l.erase(l.begin() + randn);
+			if (res_ite != l.end())
+				std::cout << "  ;  number obtained by return iterator: " << *res_ite;
+			std::cout << std::endl;
+			print_unrolled_list(l);
+		}
+		test_info("unrolled_list   pop_back and pop_front");
+		l.pop_back();
+		l.pop_front();
+		print_unrolled_list(l);
+		test_info("unrolled_list   copy constructor");
+		unrolled_list<int, 4> w(l);
+		print_unrolled_list(w);
+		test_info("unrolled_list   move constructor");
+		unrolled_list<int, 4> u(ezSTL::move(w));
+		print_unrolled_list(u);
+		print_unrolled_list(w);
+		test_info("unrolled_list   clear");
+		l.clear();
+		print_unrolled_list(l);
+		finish_info("unrolled_list");
+		continue_next_test();
+	}
+
+	void test::test_unrolled_list_efficiency() {
+		const int max_number = 10000000;
+		const int insert_number = 1000000;
+		start_info("efficiency of unrolled_list compared with list");
+		test_info("push_back and iterate");
+		{
+			list<int> l;
+			begin_timer();
+			for (int i = 0; i < max_number; ++i)
+				l.push_back(i);
+			end_timer("ezSTL::list push_back", max_number);
+			long long sum = 0;
+			begin_timer();
+			for (int k = 0; k < 10; ++k)
+				for (auto ite = l.begin(); ite != l.end(); ++ite)
+					sum += *ite;
+			end_timer("ezSTL::list iterate 10 times", max_number);
+			std::cout << "sum : " << sum << std::endl;
+			std::cout << "bytes per element : " << sizeof(list<int>::list_node) << std::endl;
+		}
+		{
+			unrolled_list<int> l;
+			begin_timer();
+			for (int i = 0; i < max_number; ++i)
+				l.push_back(i);
+			end_timer("ezSTL::unrolled_list push_back", max_number);
+			long long sum = 0;
+			begin_timer();
+			for (int k = 0; k < 10; ++k)
+				for (auto ite = l.begin(); ite != l.end(); ++ite)
+					sum += *ite;
+			end_timer("ezSTL::unrolled_list iterate 10 times", max_number);
+			std::cout << "sum : " << sum << std::endl;
+			std::cout << "bytes per element : " << (double)l.node_count() * sizeof(unrolled_list<int>::list_node) / l.size() << std::endl;
+		}
+		// keep an iterator in the middle, insert before it and step it forward now and then
+		test_info("insert in the middle");
+		{
+			list<int> l;
+			for (int i = 0; i < insert_number; ++i)
+				l.push_back(i);
+			auto pos = l.begin() + insert_number / 2;
+			begin_timer();
+			for (int i = 0; i < insert_number; ++i) {
+				pos = l.insert(pos, i);
+				if (i % 3 == 0)
+					++pos;
+			}
+			end_timer("ezSTL::list insert", insert_number);
+			long long sum = 0;
+			for (auto ite = l.begin(); ite != l.end(); ++ite)
+				sum = sum * 31 + *ite;
+			std::cout << "checksum : " << sum << std::endl;
+		}
+		{
+			unrolled_list<int> l;
+			for (int i = 0; i < insert_number; ++i)
+				l.push_back(i);
+			auto pos = l.begin() + insert_number / 2;
+			begin_timer();
+			for (int i = 0; i < insert_number; ++i) {
+				pos = l.insert(pos, i);
+				if (i % 3 == 0)
+					++pos;
+			}
+			end_timer("ezSTL::unrolled_list insert", insert_number);
+			long long sum = 0;
+			for (auto ite = l.begin(); ite != l.end(); ++ite)
+				sum = sum * 31 + *ite;
+			std::cout << "checksum : " << sum << std::endl;
+			std::cout << "bytes per element : " << (double)l.node_count() * sizeof(unrolled_list<int>::list_node) / l.size() << std::endl;
+		}
+		finish_info("efficiency of unrolled_list");
+		continue_next_test();
+	}
+
+	void test::print_sessions(intrusive_rbtree<__test_session, &__test_session::tree_hook>& tree,
+		intrusive_list<__test_session, &__test_session::lru_hook>& lru) {
+		std::cout << "tree size: " << tree.size() << " ; ids: ";
+		for (auto ite = tree.begin(); ite != tree.end(); ++ite)
+			std::cout << ite->id << " ";
+		std::cout << std::endl;
+		if (tree.isRBTree())
+			std::cout << "It is exactly an rbtree!" << std::endl;
+		else
+			std::cout << "It is not an rbtree." << std::endl;
+		std::cout << "lru size: " << lru.size() << " ; ids (most recent first): ";
+		for (auto ite = lru.begin(); ite != lru.end(); ++ite)
+			std::cout << ite->id << " ";
+		std::cout << std::endl;
+	}
+
+	void test::test_intrusive_containers() {
+		const int session_number = 8;
+		srand((unsigned int)time(NULL));
+		start_info("intrusive_list and intrusive_rbtree");
+		vector<__test_session> sessions;
+		sessions.reserve(session_number);
+		for (int i = 0; i < session_number; ++i) {
+			__test_session s;
+			s.id = rand() % 100;
+			s.bytes = 0;
+			sessions.push_back(s);
+		}
+		intrusive_rbtree<__test_session, &__test_session::tree_hook> tree;
+		intrusive_list<__test_session, &__test_session::lru_hook> lru;
+		test_info("intrusive_rbtree   insert, intrusive_list   push_front");
+		for (int i = 0; i < session_number; ++i) {
+			std::cout << "open session " << sessions[i].id;
+			if (tree.insert(sessions[i]).second) {
+				lru.push_front(sessions[i]);
+				std::cout << std::endl;
+			}
+			else
+				std::cout << " : id already in use" << std::endl;
+		}
+		print_sessions(tree, lru);
+		test_info("intrusive_rbtree   find, intrusive_list   move to front");
+		for (int i = 0; i < 3; ++i) {
+			__test_session& s = sessions[rand() % session_number];
+			auto ite = tree.find(s);
+			std::cout << "touch session " << s.id << " ; found: " << (ite != tree.end()) << std::endl;
+			if (ite != tree.end()) {
+				lru.erase(*ite);
+				lru.push_front(*ite);
+			}
+		}
+		print_sessions(tree, lru);
+		test_info("intrusive_rbtree   erase, the session stays in the lru list");
+		for (int i = 0; i < 3; ++i) {
+			__test_session& s = sessions[rand() % session_number];
+			if (s.tree_hook.is_linked()) {
+				std::cout << "erase session " << s.id << " from tree" << std::endl;
+				tree.erase(s);
+			}
+		}
+		print_sessions(tree, lru);
+		test_info("intrusive_list   pop_back (evict the least recent session)");
+		__test_session& evicted = lru.back();
+		lru.pop_back();
+		if (evicted.tree_hook.is_linked())
+			tree.erase(evicted);
+		std::cout << "evict session " << evicted.id << std::endl;
+		print_sessions(tree, lru);
+		test_info("intrusive_rbtree and intrusive_list   clear");
+		tree.clear();
+		lru.clear();
+		print_sessions(tree, lru);
+		finish_info("intrusive_list and intrusive_rbtree");
+		continue_next_test();
+	}
+
+	void test::test_intrusive_containers_efficiency() {
+		const int max_number = 10000000;
+		const int session_number = 1000000;
+		std::default_random_engine e((unsigned)time(0));
+		std::vector<unsigned> data;
+		for (int i = 0; i < max_number; ++i)
+			data.push_back(e());
+		start_info("efficiency of intrusive containers (session churn: open, touch, close)");
+		// each step picks a session slot: a free slot opens a session with a new id,
+		// a used slot is either touched (find by id, move to the front of the lru list) or closed
+		{
+			vector<__test_session> sessions(session_number);
+			intrusive_rbtree<__test_session, &__test_session::tree_hook> tree;
+			intrusive_list<__test_session, &__test_session::lru_hook> lru;
+			unsigned int next_id = 0;
+			unsigned long long checksum = 0;
+			__test_session probe;
+			begin_timer();
+			for (int i = 0; i < max_number; ++i) {
+				__test_session& s = sessions[data[i] % session_number];
+				if (!s.tree_hook.is_linked()) {
+					// scramble the ids so they do not always go to the right end of the tree
+					s.id = ++next_id * 2654435761u;
+					s.bytes = 0;
+					tree.insert(s);
+					lru.push_front(s);
+				}
+				else if (data[i] & 0x40000000u) {
+					probe.id = s.id;
+					__test_session& found = *tree.find(probe);
+					found.bytes += data[i] & 0xff;
+					lru.erase(found);
+					lru.push_front(found);
+				}
+				else {
+					checksum += s.bytes;
+					tree.erase(s);
+					lru.erase(s);
+				}
+			}
+			end_timer("ezSTL::intrusive_rbtree + intrusive_list", max_number);
+			std::cout << "open sessions : " << tree.size() << " ; checksum : " << checksum << std::endl;
+		}
+		{
+			// the same sessions kept by value in a set, the lru list holds slot numbers
+			class session_record {
+			public:
+				unsigned int id;
+				unsigned long long bytes;
+				bool operator<(const session_record& s) const {
+					return id < s.id;
+				}
+			};
+			vector<unsigned int> ids(session_number);
+			vector<bool> open(session_number);
+			vector<list<unsigned int>::iterator> position(session_number);
+			set<session_record> tree;
+			list<unsigned int> lru;
+			unsigned int next_id = 0;
+			unsigned long long checksum = 0;
+			session_record record;
+			begin_timer();
+			for (int i = 0; i < max_number; ++i) {
+				unsigned int slot = data[i] % session_number;
+				if (!open[slot]) {
+					record.id = ids[slot] = ++next_id * 2654435761u;
+					record.bytes = 0;
+					tree.insert(record);
+					lru.push_front(slot);
+					position[slot] = lru.begin();
+					open[slot] = true;
+				}
+				else if (data[i] & 0x40000000u) {
+					record.id = ids[slot];
+					(*tree.find(record)).bytes += data[i] & 0xff;
+					lru.splice(lru.begin(), lru, position[slot]);
+				}
+				else {
+					record.id = ids[slot];
+					auto ite = tree.find(record);
+					checksum += (*ite).bytes;
+					tree.erase(ite);
+					lru.erase(position[slot]);
+					open[slot] = false;
+				}
+			}
+			end_timer("ezSTL::set + list", max_number);
+			std::cout << "open sessions : " << tree.size() << " ; checksum : " << checksum << std::endl;
+		}
+		finish_info("efficiency of intrusive containers");
+		continue_next_test();
+	}
+
 	template<typename T>
 	void test::print_stack(stack<T>& s) {
 		std::cout << "size: " << s.size();
@@ -334,8 +1138,8 @@ namespace ezSTL {
 		continue_next_test();
 	}
 
-	template<typename T, typename Compare>
-	void test::print_priority_queue(priority_queue<T, Compare>& pq) {
+	template<typename T, typename Compare, unsigned int Arity>
+	void test::print_priority_queue(priority_queue<T, Compare, Arity>& pq) {
 		std::cout << "size: " << pq.size();
 		std::cout << " ; empty: " << pq.empty();
 		if (!pq.empty()) std::cout << " ; top: " << pq.top();
@@ -358,12 +1162,98 @@ namespace ezSTL {
 			pq.pop();
 			print_priority_queue(pq);
 		}
+		test_info("priority_queue   range constructor and emplace (4-ary heap)");
+		{
+			vector<int> v;
+			for (int i = 0; i < max_iteration; ++i)
+				v.push_back(rand() % 100);
+			print_vector(v);
+			priority_queue<int, greater<int>, 4> pq4(v.begin(), v.end());
+			pq4.emplace(rand() % 100);
+			print_priority_queue(pq4);
+			std::cout << "pop all: ";
+			while (!pq4.empty()) {
+				std::cout << pq4.top() << " ";
+				pq4.pop();
+			}
+			std::cout << std::endl;
+		}
 		finish_info("priority_queue");
 		continue_next_test();
 	}
 
-	template<typename T, typename Compare>
-	void test::print_rbtree(rbtree<T, Compare>& rbt) {
+	// push every value of data, and pop once after every two pushes, then pop all
+	template<typename PriorityQueue>
+	void test::priority_queue_push_pop(PriorityQueue& pq, std::string name, const std::vector<unsigned>& data) {
+		unsigned long long checksum = 0;
+		begin_timer();
+		for (unsigned int i = 0; i < data.size(); ++i) {
+			pq.push(data[i]);
+			if (i % 2 == 1) {
+				checksum += pq.top();
+				pq.pop();
+			}
+		}
+		while (!pq.empty()) {
+			checksum += pq.top();
+			pq.pop();
+		}
+		end_timer(name + " pushing and popping", data.size());
+		std::cout << "checksum : " << checksum << std::endl;
+	}
+
+	void test::test_priority_queue_efficiency() {
+		const int max_number = 10000000;
+		std::default_random_engine e((unsigned)time(0));
+		std::string cmpstl = "SGI STL";
+		//std::string cmpstl = "PJ STL";
+		std::vector<unsigned> data;
+		for (int i = 0; i < max_number; ++i)
+			data.push_back(e());
+		start_info("efficiency of priority_queue");
+		test_info("priority_queue   push and pop");
+		{
+			ezSTL::priority_queue<unsigned> pq;
+			priority_queue_push_pop(pq, "ezSTL::priority_queue(binary)", data);
+		}
+		{
+			ezSTL::priority_queue<unsigned, less<unsigned>, 4> pq;
+			priority_queue_push_pop(pq, "ezSTL::priority_queue(4-ary)", data);
+		}
+		{
+			ezSTL::priority_queue<unsigned, less<unsigned>, 8> pq;
+			priority_queue_push_pop(pq, "ezSTL::priority_queue(8-ary)", data);
+		}
+		{
+			// std::priority_queue is a max heap with std::less
+			std::priority_queue<unsigned, std::vector<unsigned>, std::greater<unsigned>> pq;
+			priority_queue_push_pop(pq, cmpstl + "::priority_queue", data);
+		}
+		test_info("priority_queue   build from range");
+		{
+			begin_timer();
+			ezSTL::priority_queue<unsigned> pq(data.begin(), data.end());
+			end_timer("ezSTL::priority_queue range constructor", max_number);
+		}
+		{
+			begin_timer();
+			ezSTL::priority_queue<unsigned> pq;
+			pq.reserve(max_number);
+			for (int i = 0; i < max_number; ++i)
+				pq.push(data[i]);
+			end_timer("ezSTL::priority_queue pushing one by one", max_number);
+		}
+		{
+			begin_timer();
+			std::priority_queue<unsigned, std::vector<unsigned>, std::greater<unsigned>> pq(std::greater<unsigned>(), data);
+			end_timer(cmpstl + "::priority_queue range constructor", max_number);
+		}
+		finish_info("efficiency of priority_queue");
+		continue_next_test();
+	}
+
+	template<typename T, typename Compare, typename Alloc, typename Augment>
+	void test::print_rbtree(rbtree<T, Compare, Alloc, Augment>& rbt) {
 		std::cout << "size: " << rbt.size();
 		std::cout << " ; empty: " << rbt.empty();
 		std::cout << std::endl << "rbtree: ";
@@ -408,12 +1298,46 @@ namespace ezSTL {
 		test_info("rbtree   clear");
 		rbt.clear();
 		print_rbtree(rbt);
+		test_info("rbtree   order statistics under insert and erase");
+		{
+			rbtree<int, less<int>, allocator<int>, rbtree_order_statistics> counted;
+			for (int i = 0; i < max_iteration * 3; ++i)
+				counted.insert(rand() % 100);
+			for (int i = 0; i < max_iteration * 3; ++i) {
+				auto ite = counted.find(rand() % 100);
+				if (ite != counted.end())
+					counted.erase(ite);
+			}
+			print_rbtree(counted);
+			std::cout << "nth: ";
+			for (unsigned int k = 0; k < counted.size(); ++k)
+				std::cout << *counted.nth(k) << " ";
+			std::cout << std::endl << "rank of 50: " << counted.rank(50)
+				<< " ; values in [25, 75): " << counted.count_range(25, 75) << std::endl;
+		}
+		test_info("rbtree   threaded iteration under insert, erase and erase of a range");
+		{
+			rbtree<int, less<int>, allocator<int>, rbtree_threaded> threaded;
+			for (int i = 0; i < max_iteration * 3; ++i)
+				threaded.insert(rand() % 100);
+			for (int i = 0; i < max_iteration; ++i) {
+				auto ite = threaded.find(rand() % 100);
+				if (ite != threaded.end())
+					threaded.erase(ite);
+			}
+			threaded.erase(threaded.lower_bound(20), threaded.lower_bound(40));
+			print_rbtree(threaded);
+			std::cout << "in reverse order: ";
+			for (auto ite = threaded.end(); ite != threaded.begin();)
+				std::cout << *--ite << " ";
+			std::cout << std::endl;
+		}
 		finish_info("rbtree");
 		continue_next_test();
 	}
 
-	template<typename T, typename Compare>
-	void test::print_set(set<T, Compare>& s) {
+	template<typename T, typename Compare, typename Alloc, typename Augment>
+	void test::print_set(set<T, Compare, Alloc, Augment>& s) {
 		std::cout << "size: " << s.size();
 		std::cout << " ; empty: " << s.empty();
 		std::cout << std::endl << "set: ";
@@ -435,18 +1359,121 @@ namespace ezSTL {
 			auto ite = s.find(number);
 			if (ite == s.end()) std::cout << "not exists" << std::endl;
 			else std::cout << "already exist : " << *ite << " (obtained by find iterator)" << std::endl;
-			s.insert(number);
+			auto res = s.insert(number);
+			std::cout << "inserted : " << res.second << " ; value obtained by return iterator : " << *res.first << std::endl;
 			print_set(s);
 		}
-		test_info("set   erase");
-		for (int i = 0; i < max_iteration * 20; ++i) {
-			int number = rand() % 100;
-			auto ite = s.find(number);
-			if (ite != s.end()) {
-				std::cout << "to remove : " << number << std::endl;
-				s.erase(ite);
-				print_set(s);
-			}
+		test_info("set   insert with hint and emplace");
+		for (int i = 0; i < 3; ++i) {
+			int number = 100 + rand() % 10;
+			std::cout << "to insert " << number << " with hint end()" << std::endl;
+			s.insert(s.end(), number);
+			number = rand() % 100;
+			std::cout << "to emplace " << number << std::endl;
+			s.emplace(number);
+			print_set(s);
+		}
+		test_info("set   construct from a range and insert a range");
+		{
+			vector<int> v;
+			for (int i = 0; i < max_iteration; ++i)
+				v.push_back(i / 2);
+			set<int> sorted_set(v.begin(), v.end());
+			std::cout << "from sorted values with duplicates: ";
+			print_set(sorted_set);
+			v.clear();
+			for (int i = 0; i < max_iteration; ++i)
+				v.push_back(rand() % 100);
+			set<int> unsorted_set(v.begin(), v.end());
+			std::cout << "from unsorted values: ";
+			print_set(unsorted_set);
+			s.insert(v.begin(), v.end());
+			std::cout << "inserted into the present set: ";
+			print_set(s);
+		}
+		test_info("set   union, intersection and difference");
+		{
+			set<int> a, b;
+			for (int i = 0; i < max_iteration; ++i) {
+				a.insert(rand() % 30);
+				b.insert(rand() % 30);
+			}
+			set<int> a_copy(a.begin(), a.end()), b_copy(b.begin(), b.end());
+			std::cout << "a: ";
+			print_set(a);
+			std::cout << "b: ";
+			print_set(b);
+			a.set_union(b);
+			std::cout << "a | b: ";
+			print_set(a);
+			a.clear();
+			a.insert(a_copy.begin(), a_copy.end());
+			b.insert(b_copy.begin(), b_copy.end());
+			a.set_intersection(b);
+			std::cout << "a & b: ";
+			print_set(a);
+			b.insert(b_copy.begin(), b_copy.end());
+			a_copy.set_difference(b);
+			std::cout << "a - b: ";
+			print_set(a_copy);
+			std::cout << "b is left empty: " << b.empty() << std::endl;
+		}
+		test_info("set   nth, rank and count_range");
+		{
+			set<int, less<int>, allocator<int>, rbtree_order_statistics> scores;
+			for (int i = 0; i < max_iteration; ++i)
+				scores.insert(rand() % 100);
+			print_set(scores);
+			std::cout << "minimum: " << *scores.nth(0) << " ; median: " << *scores.nth(scores.size() / 2)
+				<< " ; maximum: " << *scores.nth(scores.size() - 1) << std::endl;
+			int number = rand() % 100;
+			std::cout << "values less than " << number << ": " << scores.rank(number)
+				<< " ; values in [" << number << ", " << number + 20 << "): " << scores.count_range(number, number + 20) << std::endl;
+		}
+		test_info("set   lower_bound, upper_bound, range scan and erase a range");
+		{
+			int lo = rand() % 50;
+			int hi = lo + 30;
+			print_set(s);
+			auto range = s.equal_range(lo);
+			std::cout << "equal_range of " << lo << " holds " << ezSTL::distance(range.first, range.second) << " value(s)" << std::endl;
+			std::cout << "values in [" << lo << ", " << hi << ") by iterators: ";
+			for (auto ite = s.lower_bound(lo); ite != s.lower_bound(hi); ++ite)
+				std::cout << *ite << " ";
+			std::cout << std::endl << "values in [" << lo << ", " << hi << ") by for_each_in_range: ";
+			s.for_each_in_range(lo, hi, [](int v) { std::cout << v << " "; });
+			auto ite = s.upper_bound(hi);
+			std::cout << std::endl << "first value greater than " << hi << ": ";
+			if (ite == s.end()) std::cout << "none" << std::endl;
+			else std::cout << *ite << std::endl;
+			std::cout << "to remove values in [" << lo << ", " << hi << ")" << std::endl;
+			s.erase(s.lower_bound(lo), s.lower_bound(hi));
+			print_set(s);
+		}
+		test_info("set   string values ordered by a three-way comparator");
+		{
+			set<std::string, three_way_compare<>> names;
+			const char* words[] = { "pear", "apple", "fig", "plum", "apple", "kiwi", "fig" };
+			for (const char* word : words)
+				std::cout << "insert " << word << " : " << names.insert(word).second << std::endl;
+			print_set(names);
+			std::cout << "find(\"plum\") : " << (names.find("plum") != names.end()) << " ; find(\"lime\") : "
+				<< (names.find("lime") != names.end()) << " ; lower_bound(\"g\") : " << *names.lower_bound("g") << std::endl;
+			auto nh = names.extract("fig");
+			nh.value() = "grape";
+			names.insert(ezSTL::move(nh));
+			std::cout << "after renaming the node of fig to grape: ";
+			print_set(names);
+		}
+		test_info("set   erase");
+		for (int i = 0; i < max_iteration * 20; ++i) {
+			int number = rand() % 100;
+			auto ite = s.find(number);
+			if (ite != s.end()) {
+				std::cout << "to remove : " << number << std::endl;
+				s.erase(ite);
+				print_set(s);
+			}
 		}
 		test_info("set   clear");
 		s.clear();
@@ -455,8 +1482,8 @@ namespace ezSTL {
 		continue_next_test();
 	}
 
-	template<typename K, typename V>
-	void test::print_map(map<K, V>& m) {
+	template<typename K, typename V, typename Compare, typename Alloc, typename Augment>
+	void test::print_map(map<K, V, Compare, Alloc, Augment>& m) {
 		std::cout << "size: " << m.size();
 		std::cout << " ; empty: " << m.empty();
 		std::cout << std::endl << "map: ";
@@ -493,7 +1520,103 @@ namespace ezSTL {
 				print_map(m);
 			}
 		}
+		test_info("map   range scan and erase a range");
+		{
+			int lo = rand() % 50;
+			int hi = lo + 40;
+			std::cout << "pairs with a key in [" << lo << ", " << hi << "): ";
+			m.for_each_in_range(lo, hi, [](pair<int, int>& p) { std::cout << p.first << ":" << p.second << " "; });
+			std::cout << std::endl << "to remove keys in [" << lo << ", " << hi << "]" << std::endl;
+			m.erase(m.lower_bound(lo), m.upper_bound(hi));
+			print_map(m);
+		}
+		test_info("map   merge a batch of updates");
+		{
+			map<int, int> batch;
+			for (int i = 0; i < max_iteration / 2; ++i)
+				batch.insert(make_pair(rand() % 100, -1));
+			std::cout << "batch: ";
+			print_map(batch);
+			m.merge(batch);
+			print_map(m);
+			std::cout << "batch is left empty: " << batch.empty() << std::endl;
+		}
+		test_info("map   operator[], at, count and contains");
+		{
+			int key = rand() % 100;
+			std::cout << "count(" << key << ") : " << m.count(key) << " ; contains(" << key << ") : " << m.contains(key);
+			m[key] += 1000;
+			std::cout << " ; after m[" << key << "] += 1000, at(" << key << ") : " << m.at(key) << std::endl;
+			try {
+				m.at(-1);
+				std::cout << "at(-1) found a missing key" << std::endl;
+			}
+			catch (const std::out_of_range& e) {
+				std::cout << "at(-1) throws: " << e.what() << std::endl;
+			}
+			print_map(m);
+		}
+		test_info("map   find string keys by const char* with less<>");
+		{
+			map<std::string, int, less<>> words;
+			const char* names[] = { "red", "green", "blue" };
+			for (int i = 0; i < 3; ++i)
+				words[names[i]] = i;
+			std::cout << "find(\"green\") : " << words.find("green")->second;
+			std::cout << " ; contains(\"black\") : " << words.contains("black");
+			std::cout << " ; at(\"blue\") : " << words.at("blue") << std::endl;
+		}
+		test_info("map   move pairs to an archive map by extract and insert");
+		{
+			map<int, int> archive;
+			for (int i = 0; i < 3 && !m.empty(); ++i) {
+				auto nh = m.extract(m.begin());
+				std::cout << "extract " << nh.key() << ":" << nh.mapped() << " ; ";
+				nh.mapped() = -nh.mapped();
+				archive.insert(ezSTL::move(nh));
+			}
+			std::cout << std::endl << "archive with negated values: ";
+			print_map(archive);
+			print_map(m);
+			if (!archive.empty()) {
+				int key = archive.begin()->first;
+				archive.insert(make_pair(key + 1000, 0));
+				auto nh = archive.extract(key);
+				nh.key() = key + 1000;
+				auto result = archive.insert(ezSTL::move(nh));
+				std::cout << "insert the node of " << key << " with key " << key + 1000 << " taken: " << result.second
+					<< " ; node left in the handle: " << !nh.empty() << std::endl;
+			}
+		}
 
+		test_info("map   copy, move and swap");
+		{
+			map<int, int> snapshot(m);
+			m.insert(make_pair(100, 100));
+			std::cout << "snapshot before inserting 100: ";
+			print_map(snapshot);
+			map<int, int> moved(ezSTL::move(m));
+			std::cout << "moved to: ";
+			print_map(moved);
+			std::cout << "moved from: ";
+			print_map(m);
+			m = snapshot;
+			m.swap(moved);
+			std::cout << "assigned the snapshot and swapped: ";
+			print_map(m);
+		}
+		test_info("map   deferred_clear, the pairs are freed by a background_reclaimer");
+		{
+			background_reclaimer reclaimer;
+			map<int, int> snapshot(m);
+			snapshot.deferred_clear(reclaimer);
+			std::cout << "after deferred_clear: ";
+			print_map(snapshot);
+			snapshot.insert(make_pair(1, 1));
+			reclaimer.wait();
+			std::cout << "reused, and the reclaimer is done with " << reclaimer.pending() << " job(s) pending: ";
+			print_map(snapshot);
+		}
 		test_info("map   clear");
 		m.clear();
 		print_map(m);
@@ -501,6 +1624,485 @@ namespace ezSTL {
 		continue_next_test();
 	}
 
+	template<typename T, typename Compare, typename Alloc, unsigned int NodeBytes>
+	void test::print_btree_set(btree_set<T, Compare, Alloc, NodeBytes>& s) {
+		std::cout << "size: " << s.size();
+		std::cout << " ; empty: " << s.empty();
+		std::cout << " ; bytes used: " << s.bytes_used();
+		std::cout << std::endl << "btree_set: ";
+		for (auto ite = s.begin(); ite != s.end(); ++ite)
+			std::cout << *ite << " ";
+		std::cout << std::endl;
+	}
+
+	void test::test_btree() {
+		const int max_iteration = 10;
+		srand((unsigned int)time(NULL));
+		start_info("btree_set and btree_map");
+		// 64 byte nodes of 12 ints, small enough for the splits and merges to show up
+		btree_set<int, less<int>, allocator<int>, 64> s;
+		print_btree_set(s);
+		test_info("btree_set   find and insert");
+		for (int i = 0; i < max_iteration * 4; ++i) {
+			int number = rand() % 100;
+			// insert invalidates the iterators, find is only checked before it
+			bool found = s.find(number) != s.end();
+			auto res = s.insert(number);
+			if (!found && res.second)
+				std::cout << "inserted " << *res.first << " ; ";
+			else if (found && !res.second)
+				std::cout << "already exist " << *res.first << " ; ";
+			else
+				std::cout << "find and insert disagree on " << number << " ; ";
+		}
+		std::cout << std::endl;
+		print_btree_set(s);
+		test_info("btree_set   insert with hint and emplace");
+		for (int i = 0; i < 3; ++i) {
+			s.insert(s.end(), 100 + rand() % 10);
+			s.emplace(rand() % 100);
+		}
+		print_btree_set(s);
+		test_info("btree_set   lower_bound, upper_bound and range scan");
+		{
+			int lo = rand() % 50;
+			int hi = lo + 30;
+			std::cout << "values in [" << lo << ", " << hi << ") by iterators: ";
+			for (auto ite = s.lower_bound(lo); ite != s.lower_bound(hi); ++ite)
+				std::cout << *ite << " ";
+			std::cout << std::endl << "values in [" << lo << ", " << hi << ") by for_each_in_range: ";
+			s.for_each_in_range(lo, hi, [](int v) { std::cout << v << " "; });
+			std::cout << std::endl << "values in reverse order: ";
+			for (auto ite = s.end(); ite != s.begin();)
+				std::cout << *--ite << " ";
+			std::cout << std::endl;
+		}
+		test_info("btree_set   erase");
+		for (int i = 0; i < max_iteration * 4; ++i) {
+			auto ite = s.find(rand() % 100);
+			if (ite != s.end()) {
+				std::cout << "to remove : " << *ite << " ; ";
+				ite = s.erase(ite);
+				std::cout << "next : ";
+				if (ite == s.end()) std::cout << "end" << std::endl;
+				else std::cout << *ite << std::endl;
+			}
+		}
+		print_btree_set(s);
+		test_info("btree_set   erase a range");
+		{
+			int lo = rand() % 50;
+			std::cout << "to remove values in [" << lo << ", " << lo + 30 << ")" << std::endl;
+			s.erase(s.lower_bound(lo), s.lower_bound(lo + 30));
+			print_btree_set(s);
+		}
+		test_info("btree_map   insert, find and erase");
+		{
+			btree_map<int, int> m;
+			for (int i = 0; i < max_iteration; ++i)
+				m.insert(make_pair(rand() % 100, i));
+			std::cout << "map: ";
+			for (auto ite = m.begin(); ite != m.end(); ++ite)
+				std::cout << ite->first << ":" << ite->second << " ";
+			std::cout << std::endl;
+			int key = m.begin()->first;
+			std::cout << "find " << key << " : " << m.find(key)->second << std::endl;
+			m.erase(m.find(key));
+			std::cout << "after erasing " << key << ": ";
+			for (auto ite = m.begin(); ite != m.end(); ++ite)
+				std::cout << ite->first << ":" << ite->second << " ";
+			std::cout << std::endl;
+		}
+		test_info("btree_map   operator[], at, count and contains, lookups by const char* under less<>");
+		{
+			btree_map<std::string, int, less<>> words;
+			const char* text[] = { "red", "black", "tree", "red", "node", "black", "red" };
+			for (auto word : text)
+				++words[word];
+			for (auto ite = words.begin(); ite != words.end(); ++ite)
+				std::cout << ite->first << ":" << ite->second << " ";
+			std::cout << std::endl;
+			std::cout << "at(\"red\") : " << words.at("red") << " ; count(\"tree\") : " << words.count("tree");
+			std::cout << " ; contains(\"leaf\") : " << words.contains("leaf");
+			try {
+				words.at("leaf");
+			}
+			catch (const std::out_of_range&) {
+				std::cout << " ; at(\"leaf\") throws out_of_range";
+			}
+			std::cout << std::endl;
+		}
+		test_info("btree_set   clear");
+		s.clear();
+		print_btree_set(s);
+		finish_info("btree_set and btree_map");
+		continue_next_test();
+	}
+
+	template<typename T, typename Compare, typename Alloc>
+	void test::print_flat_set(flat_set<T, Compare, Alloc>& s) {
+		std::cout << "size: " << s.size();
+		std::cout << " ; empty: " << s.empty();
+		std::cout << " ; bytes used: " << s.bytes_used();
+		std::cout << std::endl << "flat_set: ";
+		for (auto ite = s.begin(); ite != s.end(); ++ite)
+			std::cout << *ite << " ";
+		std::cout << std::endl;
+	}
+
+	void test::test_flat_containers() {
+		const int max_iteration = 10;
+		srand((unsigned int)time(NULL));
+		start_info("flat_set and flat_map");
+		flat_set<int> s;
+		print_flat_set(s);
+		test_info("flat_set   find and insert");
+		for (int i = 0; i < max_iteration * 2; ++i) {
+			int number = rand() % 100;
+			// insert invalidates the iterators, find is only checked before it
+			bool found = s.find(number) != s.end();
+			auto res = s.insert(number);
+			if (!found && res.second)
+				std::cout << "inserted " << *res.first << " ; ";
+			else if (found && !res.second)
+				std::cout << "already exist " << *res.first << " ; ";
+			else
+				std::cout << "find and insert disagree on " << number << " ; ";
+		}
+		std::cout << std::endl;
+		print_flat_set(s);
+		test_info("flat_set   insert a range, sorted once and merged");
+		{
+			int values[max_iteration];
+			for (int i = 0; i < max_iteration; ++i)
+				values[i] = rand() % 150;
+			std::cout << "to insert: ";
+			for (int i = 0; i < max_iteration; ++i)
+				std::cout << values[i] << " ";
+			std::cout << std::endl;
+			s.insert(values, values + max_iteration);
+			print_flat_set(s);
+		}
+		test_info("flat_set   insert a range with equal values, the first of them is taken");
+		{
+			vector<pair<int, int>> pairs;
+			for (int i = 0; i < 3 * max_iteration; ++i)
+				pairs.push_back(make_pair(rand() % max_iteration, i));
+			flat_set<pair<int, int>, __test_less_first> fs(pairs.begin(), pairs.end());
+			set<pair<int, int>, __test_less_first> reference(pairs.begin(), pairs.end());
+			bool same = fs.size() == reference.size();
+			auto ref = reference.begin();
+			for (auto ite = fs.begin(); same && ite != fs.end(); ++ite, ++ref)
+				same = ite->first == ref->first && ite->second == ref->second;
+			std::cout << "same as set : " << same << std::endl;
+		}
+		test_info("flat_set   lower_bound, upper_bound, nth and rank");
+		{
+			int lo = rand() % 50;
+			int hi = lo + 30;
+			std::cout << "values in [" << lo << ", " << hi << "): ";
+			s.for_each_in_range(lo, hi, [](int v) { std::cout << v << " "; });
+			std::cout << std::endl << "count_range : " << s.count_range(lo, hi);
+			std::cout << " ; upper_bound(" << lo << ") : ";
+			if (s.upper_bound(lo) == s.end()) std::cout << "end";
+			else std::cout << *s.upper_bound(lo);
+			std::cout << " ; rank(" << hi << ") : " << s.rank(hi);
+			std::cout << " ; nth(" << s.size() / 2 << ") : " << *s.nth(s.size() / 2) << std::endl;
+		}
+		test_info("flat_set   erase");
+		for (int i = 0; i < max_iteration * 2; ++i) {
+			auto ite = s.find(rand() % 100);
+			if (ite != s.end()) {
+				std::cout << "to remove : " << *ite << " ; ";
+				ite = s.erase(ite);
+				std::cout << "next : ";
+				if (ite == s.end()) std::cout << "end" << std::endl;
+				else std::cout << *ite << std::endl;
+			}
+		}
+		print_flat_set(s);
+		test_info("flat_set   set_intersection with the even numbers below 100");
+		{
+			flat_set<int> evens;
+			for (int i = 0; i < 100; i += 2)
+				evens.insert(evens.end(), i);
+			s.set_intersection(evens);
+			print_flat_set(s);
+		}
+		test_info("flat_map   insert, merge, find and erase");
+		{
+			flat_map<int, int> m;
+			for (int i = 0; i < max_iteration; ++i)
+				m.insert(make_pair(rand() % 20, i));
+			std::cout << "map: ";
+			for (auto ite = m.begin(); ite != m.end(); ++ite)
+				std::cout << ite->first << ":" << ite->second << " ";
+			std::cout << std::endl;
+			flat_map<int, int> batch;
+			for (int i = 0; i < max_iteration / 2; ++i)
+				batch.insert(make_pair(rand() % 20, 100 + i));
+			std::cout << "batch: ";
+			for (auto ite = batch.begin(); ite != batch.end(); ++ite)
+				std::cout << ite->first << ":" << ite->second << " ";
+			std::cout << std::endl;
+			m.merge(batch);
+			std::cout << "after merging the batch: ";
+			for (auto ite = m.begin(); ite != m.end(); ++ite)
+				std::cout << ite->first << ":" << ite->second << " ";
+			std::cout << std::endl;
+			int key = m.begin()->first;
+			std::cout << "find " << key << " : " << m.find(key)->second << std::endl;
+			m.erase(m.find(key));
+			std::cout << "after erasing " << key << ": ";
+			for (auto ite = m.begin(); ite != m.end(); ++ite)
+				std::cout << ite->first << ":" << ite->second << " ";
+			std::cout << std::endl << "bytes used: " << m.bytes_used() << std::endl;
+		}
+		test_info("flat_map   insert a range with equal keys, the first pair of a key is taken");
+		{
+			vector<pair<int, int>> pairs;
+			for (int i = 0; i < 3 * max_iteration; ++i)
+				pairs.push_back(make_pair(rand() % max_iteration, i));
+			flat_map<int, int> m(pairs.begin(), pairs.end());
+			set<pair<int, int>, __test_less_first> reference(pairs.begin(), pairs.end());
+			bool same = m.size() == reference.size();
+			auto ref = reference.begin();
+			for (auto ite = m.begin(); same && ite != m.end(); ++ite, ++ref)
+				same = ite->first == ref->first && ite->second == ref->second;
+			for (auto ite = m.begin(); ite != m.end(); ++ite)
+				std::cout << ite->first << ":" << ite->second << " ";
+			std::cout << std::endl << "same as set : " << same << std::endl;
+		}
+		test_info("flat_set and flat_map   strings: range construct, range insert, empty range erase");
+		{
+			std::string keys[] = { "k1", "k2", "k3" };
+			flat_set<std::string> strs(keys, keys + 3);
+			std::string more[] = { "k4", "k5" };
+			strs.insert(more, more + 2);
+			strs.erase(strs.find("k2"), strs.find("k2"));
+			std::cout << "flat_set: ";
+			for (auto ite = strs.begin(); ite != strs.end(); ++ite)
+				std::cout << "[" << *ite << "]";
+			bool kept = strs.size() == 5;
+			for (auto ite = strs.begin(); kept && ite != strs.end(); ++ite)
+				kept = !ite->empty();
+			std::cout << " ; all kept : " << kept << std::endl;
+			vector<pair<int, std::string>> pairs;
+			for (int i = 0; i < 5; ++i)
+				pairs.push_back(ezSTL::make_pair(i, std::string("v") + char('0' + i)));
+			flat_map<int, std::string> m(pairs.begin(), pairs.end());
+			m.erase(m.find(2), m.find(2));
+			std::cout << "flat_map: ";
+			for (auto ite = m.begin(); ite != m.end(); ++ite)
+				std::cout << ite->first << ":[" << ite->second << "] ";
+			kept = m.size() == 5;
+			for (auto ite = m.begin(); kept && ite != m.end(); ++ite)
+				kept = !ite->second.empty();
+			std::cout << " ; all kept : " << kept << std::endl;
+		}
+		test_info("flat_set   clear");
+		s.clear();
+		print_flat_set(s);
+		finish_info("flat_set and flat_map");
+		continue_next_test();
+	}
+
+	void test::test_static_index() {
+		const int max_iteration = 10;
+		srand((unsigned int)time(NULL));
+		start_info("static_index");
+		set<int> s;
+		for (int i = 0; i < max_iteration * 2; ++i)
+			s.insert(rand() % 100);
+		std::cout << "set: ";
+		for (auto ite = s.begin(); ite != s.end(); ++ite)
+			std::cout << *ite << " ";
+		std::cout << std::endl;
+		test_info("static_index   build from a set, the values in sorted order");
+		static_index<int> frozen_set(s.begin(), s.end());
+		std::cout << "size: " << frozen_set.size() << " ; bytes used: " << frozen_set.bytes_used() << std::endl;
+		std::cout << "static_index: ";
+		for (auto ite = frozen_set.begin(); ite != frozen_set.end(); ++ite)
+			std::cout << *ite << " ";
+		std::cout << std::endl << "in reverse order: ";
+		for (auto ite = frozen_set.end(); ite != frozen_set.begin();)
+			std::cout << *--ite << " ";
+		std::cout << std::endl;
+		test_info("static_index   find, lower_bound and upper_bound");
+		for (int i = 0; i < max_iteration; ++i) {
+			int number = rand() % 100;
+			bool found = frozen_set.find(number) != frozen_set.end();
+			if (found != (s.find(number) != s.end()))
+				std::cout << "static_index and set disagree on " << number << " ; ";
+			std::cout << number << (found ? " found" : " not found") << ", lower_bound : ";
+			auto ite = frozen_set.lower_bound(number);
+			if (ite == frozen_set.end()) std::cout << "end";
+			else std::cout << *ite;
+			std::cout << ", upper_bound : ";
+			ite = frozen_set.upper_bound(number);
+			if (ite == frozen_set.end()) std::cout << "end" << std::endl;
+			else std::cout << *ite << std::endl;
+		}
+		test_info("static_index   find a batch");
+		{
+			int queries[max_iteration];
+			static_index<int>::iterator found[max_iteration];
+			for (int i = 0; i < max_iteration; ++i)
+				queries[i] = rand() % 100;
+			frozen_set.find_batch(queries, queries + max_iteration, found);
+			for (int i = 0; i < max_iteration; ++i)
+				std::cout << queries[i] << (found[i] != frozen_set.end() ? " found ; " : " not found ; ");
+			std::cout << std::endl;
+		}
+		test_info("static_index   move, the source is left empty");
+		{
+			static_index<int> moved(ezSTL::move(frozen_set));
+			std::cout << "moved size: " << moved.size() << " ; source size: " << frozen_set.size()
+				<< " ; find in source: " << (frozen_set.find(rand() % 100) != frozen_set.end()) << std::endl;
+			frozen_set = ezSTL::move(moved);
+			std::cout << "moved back size: " << frozen_set.size() << " ; source size: " << moved.size() << std::endl;
+		}
+		finish_info("static_index");
+		continue_next_test();
+	}
+
+	void test::test_arena_set() {
+		const int max_iteration = 10;
+		srand((unsigned int)time(NULL));
+		start_info("arena_set");
+		arena_set<int> s;
+		set<int> reference;
+		test_info("arena_set   insert");
+		for (int i = 0; i < max_iteration * 2; ++i) {
+			int number = rand() % 100;
+			if (s.insert(number).second != reference.insert(number).second)
+				std::cout << "arena_set and set disagree on inserting " << number << std::endl;
+		}
+		std::cout << "size: " << s.size() << " ; bytes used: " << s.bytes_used() << " ; is RBTree: " << s.isRBTree() << std::endl;
+		std::cout << "arena_set: ";
+		for (auto ite = s.begin(); ite != s.end(); ++ite)
+			std::cout << *ite << " ";
+		std::cout << std::endl << "in reverse order: ";
+		for (auto ite = s.end(); ite != s.begin();)
+			std::cout << *--ite << " ";
+		std::cout << std::endl;
+		test_info("arena_set   find, lower_bound and upper_bound");
+		for (int i = 0; i < max_iteration; ++i) {
+			int number = rand() % 100;
+			bool found = s.find(number) != s.end();
+			if (found != (reference.find(number) != reference.end()))
+				std::cout << "arena_set and set disagree on " << number << " ; ";
+			std::cout << number << (found ? " found" : " not found") << ", lower_bound : ";
+			auto ite = s.lower_bound(number);
+			if (ite == s.end()) std::cout << "end";
+			else std::cout << *ite;
+			std::cout << ", upper_bound : ";
+			ite = s.upper_bound(number);
+			if (ite == s.end()) std::cout << "end" << std::endl;
+			else std::cout << *ite << std::endl;
+		}
+		test_info("arena_set   erase, the slots are reused by the next inserts");
+		for (int i = 0; i < max_iteration; ++i) {
+			int number = rand() % 100;
+			auto ite = s.find(number);
+			if (ite != s.end()) {
+				s.erase(ite);
+				reference.erase(reference.find(number));
+				std::cout << "erase " << number << " ; ";
+			}
+		}
+		for (int i = 0; i < max_iteration; ++i) {
+			int number = rand() % 100;
+			s.insert(number);
+			reference.insert(number);
+		}
+		std::cout << std::endl << "size: " << s.size() << " ; bytes used: " << s.bytes_used() << " ; is RBTree: " << s.isRBTree() << std::endl;
+		std::cout << "arena_set: ";
+		auto check = reference.begin();
+		for (auto ite = s.begin(); ite != s.end(); ++ite, ++check) {
+			std::cout << *ite << " ";
+			if (*ite != *check)
+				std::cout << "(set has " << *check << ") ";
+		}
+		std::cout << std::endl;
+		test_info("arena_set   move, the source is left empty");
+		{
+			arena_set<int> moved(ezSTL::move(s));
+			std::cout << "moved size: " << moved.size() << " ; source size: " << s.size()
+				<< " ; find in source: " << (s.find(reference.begin() == reference.end() ? 0 : *reference.begin()) != s.end()) << std::endl;
+			s.insert(1);
+			s = ezSTL::move(moved);
+			std::cout << "moved back size: " << s.size() << " ; is RBTree: " << s.isRBTree() << std::endl;
+		}
+		test_info("arena_set   clear");
+		s.clear();
+		std::cout << "size: " << s.size() << " ; empty: " << s.empty() << " ; is RBTree: " << s.isRBTree() << std::endl;
+		finish_info("arena_set");
+		continue_next_test();
+	}
+
+	void test::test_interval_map() {
+		const int max_iteration = 10;
+		srand((unsigned int)time(NULL));
+		start_info("interval_map");
+		interval_map<int, int> m;
+		auto print_interval_map = [&m] {
+			std::cout << "size: " << m.size() << " ; is RBTree: " << m.isRBTree() << std::endl << "interval_map: ";
+			for (auto ite = m.begin(); ite != m.end(); ++ite)
+				std::cout << "[" << ite->first.first << ", " << ite->first.second << "]:" << ite->second << " ";
+			std::cout << std::endl;
+		};
+		test_info("interval_map   insert");
+		for (int i = 0; i < max_iteration; ++i) {
+			int lo = rand() % 100;
+			m.insert(lo, lo + rand() % 20, i);
+		}
+		print_interval_map();
+		test_info("interval_map   find_overlap, for_each_overlap and count_overlaps");
+		for (int i = 0; i < max_iteration / 2; ++i) {
+			int lo = rand() % 100;
+			int hi = lo + rand() % 10;
+			int expected = 0;
+			for (auto ite = m.begin(); ite != m.end(); ++ite)
+				if (ite->first.first <= hi && lo <= ite->first.second)
+					++expected;
+			std::cout << "[" << lo << ", " << hi << "] overlaps: ";
+			m.for_each_overlap(lo, hi, [](const pair<pair<int, int>, int>& v) {
+				std::cout << "[" << v.first.first << ", " << v.first.second << "] ";
+			});
+			std::cout << "; count: " << m.count_overlaps(lo, hi);
+			if (m.count_overlaps(lo, hi) != (unsigned int)expected)
+				std::cout << " (a scan finds " << expected << ")";
+			std::cout << " ; find_overlap: ";
+			auto ite = m.find_overlap(lo, hi);
+			if (ite == m.end()) std::cout << "end" << std::endl;
+			else std::cout << "[" << ite->first.first << ", " << ite->first.second << "]" << std::endl;
+		}
+		test_info("interval_map   erase");
+		for (int i = 0; i < max_iteration / 2 && !m.empty(); ++i) {
+			auto ite = m.begin();
+			for (int step = rand() % m.size(); step > 0; --step)
+				++ite;
+			std::cout << "erase [" << ite->first.first << ", " << ite->first.second << "] ; ";
+			m.erase(ite);
+		}
+		std::cout << std::endl;
+		print_interval_map();
+		test_info("interval_map   build from sorted intervals");
+		{
+			vector<pair<pair<int, int>, int>> v;
+			for (int i = 0; i < max_iteration; ++i)
+				v.push_back(make_pair(make_pair(i * 10, i * 10 + rand() % 30), i));
+			interval_map<int, int> sorted(v.begin(), v.end());
+			m.clear();
+			m.insert(v.begin(), v.end());
+			print_interval_map();
+			std::cout << "[25, 25] overlaps " << sorted.count_overlaps(25, 25) << " intervals" << std::endl;
+		}
+		finish_info("interval_map");
+		continue_next_test();
+	}
+
 	template<typename Key, typename Value>
 	void test::print_unordered_map(unordered_map<Key, Value>& um) {
 		std::cout << "size: " << um.size();
@@ -548,6 +2150,14 @@ namespace ezSTL {
 		unordered_map<int, int> um4;
 		um4 = ezSTL::move(um2);
 		print_unordered_map(um4);
+		test_info("unordered_map   extract and insert a node with a new key");
+		for (int i = 0; i < 3 && !um.empty(); ++i) {
+			auto nh = um.extract(um.begin());
+			std::cout << "extract key " << nh.key() << " ; insert it again as key " << nh.key() + 100 << std::endl;
+			nh.key() += 100;
+			um.insert(ezSTL::move(nh));
+			print_unordered_map(um);
+		}
 		test_info("unordered_map   clear");
 		um.clear();
 		print_unordered_map(um);
@@ -636,6 +2246,55 @@ namespace ezSTL {
 		std::cout << std::endl;
 	}
 
+	template<typename Pair, typename Map, typename Bytes>
+	void test::map_insert_find_erase(Map& m, std::string name, const std::vector<unsigned>& keys,
+		const std::vector<unsigned>& queries, Bytes bytes_used) {
+		int n = (int)keys.size();
+		begin_timer();
+		for (int i = 0; i < n; i++)
+			m.insert(Pair(keys[i], (unsigned)i));
+		end_timer(name + " inserting", n);
+		std::cout << "size : " << m.size() << " ; bytes per pair : " << (double)bytes_used() / m.size() << std::endl;
+		unsigned long long checksum = 0;
+		begin_timer();
+		for (int i = 0; i < n; i++) {
+			auto ite = m.find(queries[i]);
+			if (ite != m.end())
+				checksum += ite->second;
+		}
+		end_timer(name + " finding", n);
+		unsigned int erase_count = 0;
+		begin_timer();
+		for (int i = 0; i < n; i++) {
+			auto ite = m.find(queries[i]);
+			if (ite != m.end()) {
+				++erase_count;
+				m.erase(ite);
+			}
+		}
+		end_timer(name + " finding and erasing", n);
+		std::cout << "erasing number : " << erase_count << " ; checksum : " << checksum << std::endl;
+	}
+
+	template<typename Set>
+	void test::set_insert_find_strings(Set& s, std::string name, const std::vector<std::string>& keys,
+		const std::vector<std::string>& queries) {
+		int n = (int)keys.size();
+		__test_compare_count::calls = 0;
+		begin_timer();
+		for (int i = 0; i < n; i++)
+			s.insert(keys[i]);
+		end_timer(name + " inserting", n);
+		std::cout << "comparisons per insert : " << (double)__test_compare_count::calls / n << std::endl;
+		unsigned int found = 0;
+		__test_compare_count::calls = 0;
+		begin_timer();
+		for (int i = 0; i < n; i++)
+			found += s.find(queries[i]) != s.end();
+		end_timer(name + " finding", n);
+		std::cout << "comparisons per find : " << (double)__test_compare_count::calls / n << " ; found : " << found << std::endl;
+	}
+
 	void test::test_set_map_efficiency() {
 		const int max_number = 5000000;
 		std::default_random_engine e((unsigned)time(0));
@@ -725,6 +2384,640 @@ namespace ezSTL {
 			end_timer(cmpstl + "::map finding and erasing", max_number);
 			std::cout << "erasing number : " << std::to_string(erase_count) << std::endl;
 		}
+		{
+			// an index rebuilt at startup from a sorted dump, and from unsorted records
+			test_info("set   build from a sorted range and from an unsorted range");
+			std::vector<unsigned> keys;
+			for (int i = 0; i < max_number; i++)
+				keys.push_back(u(e));
+			std::sort(keys.begin(), keys.end());
+			{
+				ezSTL::set<unsigned> ezSTL_set;
+				begin_timer();
+				for (int i = 0; i < max_number; i++)
+					ezSTL_set.insert(keys[i]);
+				end_timer("ezSTL::set inserting sorted keys one by one", max_number);
+			}
+			{
+				begin_timer();
+				ezSTL::set<unsigned> ezSTL_set(keys.begin(), keys.end());
+				end_timer("ezSTL::set building from sorted keys", max_number);
+			}
+			{
+				begin_timer();
+				std::set<unsigned> std_set(keys.begin(), keys.end());
+				end_timer(cmpstl + "::set building from sorted keys", max_number);
+			}
+			std::shuffle(keys.begin(), keys.end(), e);
+			{
+				ezSTL::set<unsigned> ezSTL_set;
+				begin_timer();
+				for (int i = 0; i < max_number; i++)
+					ezSTL_set.insert(keys[i]);
+				end_timer("ezSTL::set inserting unsorted keys one by one", max_number);
+			}
+			{
+				begin_timer();
+				ezSTL::set<unsigned> ezSTL_set(keys.begin(), keys.end());
+				end_timer("ezSTL::set building from unsorted keys", max_number);
+			}
+			{
+				thread_pool pool;
+				ezSTL::set<unsigned> ezSTL_set;
+				begin_wall_timer();
+				parallel_insert(pool, ezSTL_set, keys.begin(), keys.end());
+				end_wall_timer("ezSTL::set building from unsorted keys on " + std::to_string(pool.size()) + " threads", max_number);
+			}
+			{
+				begin_timer();
+				std::set<unsigned> std_set(keys.begin(), keys.end());
+				end_timer(cmpstl + "::set building from unsorted keys", max_number);
+			}
+		}
+		{
+			// a batch of updates to a large map, scaled down from 1M updates to a 100M map
+			const int map_number = 10000000;
+			const int batch_number = map_number / 100;
+			test_info("map   merge " + std::to_string(batch_number) + " updates into a map of " + std::to_string(map_number));
+			std::uniform_int_distribution<unsigned> key(0, 4 * map_number);
+			std::vector<std::pair<unsigned, unsigned>> base_pairs, batch_pairs;
+			for (int i = 0; i < map_number; i++)
+				base_pairs.push_back(std::make_pair(4 * i, 0));
+			for (int i = 0; i < batch_number; i++)
+				batch_pairs.push_back(std::make_pair(key(e), 1));
+			std::vector<pair<unsigned, unsigned>> ezSTL_base, ezSTL_batch;
+			for (auto& p : base_pairs)
+				ezSTL_base.push_back(make_pair(p.first, p.second));
+			for (auto& p : batch_pairs)
+				ezSTL_batch.push_back(make_pair(p.first, p.second));
+			{
+				ezSTL::map<unsigned, unsigned> ezSTL_map(ezSTL_base.begin(), ezSTL_base.end());
+				begin_timer();
+				for (int i = 0; i < batch_number; i++) {
+					auto result = ezSTL_map.insert(ezSTL_batch[i]);
+					if (!result.second)
+						result.first->second = ezSTL_batch[i].second;
+				}
+				end_timer("ezSTL::map updating one by one", batch_number);
+			}
+			{
+				ezSTL::map<unsigned, unsigned> ezSTL_map(ezSTL_base.begin(), ezSTL_base.end());
+				ezSTL::map<unsigned, unsigned> batch(ezSTL_batch.begin(), ezSTL_batch.end());
+				begin_timer();
+				ezSTL_map.merge(batch);
+				end_timer("ezSTL::map merging", batch_number);
+				std::cout << "size : " << ezSTL_map.size() << std::endl;
+			}
+			{
+				thread_pool pool;
+				ezSTL::map<unsigned, unsigned> ezSTL_map(ezSTL_base.begin(), ezSTL_base.end());
+				ezSTL::map<unsigned, unsigned> batch(ezSTL_batch.begin(), ezSTL_batch.end());
+				begin_wall_timer();
+				ezSTL_map.merge(batch, parallel_fork(pool));
+				end_wall_timer("ezSTL::map merging on " + std::to_string(pool.size()) + " threads", batch_number);
+			}
+			{
+				std::map<unsigned, unsigned> std_map(base_pairs.begin(), base_pairs.end());
+				begin_timer();
+				for (int i = 0; i < batch_number; i++)
+					std_map[batch_pairs[i].first] = batch_pairs[i].second;
+				end_timer(cmpstl + "::map updating one by one", batch_number);
+				std::cout << "size : " << std_map.size() << std::endl;
+			}
+		}
+		{
+			// percentiles of live data: the k-th key and the rank of a key, against walking the iterator
+			const int query_number = 100000;
+			// walking the iterator is O(n) per query
+			const int walk_number = 10;
+			test_info("set   insert with and without subtree sizes, then nth and rank");
+			std::vector<unsigned> keys;
+			for (int i = 0; i < max_number; i++)
+				keys.push_back(u(e));
+			{
+				ezSTL::set<unsigned> ezSTL_set;
+				begin_timer();
+				for (int i = 0; i < max_number; i++)
+					ezSTL_set.insert(keys[i]);
+				end_timer("ezSTL::set inserting", max_number);
+			}
+			ezSTL::set<unsigned, less<unsigned>, allocator<unsigned>, rbtree_order_statistics> counted_set;
+			begin_timer();
+			for (int i = 0; i < max_number; i++)
+				counted_set.insert(keys[i]);
+			end_timer("ezSTL::set with order statistics inserting", max_number);
+			std::uniform_int_distribution<unsigned> index(0, counted_set.size() - 1);
+			unsigned long long checksum = 0;
+			begin_timer();
+			for (int i = 0; i < query_number; i++) {
+				checksum += *counted_set.nth(index(e));
+				checksum += counted_set.rank(u(e));
+			}
+			end_timer("ezSTL::set with order statistics nth and rank", query_number);
+			std::set<unsigned> std_set(keys.begin(), keys.end());
+			begin_timer();
+			for (int i = 0; i < walk_number; i++) {
+				checksum += *std::next(std_set.begin(), index(e));
+				checksum += std::distance(std_set.begin(), std_set.lower_bound(u(e)));
+			}
+			end_timer(cmpstl + "::set walking the iterator", walk_number);
+			std::cout << "checksum : " << checksum << std::endl;
+		}
+		{
+			// a search in a red-black tree misses the cache at about every level, a B-tree node holds
+			// a whole level of the search in a few cache lines
+			const int tree_number = 10000000;
+			test_info("map   insert, find and erase " + std::to_string(tree_number) + " keys in rbtree, btree and " + cmpstl);
+			std::uniform_int_distribution<unsigned> key(0, 2 * tree_number);
+			std::vector<unsigned> keys, queries;
+			for (int i = 0; i < tree_number; i++) {
+				keys.push_back(key(e));
+				queries.push_back(key(e));
+			}
+			{
+				ezSTL::map<unsigned, unsigned> ezSTL_map;
+				map_insert_find_erase<pair<unsigned, unsigned>>(ezSTL_map, "ezSTL::map", keys, queries,
+					[&ezSTL_map] { return (double)ezSTL_map.size() * sizeof(rbtree<pair<unsigned, unsigned>>::rbtree_node); });
+			}
+			{
+				ezSTL::btree_map<unsigned, unsigned> ezSTL_map;
+				map_insert_find_erase<pair<unsigned, unsigned>>(ezSTL_map, "ezSTL::btree_map", keys, queries,
+					[&ezSTL_map] { return (double)ezSTL_map.bytes_used(); });
+			}
+			{
+				std::map<unsigned, unsigned, std::less<unsigned>, __test_counting_allocator<std::pair<const unsigned, unsigned>>> std_map;
+				map_insert_find_erase<std::pair<unsigned, unsigned>>(std_map, cmpstl + "::map", keys, queries,
+					[] { return (double)__test_allocated_bytes::bytes; });
+			}
+		}
+		{
+			// events in a time window: visit every key in [lo, lo + window) of a tree built in random order
+			const int tree_number = 10000000;
+			test_info("set   scan 1% and 10% windows of " + std::to_string(tree_number) + " keys");
+			std::vector<unsigned> keys;
+			for (int i = 0; i < tree_number; i++)
+				keys.push_back(4 * i);
+			std::shuffle(keys.begin(), keys.end(), e);
+			ezSTL::set<unsigned> ezSTL_set;
+			for (int i = 0; i < tree_number; i++)
+				ezSTL_set.insert(keys[i]);
+			std::set<unsigned> std_set(keys.begin(), keys.end());
+			std::vector<unsigned>().swap(keys);
+			unsigned long long checksum = 0;
+			for (int percent = 1; percent <= 10; percent *= 10) {
+				// every scan visits tree_number / 100 * percent keys, the same keys in total for both windows
+				const unsigned window = 4u * (tree_number / 100 * percent);
+				const int scan_number = 100 / percent;
+				std::uniform_int_distribution<unsigned> start(0, 4u * tree_number - window);
+				std::vector<unsigned> starts;
+				for (int i = 0; i < scan_number; i++)
+					starts.push_back(start(e));
+				std::string name = std::to_string(percent) + "% windows";
+				begin_timer();
+				for (int i = 0; i < scan_number; i++) {
+					auto last = ezSTL_set.lower_bound(starts[i] + window);
+					for (auto ite = ezSTL_set.lower_bound(starts[i]); ite != last; ++ite)
+						checksum += *ite;
+				}
+				end_timer("ezSTL::set scanning " + name + " with iterators", scan_number);
+				begin_timer();
+				for (int i = 0; i < scan_number; i++)
+					ezSTL_set.for_each_in_range(starts[i], starts[i] + window, [&checksum](unsigned v) { checksum += v; });
+				end_timer("ezSTL::set scanning " + name + " with for_each_in_range", scan_number);
+				begin_timer();
+				for (int i = 0; i < scan_number; i++) {
+					auto last = std_set.lower_bound(starts[i] + window);
+					for (auto ite = std_set.lower_bound(starts[i]); ite != last; ++ite)
+						checksum += *ite;
+				}
+				end_timer(cmpstl + "::set scanning " + name + " with iterators", scan_number);
+			}
+			std::cout << "checksum : " << checksum << std::endl;
+		}
+		{
+			// a read mostly table built once: lookups in a sorted array against a red-black tree,
+			// from 1000 keys that fit in the cache up to 10000000 keys; 100000000 keys take about
+			// 4GB as a red-black tree and are left out
+			const int query_number = 1000000;
+			test_info("map   find in rbtree and in sorted arrays of 1000 to 10000000 keys");
+			for (int tree_number = 1000; tree_number <= 10000000; tree_number *= 10) {
+				std::vector<pair<unsigned, unsigned>> pairs;
+				for (int i = 0; i < tree_number; i++)
+					pairs.push_back(make_pair(2u * i, (unsigned)i));
+				std::uniform_int_distribution<unsigned> key(0, 2u * tree_number);
+				std::vector<unsigned> queries;
+				for (int i = 0; i < query_number; i++)
+					queries.push_back(key(e));
+				std::string name = std::to_string(tree_number) + " keys";
+				unsigned long long checksum = 0;
+				{
+					ezSTL::map<unsigned, unsigned> ezSTL_map(pairs.begin(), pairs.end());
+					begin_timer();
+					for (int i = 0; i < query_number; i++) {
+						auto ite = ezSTL_map.find(queries[i]);
+						if (ite != ezSTL_map.end())
+							checksum += ite->second;
+					}
+					end_timer("ezSTL::map finding in " + name, query_number);
+					std::cout << "bytes per pair : " << (double)sizeof(rbtree<pair<unsigned, unsigned>>::rbtree_node) << std::endl;
+				}
+				{
+					ezSTL::flat_map<unsigned, unsigned> ezSTL_map(pairs.begin(), pairs.end());
+					begin_timer();
+					for (int i = 0; i < query_number; i++) {
+						auto ite = ezSTL_map.find(queries[i]);
+						if (ite != ezSTL_map.end())
+							checksum += ite->second;
+					}
+					end_timer("ezSTL::flat_map finding in " + name, query_number);
+					std::cout << "bytes per pair : " << (double)ezSTL_map.bytes_used() / ezSTL_map.size() << std::endl;
+				}
+				std::cout << "checksum : " << checksum << std::endl;
+			}
+		}
+		{
+			// a set frozen after loading: the same lookups in an rbtree, a sorted array searched the plain way,
+			// and the Eytzinger layout of static_index one by one and in batches
+			const int query_number = 2000000;
+			test_info("set   find in rbtree, sorted array and static_index");
+			for (int tree_number = 100000; tree_number <= 10000000; tree_number *= 100) {
+				std::vector<unsigned> keys, queries;
+				for (int i = 0; i < tree_number; i++)
+					keys.push_back(2u * i);
+				std::uniform_int_distribution<unsigned> key(0, 2u * tree_number);
+				for (int i = 0; i < query_number; i++)
+					queries.push_back(key(e));
+				std::string name = std::to_string(tree_number) + " keys";
+				unsigned long long checksum = 0;
+				{
+					ezSTL::set<unsigned> ezSTL_set(keys.begin(), keys.end());
+					begin_timer();
+					for (int i = 0; i < query_number; i++)
+						checksum += ezSTL_set.find(queries[i]) != ezSTL_set.end();
+					end_timer("ezSTL::set finding in " + name, query_number);
+				}
+				begin_timer();
+				for (int i = 0; i < query_number; i++) {
+					auto ite = std::lower_bound(keys.begin(), keys.end(), queries[i]);
+					checksum += ite != keys.end() && *ite == queries[i];
+				}
+				end_timer("binary search finding in " + name, query_number);
+				ezSTL::static_index<unsigned> frozen_set(keys.begin(), keys.end());
+				begin_timer();
+				for (int i = 0; i < query_number; i++)
+					checksum += frozen_set.find(queries[i]) != frozen_set.end();
+				end_timer("ezSTL::static_index finding in " + name, query_number);
+				std::vector<static_index<unsigned>::iterator> found(query_number);
+				begin_timer();
+				frozen_set.find_batch(queries.begin(), queries.end(), found.begin());
+				for (int i = 0; i < query_number; i++)
+					checksum += found[i] != frozen_set.end();
+				end_timer("ezSTL::static_index finding in batches in " + name, query_number);
+				std::cout << "checksum : " << checksum << std::endl;
+			}
+		}
+		{
+			// the same keys in set, whose nodes are 32 bytes allocated one by one, and in arena_set,
+			// whose 16 byte nodes sit in one array and link each other by 32-bit indices
+			const int query_number = 2000000;
+			test_info("set   insert and find in set and arena_set");
+			for (int tree_number = 100000; tree_number <= 10000000; tree_number *= 100) {
+				std::vector<unsigned> keys, queries;
+				std::uniform_int_distribution<unsigned> key;
+				for (int i = 0; i < tree_number; i++)
+					keys.push_back(key(e));
+				for (int i = 0; i < query_number; i++)
+					queries.push_back(keys[i % tree_number]);
+				std::shuffle(queries.begin(), queries.end(), e);
+				std::string name = std::to_string(tree_number) + " keys";
+				unsigned long long checksum = 0;
+				{
+					ezSTL::set<unsigned> ezSTL_set;
+					begin_timer();
+					for (int i = 0; i < tree_number; i++)
+						ezSTL_set.insert(keys[i]);
+					end_timer("ezSTL::set inserting " + name, tree_number);
+					begin_timer();
+					for (int i = 0; i < query_number; i++)
+						checksum += ezSTL_set.find(queries[i]) != ezSTL_set.end();
+					end_timer("ezSTL::set finding in " + name, query_number);
+					std::cout << "bytes per element : " << sizeof(rbtree<unsigned>::rbtree_node) << " and the heap header of each node" << std::endl;
+				}
+				{
+					ezSTL::arena_set<unsigned> ezSTL_set;
+					ezSTL_set.reserve(tree_number);
+					begin_timer();
+					for (int i = 0; i < tree_number; i++)
+						ezSTL_set.insert(keys[i]);
+					end_timer("ezSTL::arena_set inserting " + name, tree_number);
+					begin_timer();
+					for (int i = 0; i < query_number; i++)
+						checksum += ezSTL_set.find(queries[i]) != ezSTL_set.end();
+					end_timer("ezSTL::arena_set finding in " + name, query_number);
+					std::cout << "bytes per element : " << (double)ezSTL_set.bytes_used() / ezSTL_set.size() << std::endl;
+				}
+				std::cout << "checksum : " << checksum << std::endl;
+			}
+		}
+		{
+			// time series keys arrive almost sorted: ascending with a small jitter and some duplicates
+			test_info("map   insert almost sorted keys, without and with hint end()");
+			std::uniform_int_distribution<unsigned> jitter(0, 7);
+			std::vector<unsigned> keys;
+			for (int i = 0; i < max_number; i++)
+				keys.push_back(4 * i + jitter(e));
+			{
+				ezSTL::map<unsigned, unsigned> ezSTL_map;
+				begin_timer();
+				for (int i = 0; i < max_number; i++)
+					ezSTL_map.insert(make_pair(keys[i], (unsigned)i));
+				end_timer("ezSTL::map inserting", max_number);
+			}
+			{
+				ezSTL::map<unsigned, unsigned> ezSTL_map;
+				begin_timer();
+				for (int i = 0; i < max_number; i++)
+					ezSTL_map.insert(ezSTL_map.end(), make_pair(keys[i], (unsigned)i));
+				end_timer("ezSTL::map inserting with hint", max_number);
+				std::cout << "size : " << ezSTL_map.size() << std::endl;
+			}
+			{
+				ezSTL::map<unsigned, unsigned> ezSTL_map;
+				begin_timer();
+				for (int i = 0; i < max_number; i++)
+					ezSTL_map.emplace_hint(ezSTL_map.end(), keys[i], (unsigned)i);
+				end_timer("ezSTL::map emplacing with hint", max_number);
+			}
+			{
+				std::map<unsigned, unsigned> std_map;
+				begin_timer();
+				for (int i = 0; i < max_number; i++)
+					std_map.insert(std::make_pair(keys[i], (unsigned)i));
+				end_timer(cmpstl + "::map inserting", max_number);
+			}
+			{
+				std::map<unsigned, unsigned> std_map;
+				begin_timer();
+				for (int i = 0; i < max_number; i++)
+					std_map.insert(std_map.end(), std::make_pair(keys[i], (unsigned)i));
+				end_timer(cmpstl + "::map inserting with hint", max_number);
+				std::cout << "size : " << std_map.size() << std::endl;
+			}
+		}
+		{
+			// string keys sharing a long prefix, like paths or urls: a less functor tells equal from greater
+			// by a second call at every level of find, a three-way comparator needs one
+			const int string_number = 200000;
+			test_info("set   insert and find string keys with a less functor and with a three-way comparator");
+			std::uniform_int_distribution<unsigned> key(0, 2 * string_number);
+			std::vector<std::string> keys, queries;
+			for (int i = 0; i < string_number; i++) {
+				keys.push_back("/srv/data/customers/" + std::to_string(key(e)));
+				queries.push_back("/srv/data/customers/" + std::to_string(key(e)));
+			}
+			{
+				ezSTL::set<std::string, __test_counting_less> ezSTL_set;
+				set_insert_find_strings(ezSTL_set, "ezSTL::set with less", keys, queries);
+			}
+			{
+				ezSTL::set<std::string, __test_counting_three_way> ezSTL_set;
+				set_insert_find_strings(ezSTL_set, "ezSTL::set with three-way compare", keys, queries);
+			}
+			{
+				std::set<std::string, __test_counting_less> std_set;
+				set_insert_find_strings(std_set, cmpstl + "::set", keys, queries);
+			}
+		}
+		{
+			// entries leave an active map for an archive map: a copy, a free and an allocation per entry,
+			// against relinking the node
+			const int move_number = 1000000;
+			test_info("map   move " + std::to_string(move_number) + " pairs to an archive map");
+			std::vector<unsigned> keys;
+			for (int i = 0; i < move_number; i++)
+				keys.push_back(u(e));
+			{
+				ezSTL::map<unsigned, std::string> active, archive;
+				for (int i = 0; i < move_number; i++)
+					active.insert(ezSTL::make_pair(keys[i], std::string("session state of customer ") + std::to_string(keys[i])));
+				begin_timer();
+				while (!active.empty()) {
+					auto ite = active.begin();
+					archive.insert(*ite);
+					active.erase(ite);
+				}
+				end_timer("ezSTL::map copying and erasing", move_number);
+			}
+			{
+				ezSTL::map<unsigned, std::string> active, archive;
+				for (int i = 0; i < move_number; i++)
+					active.insert(ezSTL::make_pair(keys[i], std::string("session state of customer ") + std::to_string(keys[i])));
+				begin_timer();
+				while (!active.empty())
+					archive.insert(active.extract(active.begin()));
+				end_timer("ezSTL::map extracting and inserting", move_number);
+				std::cout << "size : " << archive.size() << std::endl;
+			}
+			{
+				std::map<unsigned, std::string> active, archive;
+				for (int i = 0; i < move_number; i++)
+					active.insert(std::make_pair(keys[i], std::string("session state of customer ") + std::to_string(keys[i])));
+				begin_timer();
+				while (!active.empty()) {
+					auto ite = active.begin();
+					archive.insert(*ite);
+					active.erase(ite);
+				}
+				end_timer(cmpstl + "::map copying and erasing", move_number);
+			}
+		}
+		{
+			// a snapshot of a large map: inserting every pair again, building from the sorted pairs,
+			// and cloning the tree node by node, serial and on a thread_pool, timed by the wall clock
+			const int snapshot_number = 10000000;
+			test_info("map   copy a map of " + std::to_string(snapshot_number) + " pairs for a snapshot");
+			std::vector<unsigned> keys;
+			for (int i = 0; i < snapshot_number; i++)
+				keys.push_back(u(e));
+			ezSTL::map<unsigned, unsigned> ezSTL_map;
+			for (int i = 0; i < snapshot_number; i++)
+				ezSTL_map.insert(ezSTL::make_pair(keys[i], (unsigned)i));
+			{
+				begin_wall_timer();
+				ezSTL::map<unsigned, unsigned> snapshot;
+				for (auto ite = ezSTL_map.begin(); ite != ezSTL_map.end(); ++ite)
+					snapshot.insert(snapshot.end(), *ite);
+				end_wall_timer("ezSTL::map inserting with hint", ezSTL_map.size());
+			}
+			{
+				begin_wall_timer();
+				ezSTL::map<unsigned, unsigned> snapshot(ezSTL_map.begin(), ezSTL_map.end());
+				end_wall_timer("ezSTL::map constructing from the sorted range", ezSTL_map.size());
+			}
+			{
+				begin_wall_timer();
+				ezSTL::map<unsigned, unsigned> snapshot(ezSTL_map);
+				end_wall_timer("ezSTL::map copy constructor", ezSTL_map.size());
+				begin_wall_timer();
+				ezSTL::map<unsigned, unsigned> moved(ezSTL::move(snapshot));
+				end_wall_timer("ezSTL::map move constructor", 1);
+			}
+			{
+				thread_pool pool;
+				ezSTL::map<unsigned, unsigned> snapshot;
+				begin_wall_timer();
+				snapshot.clone_from(ezSTL_map, parallel_fork(pool));
+				end_wall_timer("ezSTL::map cloning on " + std::to_string(pool.size()) + " workers", ezSTL_map.size());
+			}
+			{
+				std::map<unsigned, unsigned> std_map;
+				for (int i = 0; i < snapshot_number; i++)
+					std_map.insert(std::make_pair(keys[i], (unsigned)i));
+				begin_wall_timer();
+				std::map<unsigned, unsigned> snapshot(std_map);
+				end_wall_timer(cmpstl + "::map copy constructor", std_map.size());
+			}
+		}
+		{
+			// time ranges starting a few seconds apart and lasting up to 1000 seconds: overlap queries
+			// on an interval_map built from the sorted ranges, against scanning all of them
+			const int interval_number = 10000000;
+			const int query_number = 1000000;
+			const int scan_number = 10;
+			test_info("interval_map   find the overlaps among " + std::to_string(interval_number) + " intervals");
+			std::uniform_int_distribution<unsigned> gap(0, 200), length(0, 1000), width(0, 5000);
+			std::vector<ezSTL::pair<ezSTL::pair<unsigned, unsigned>, unsigned>> intervals;
+			unsigned start = 0;
+			for (int i = 0; i < interval_number; i++) {
+				start += gap(e);
+				intervals.push_back(ezSTL::make_pair(ezSTL::make_pair(start, start + length(e)), (unsigned)i));
+			}
+			std::uniform_int_distribution<unsigned> point(0, start);
+			std::vector<unsigned> queries;
+			for (int i = 0; i < query_number; i++)
+				queries.push_back(point(e));
+			unsigned long long checksum = 0;
+			begin_timer();
+			ezSTL::interval_map<unsigned, unsigned> ezSTL_map(intervals.begin(), intervals.end());
+			end_timer("ezSTL::interval_map building from sorted intervals", interval_number);
+			begin_timer();
+			for (int i = 0; i < query_number; i++)
+				ezSTL_map.for_each_overlap(queries[i], queries[i] + width(e),
+					[&checksum](const ezSTL::pair<ezSTL::pair<unsigned, unsigned>, unsigned>& v) { checksum += v.second; });
+			end_timer("ezSTL::interval_map finding overlaps", query_number);
+			begin_timer();
+			for (int i = 0; i < scan_number; i++) {
+				unsigned lo = queries[i], hi = queries[i] + width(e);
+				for (auto& v : intervals)
+					if (v.first.first <= hi && lo <= v.first.second)
+						checksum += v.second;
+			}
+			end_timer("scanning all intervals for overlaps", scan_number);
+			std::cout << "checksum : " << checksum << std::endl;
+		}
+		{
+			// iterating a map climbs parent links at every other step, the threaded map follows one link;
+			// full scans forward and backward, and short range scans from lower_bound
+			const int scan_number = 100000;
+			const int scan_length = 100;
+			test_info("map   iterate with and without threads");
+			std::vector<unsigned> keys;
+			for (int i = 0; i < max_number; i++)
+				keys.push_back(u(e));
+			unsigned long long checksum = 0;
+			{
+				ezSTL::map<unsigned, unsigned> ezSTL_map;
+				for (int i = 0; i < max_number; i++)
+					ezSTL_map.insert(ezSTL::make_pair(keys[i], (unsigned)i));
+				begin_timer();
+				for (auto ite = ezSTL_map.begin(); ite != ezSTL_map.end(); ++ite)
+					checksum += ite->second;
+				end_timer("ezSTL::map iterating forward", ezSTL_map.size());
+				begin_timer();
+				for (auto ite = ezSTL_map.end(); ite != ezSTL_map.begin();)
+					checksum += (--ite)->second;
+				end_timer("ezSTL::map iterating backward", ezSTL_map.size());
+				begin_timer();
+				for (int i = 0; i < scan_number; i++) {
+					auto ite = ezSTL_map.lower_bound(keys[i]);
+					for (int j = 0; j < scan_length && ite != ezSTL_map.end(); ++j, ++ite)
+						checksum += ite->second;
+				}
+				end_timer("ezSTL::map scanning " + std::to_string(scan_length) + " pairs from lower_bound", scan_number);
+			}
+			{
+				ezSTL::map<unsigned, unsigned, less<unsigned>, allocator<pair<unsigned, unsigned>>, rbtree_threaded> ezSTL_map;
+				for (int i = 0; i < max_number; i++)
+					ezSTL_map.insert(ezSTL::make_pair(keys[i], (unsigned)i));
+				begin_timer();
+				for (auto ite = ezSTL_map.begin(); ite != ezSTL_map.end(); ++ite)
+					checksum += ite->second;
+				end_timer("ezSTL::map threaded iterating forward", ezSTL_map.size());
+				begin_timer();
+				for (auto ite = ezSTL_map.end(); ite != ezSTL_map.begin();)
+					checksum += (--ite)->second;
+				end_timer("ezSTL::map threaded iterating backward", ezSTL_map.size());
+				begin_timer();
+				for (int i = 0; i < scan_number; i++) {
+					auto ite = ezSTL_map.lower_bound(keys[i]);
+					for (int j = 0; j < scan_length && ite != ezSTL_map.end(); ++j, ++ite)
+						checksum += ite->second;
+				}
+				end_timer("ezSTL::map threaded scanning " + std::to_string(scan_length) + " pairs from lower_bound", scan_number);
+			}
+			std::cout << "checksum : " << checksum << std::endl;
+		}
+		{
+			// the time a thread serving requests spends dropping a large map: clear frees every node,
+			// deferred_clear detaches the tree and the nodes are freed on the reclaimer thread
+			const int clear_number = 10000000;
+			test_info("map   clear and deferred_clear " + std::to_string(clear_number) + " pairs");
+			std::vector<ezSTL::pair<unsigned, unsigned>> pairs;
+			for (int i = 0; i < clear_number; i++)
+				pairs.push_back(ezSTL::make_pair(2u * i, (unsigned)i));
+			background_reclaimer reclaimer;
+			{
+				ezSTL::map<unsigned, unsigned> ezSTL_map(pairs.begin(), pairs.end());
+				begin_wall_timer();
+				ezSTL_map.clear();
+				end_wall_timer("ezSTL::map clear in the calling thread", clear_number);
+			}
+			{
+				ezSTL::map<unsigned, unsigned> ezSTL_map(pairs.begin(), pairs.end());
+				begin_wall_timer();
+				ezSTL_map.deferred_clear(reclaimer);
+				end_wall_timer("ezSTL::map deferred_clear in the calling thread", clear_number);
+				begin_wall_timer();
+				reclaimer.wait();
+				end_wall_timer("ezSTL::map waiting for the reclaimer", clear_number);
+			}
+			{
+				// SCHED_IDLE on linux, the reclaimer only runs when nothing else wants the cpu
+				background_reclaimer idle_reclaimer(true);
+				ezSTL::map<unsigned, unsigned> ezSTL_map(pairs.begin(), pairs.end());
+				begin_wall_timer();
+				ezSTL_map.deferred_clear(idle_reclaimer);
+				end_wall_timer("ezSTL::map deferred_clear to an idle priority reclaimer in the calling thread", clear_number);
+				idle_reclaimer.wait();
+			}
+			{
+				ezSTL::unordered_map<unsigned, unsigned> ezSTL_map;
+				for (int i = 0; i < clear_number; i++)
+					ezSTL_map.insert(pairs[i]);
+				begin_wall_timer();
+				ezSTL_map.deferred_clear(reclaimer);
+				end_wall_timer("ezSTL::unordered_map deferred_clear in the calling thread", clear_number);
+				reclaimer.wait();
+			}
+			{
+				std::map<unsigned, unsigned> std_map;
+				for (int i = 0; i < clear_number; i++)
+					std_map.insert(std_map.end(), std::make_pair(pairs[i].first, pairs[i].second));
+				begin_wall_timer();
+				std_map.clear();
+				end_wall_timer(cmpstl + "::map clear in the calling thread", clear_number);
+			}
+		}
 		finish_info("efficiency of set and map");
 		continue_next_test();
 	}
@@ -874,6 +3167,551 @@ namespace ezSTL {
 		finish_info("efficiency of algorithm sort and stable_sort");
 		continue_next_test();
 	}
+
+	template<typename Heap>
+	void test::test_decrease_key(Heap& h, std::string name) {
+		const int max_iteration = 10;
+		vector<typename Heap::handle_type> handles;
+		test_info(name + "   push");
+		for (int i = 0; i < max_iteration; ++i) {
+			int number = rand() % 100;
+			handles.push_back(h.push(number));
+			std::cout << number << " ";
+		}
+		std::cout << std::endl << "size: " << h.size() << " ; top: " << h.top() << std::endl;
+		test_info(name + "   update");
+		for (int i = 0; i < 4; ++i) {
+			int index = rand() % max_iteration;
+			int number = rand() % 100;
+			std::cout << "update " << h.get(handles[index]) << " to " << number;
+			h.update(handles[index], number);
+			std::cout << " ; top: " << h.top() << std::endl;
+		}
+		test_info(name + "   erase");
+		std::cout << "erase " << h.get(handles[0]) << " and " << h.get(handles[1]) << std::endl;
+		h.erase(handles[0]);
+		h.erase(handles[1]);
+		test_info(name + "   pop");
+		while (!h.empty()) {
+			std::cout << h.top() << " ";
+			h.pop();
+		}
+		std::cout << std::endl;
+	}
+
+	void test::test_addressable_heap() {
+		srand((unsigned int)time(NULL));
+		start_info("indexed_priority_queue and pairing_heap");
+		{
+			indexed_priority_queue<int> h;
+			test_decrease_key(h, "indexed_priority_queue");
+			test_info("indexed_priority_queue   handles of popped and erased values");
+			auto popped = h.push(1);
+			h.pop();
+			auto erased = h.push(2);
+			h.erase(erased);
+			// both pushes reuse the slot of popped
+			auto live = h.push(3);
+			std::cout << "contains(popped) : " << h.contains(popped) << " ; contains(erased) : " << h.contains(erased);
+			std::cout << " ; contains(live) : " << h.contains(live) << std::endl;
+			std::cout << "update(popped) : " << h.update(popped, 0) << " ; erase(erased) : " << h.erase(erased);
+			std::cout << " ; get(live) : " << h.get(live) << std::endl;
+			h.clear();
+			std::cout << "after clear contains(live) : " << h.contains(live) << std::endl;
+		}
+		{
+			pairing_heap<int> h;
+			test_decrease_key(h, "pairing_heap");
+		}
+		finish_info("indexed_priority_queue and pairing_heap");
+		continue_next_test();
+	}
+
+	void test::test_addressable_heap_efficiency() {
+		const unsigned int vertex_number = 1000000;
+		const unsigned int degree = 8;
+		const unsigned int infinity = static_cast<unsigned int>(-1);
+		std::string cmpstl = "SGI STL";
+		//std::string cmpstl = "PJ STL";
+		std::default_random_engine e((unsigned)time(0));
+		std::uniform_int_distribution<unsigned> vertex(0, vertex_number - 1);
+		std::uniform_int_distribution<unsigned> weight(1, 1000);
+		// synthetic graph in compressed sparse rows, a chain keeps every vertex reachable
+		std::vector<unsigned> first_edge(vertex_number + 1), target, length;
+		for (unsigned int v = 0; v < vertex_number; ++v) {
+			first_edge[v] = target.size();
+			if (v + 1 < vertex_number) {
+				target.push_back(v + 1);
+				length.push_back(weight(e) * degree);
+			}
+			for (unsigned int i = 1; i < degree; ++i) {
+				target.push_back(vertex(e));
+				length.push_back(weight(e));
+			}
+		}
+		first_edge[vertex_number] = target.size();
+		start_info("efficiency of addressable heaps (dijkstra on " + std::to_string(vertex_number) + " vertices, "
+			+ std::to_string(target.size()) + " edges)");
+		std::vector<unsigned> dist;
+		unsigned long long checksum = 0;
+		auto summary = [&dist, &checksum](unsigned int max_size) {
+			unsigned long long sum = 0;
+			for (unsigned int i = 0; i < dist.size(); ++i)
+				sum += dist[i];
+			std::cout << "max heap size : " << max_size << " ; checksum : " << sum;
+			if (checksum != 0 && sum != checksum)
+				std::cout << " (different from the first result!)";
+			std::cout << std::endl;
+			checksum = sum;
+		};
+		{
+			// duplicates are inserted and stale entries skipped
+			dist.assign(vertex_number, infinity);
+			unsigned int max_size = 0;
+			begin_timer();
+			ezSTL::priority_queue<pair<unsigned, unsigned>> pq;
+			dist[0] = 0;
+			pq.push(make_pair(0u, 0u));
+			while (!pq.empty()) {
+				pair<unsigned, unsigned> now = pq.top();
+				pq.pop();
+				if (now.first != dist[now.second])
+					continue;
+				for (unsigned int i = first_edge[now.second]; i < first_edge[now.second + 1]; ++i) {
+					unsigned int d = now.first + length[i];
+					if (d < dist[target[i]]) {
+						dist[target[i]] = d;
+						pq.push(make_pair(d, target[i]));
+						if (pq.size() > max_size) max_size = pq.size();
+					}
+				}
+			}
+			end_timer("ezSTL::priority_queue(lazy deletion) dijkstra", vertex_number);
+			summary(max_size);
+		}
+		{
+			dist.assign(vertex_number, infinity);
+			unsigned int max_size = 0;
+			begin_timer();
+			std::priority_queue<std::pair<unsigned, unsigned>, std::vector<std::pair<unsigned, unsigned>>,
+				std::greater<std::pair<unsigned, unsigned>>> pq;
+			dist[0] = 0;
+			pq.push(std::make_pair(0u, 0u));
+			while (!pq.empty()) {
+				std::pair<unsigned, unsigned> now = pq.top();
+				pq.pop();
+				if (now.first != dist[now.second])
+					continue;
+				for (unsigned int i = first_edge[now.second]; i < first_edge[now.second + 1]; ++i) {
+					unsigned int d = now.first + length[i];
+					if (d < dist[target[i]]) {
+						dist[target[i]] = d;
+						pq.push(std::make_pair(d, target[i]));
+						if (pq.size() > max_size) max_size = pq.size();
+					}
+				}
+			}
+			end_timer(cmpstl + "::priority_queue(lazy deletion) dijkstra", vertex_number);
+			summary(max_size);
+		}
+		{
+			dist.assign(vertex_number, infinity);
+			unsigned int max_size = 0;
+			begin_timer();
+			using queue_type = indexed_priority_queue<pair<unsigned, unsigned>, less<pair<unsigned, unsigned>>, 4>;
+			queue_type pq;
+			// a popped vertex keeps its stale handle, which pq no longer contains
+			std::vector<queue_type::handle_type> handle(vertex_number);
+			dist[0] = 0;
+			handle[0] = pq.push(make_pair(0u, 0u));
+			while (!pq.empty()) {
+				pair<unsigned, unsigned> now = pq.top();
+				pq.pop();
+				for (unsigned int i = first_edge[now.second]; i < first_edge[now.second + 1]; ++i) {
+					unsigned int d = now.first + length[i];
+					if (d < dist[target[i]]) {
+						dist[target[i]] = d;
+						if (!pq.contains(handle[target[i]]))
+							handle[target[i]] = pq.push(make_pair(d, target[i]));
+						else
+							pq.update(handle[target[i]], make_pair(d, target[i]));
+						if (pq.size() > max_size) max_size = pq.size();
+					}
+				}
+			}
+			end_timer("ezSTL::indexed_priority_queue(4-ary, decrease-key) dijkstra", vertex_number);
+			summary(max_size);
+		}
+		{
+			dist.assign(vertex_number, infinity);
+			unsigned int max_size = 0;
+			begin_timer();
+			pairing_heap<pair<unsigned, unsigned>> pq;
+			std::vector<pairing_heap<pair<unsigned, unsigned>>::handle_type> handle(vertex_number, nullptr);
+			dist[0] = 0;
+			handle[0] = pq.push(make_pair(0u, 0u));
+			while (!pq.empty()) {
+				pair<unsigned, unsigned> now = pq.top();
+				pq.pop();
+				handle[now.second] = nullptr;
+				for (unsigned int i = first_edge[now.second]; i < first_edge[now.second + 1]; ++i) {
+					unsigned int d = now.first + length[i];
+					if (d < dist[target[i]]) {
+						dist[target[i]] = d;
+						if (handle[target[i]] == nullptr)
+							handle[target[i]] = pq.push(make_pair(d, target[i]));
+						else
+							pq.update(handle[target[i]], make_pair(d, target[i]));
+						if (pq.size() > max_size) max_size = pq.size();
+					}
+				}
+			}
+			end_timer("ezSTL::pairing_heap(decrease-key) dijkstra", vertex_number);
+			summary(max_size);
+		}
+		finish_info("efficiency of addressable heaps");
+		continue_next_test();
+	}
+
+	void test::test_radix_heap() {
+		const int max_iteration = 10;
+		srand((unsigned int)time(NULL));
+		start_info("radix_heap");
+		radix_heap<unsigned, int> rh;
+		unsigned now = 0;
+		test_info("radix_heap   push");
+		for (int i = 0; i < max_iteration; ++i) {
+			unsigned key = now + rand() % 100;
+			rh.push(key, i);
+			std::cout << key << ":" << i << " ";
+		}
+		std::cout << std::endl << "size: " << rh.size() << " ; top: " << rh.top().first << ":" << rh.top().second << std::endl;
+		test_info("radix_heap   pop and push keys not less than the popped one");
+		for (int i = 0; i < max_iteration; ++i) {
+			now = rh.top().first;
+			std::cout << "pop " << now << ":" << rh.top().second;
+			rh.pop();
+			unsigned key = now + rand() % 100;
+			rh.push(key, i + max_iteration);
+			std::cout << " ; push " << key << ":" << i + max_iteration << std::endl;
+		}
+		test_info("radix_heap   move, the source is left empty");
+		{
+			radix_heap<unsigned, int> moved(ezSTL::move(rh));
+			std::cout << "moved size: " << moved.size() << " ; source empty: " << rh.empty() << std::endl;
+			rh.push(0, -1);
+			rh = ezSTL::move(moved);
+			std::cout << "moved back size: " << rh.size() << " ; source empty: " << moved.empty() << std::endl;
+		}
+		test_info("radix_heap   pop");
+		while (!rh.empty()) {
+			std::cout << rh.top().first << ":" << rh.top().second << " ";
+			rh.pop();
+		}
+		std::cout << std::endl;
+		finish_info("radix_heap");
+		continue_next_test();
+	}
+
+	void test::test_radix_heap_efficiency() {
+		const int max_number = 50000000;
+		const int queue_size = 1000000;
+		std::default_random_engine e((unsigned)time(0));
+		std::uniform_int_distribution<unsigned> u(0, 1000000);
+		std::vector<unsigned> delay;
+		for (int i = 0; i < queue_size; ++i)
+			delay.push_back(u(e));
+		start_info("efficiency of radix_heap (monotone keys, " + std::to_string(queue_size) + " pending events)");
+		// pop the earliest event and schedule a later one, until max_number operations are done
+		{
+			radix_heap<unsigned, unsigned> rh;
+			unsigned long long checksum = 0;
+			begin_timer();
+			for (int i = 0; i < queue_size; ++i)
+				rh.push(delay[i], i);
+			for (int i = queue_size; i < max_number; i += 2) {
+				unsigned now = rh.top().first;
+				checksum += rh.top().second;
+				rh.pop();
+				rh.push(now + delay[i % queue_size], i);
+			}
+			end_timer("ezSTL::radix_heap", max_number);
+			std::cout << "checksum : " << checksum << std::endl;
+		}
+		{
+			ezSTL::priority_queue<pair<unsigned, unsigned>> pq;
+			unsigned long long checksum = 0;
+			begin_timer();
+			for (int i = 0; i < queue_size; ++i)
+				pq.push(make_pair(delay[i], (unsigned)i));
+			for (int i = queue_size; i < max_number; i += 2) {
+				unsigned now = pq.top().first;
+				checksum += pq.top().second;
+				pq.pop();
+				pq.push(make_pair(now + delay[i % queue_size], (unsigned)i));
+			}
+			end_timer("ezSTL::priority_queue", max_number);
+			std::cout << "checksum (may differ on equal keys) : " << checksum << std::endl;
+		}
+		{
+			ezSTL::priority_queue<unsigned> pq;
+			unsigned long long checksum = 0;
+			begin_timer();
+			for (int i = 0; i < queue_size; ++i)
+				pq.push(delay[i]);
+			for (int i = queue_size; i < max_number; i += 2) {
+				unsigned now = pq.top();
+				checksum += now;
+				pq.pop();
+				pq.push(now + delay[i % queue_size]);
+			}
+			end_timer("ezSTL::priority_queue<unsigned> (keys only)", max_number);
+			std::cout << "checksum : " << checksum << std::endl;
+		}
+		{
+			radix_heap<unsigned, unsigned> rh;
+			unsigned long long checksum = 0;
+			begin_timer();
+			for (int i = 0; i < queue_size; ++i)
+				rh.push(delay[i], 0);
+			for (int i = queue_size; i < max_number; i += 2) {
+				unsigned now = rh.top().first;
+				checksum += now;
+				rh.pop();
+				rh.push(now + delay[i % queue_size], 0);
+			}
+			end_timer("ezSTL::radix_heap (keys only)", max_number);
+			std::cout << "checksum : " << checksum << std::endl;
+		}
+		finish_info("efficiency of radix_heap");
+		continue_next_test();
+	}
+
+	void test::test_timing_wheel() {
+		const int max_iteration = 10;
+		srand((unsigned int)time(NULL));
+		start_info("timing_wheel");
+		// 10 time units per tick, 3 levels of 16 slots
+		timing_wheel<int> tw(10, 3, 4);
+		vector<timing_wheel<int>::handle_type> handles;
+		test_info("timing_wheel   schedule");
+		for (int i = 0; i < max_iteration; ++i) {
+			unsigned long long expire = rand() % 5000;
+			handles.push_back(tw.schedule(expire, i));
+			std::cout << "timer " << i << " at " << expire << std::endl;
+		}
+		std::cout << "size: " << tw.size() << " ; now: " << tw.now() << std::endl;
+		test_info("timing_wheel   cancel");
+		for (int i = 0; i < 3; ++i) {
+			int index = rand() % max_iteration;
+			std::cout << "cancel timer " << index << " : " << (tw.cancel(handles[index]) ? "cancelled" : "not active") << std::endl;
+		}
+		test_info("timing_wheel   advance");
+		for (unsigned long long now = 1000; !tw.empty(); now += 1000) {
+			std::cout << "advance to " << now << " , expired:";
+			tw.advance(now, [](int data) { std::cout << " " << data; });
+			std::cout << " ; size: " << tw.size() << std::endl;
+		}
+		finish_info("timing_wheel");
+		continue_next_test();
+	}
+
+	void test::test_timing_wheel_efficiency() {
+		const int max_number = 10000000;
+		const unsigned int max_delay = 1000000;
+		std::default_random_engine e((unsigned)time(0));
+		std::uniform_int_distribution<unsigned> u(1, max_delay);
+		std::vector<unsigned> delay;
+		for (int i = 0; i < max_number; ++i)
+			delay.push_back(u(e));
+		start_info("efficiency of timing_wheel (schedule, cancel every other timer, expire the rest)");
+		{
+			timing_wheel<unsigned> tw;
+			vector<timing_wheel<unsigned>::handle_type> handles;
+			handles.reserve(max_number);
+			unsigned long long checksum = 0;
+			begin_timer();
+			for (int i = 0; i < max_number; ++i)
+				handles.push_back(tw.schedule(delay[i], i));
+			end_timer("ezSTL::timing_wheel scheduling", max_number);
+			begin_timer();
+			for (int i = 0; i < max_number; i += 2)
+				tw.cancel(handles[i]);
+			end_timer("ezSTL::timing_wheel cancelling", max_number / 2);
+			begin_timer();
+			unsigned int expired = tw.advance(max_delay, [&checksum](unsigned data) { checksum += data; });
+			end_timer("ezSTL::timing_wheel expiring", expired);
+			std::cout << "checksum : " << checksum << std::endl;
+		}
+		{
+			// cancelled timers stay in the heap and are skipped when they reach top
+			ezSTL::priority_queue<pair<unsigned, unsigned>> pq;
+			std::vector<bool> cancelled(max_number, false);
+			unsigned long long checksum = 0;
+			begin_timer();
+			for (int i = 0; i < max_number; ++i)
+				pq.push(make_pair(delay[i], (unsigned)i));
+			end_timer("ezSTL::priority_queue scheduling", max_number);
+			begin_timer();
+			for (int i = 0; i < max_number; i += 2)
+				cancelled[i] = true;
+			end_timer("ezSTL::priority_queue cancelling(lazy)", max_number / 2);
+			begin_timer();
+			unsigned int expired = 0;
+			while (!pq.empty() && pq.top().first <= max_delay) {
+				if (!cancelled[pq.top().second]) {
+					checksum += pq.top().second;
+					++expired;
+				}
+				pq.pop();
+			}
+			end_timer("ezSTL::priority_queue expiring", expired);
+			std::cout << "checksum : " << checksum << std::endl;
+		}
+		finish_info("efficiency of timing_wheel");
+		continue_next_test();
+	}
+
+	unsigned long long test::serial_fib(unsigned int n) {
+		return n < 2 ? n : serial_fib(n - 1) + serial_fib(n - 2);
+	}
+
+	unsigned long long test::parallel_fib(thread_pool& pool, unsigned int n) {
+		// small problems are not worth a task
+		if (n < 20)
+			return serial_fib(n);
+		unsigned long long x = 0, y = 0;
+		task_group g;
+		pool.spawn(g, [&pool, &x, n] { x = parallel_fib(pool, n - 1); });
+		y = parallel_fib(pool, n - 2);
+		pool.wait(g);
+		return x + y;
+	}
+
+	void test::test_thread_pool() {
+		start_info("thread_pool");
+		test_info("work_stealing_deque   push, pop and steal");
+		{
+			work_stealing_deque<int*> d(2);
+			int values[10];
+			for (int i = 0; i < 10; ++i) {
+				values[i] = i;
+				d.push(values + i);
+			}
+			int* x = nullptr;
+			std::cout << "size: " << d.size();
+			d.pop(x);
+			std::cout << " ; pop: " << *x;
+			d.steal(x);
+			std::cout << " ; steal: " << *x;
+			std::cout << " ; size: " << d.size() << std::endl;
+		}
+		thread_pool pool(4);
+		std::cout << "thread_pool size: " << pool.size() << std::endl;
+		test_info("thread_pool   spawn and wait");
+		{
+			std::atomic<unsigned long long> sum(0);
+			task_group g;
+			for (unsigned int i = 1; i <= 1000; ++i)
+				pool.spawn(g, [&sum, i] { sum += i; });
+			pool.wait(g);
+			std::cout << "sum of 1..1000 : " << sum.load() << " (expected 500500)" << std::endl;
+		}
+		test_info("thread_pool   fork/join fib");
+		for (unsigned int n = 20; n <= 26; n += 2)
+			std::cout << "fib(" << n << ") = " << parallel_fib(pool, n) << " (expected " << serial_fib(n) << ")" << std::endl;
+		test_info("thread_pool   parallel_for");
+		{
+			const unsigned int max_number = 100000;
+			vector<unsigned long long> v(max_number, 0);
+			parallel_for(pool, 0u, max_number, 1000u, [&v](unsigned int i) { v[i] = (unsigned long long)i * i; });
+			unsigned int wrong = 0;
+			for (unsigned int i = 0; i < max_number; ++i)
+				if (v[i] != (unsigned long long)i * i) ++wrong;
+			std::cout << "wrong elements : " << wrong << std::endl;
+		}
+		test_info("thread_pool   parallel_sort and parallel_insert");
+		{
+			const unsigned int max_number = 100000;
+			vector<unsigned int> v;
+			for (unsigned int i = 0; i < max_number; ++i)
+				v.push_back(rand() % max_number);
+			set<unsigned int> s;
+			parallel_insert(pool, s, v.begin(), v.end());
+			std::set<unsigned int> std_set(v.begin(), v.end());
+			parallel_sort(pool, v.begin(), v.end());
+			std::cout << "sorted : " << is_sorted(v.begin(), v.end()) << " ; set size : " << s.size()
+				<< " (expected " << std_set.size() << ")" << std::endl;
+		}
+		test_info("thread_pool   parallel_stable_sort and parallel_insert of equal keys");
+		{
+			const unsigned int max_number = 100000;
+			vector<pair<unsigned int, unsigned int>> v;
+			for (unsigned int i = 0; i < max_number; ++i)
+				v.push_back(make_pair(static_cast<unsigned int>(rand() % 1000), i));
+			set<pair<unsigned int, unsigned int>, __test_less_first> s, reference;
+			parallel_insert(pool, s, v.begin(), v.end());
+			reference.insert(v.begin(), v.end());
+			bool same = s.size() == reference.size();
+			for (auto ite = s.begin(), ref = reference.begin(); same && ite != s.end(); ++ite, ++ref)
+				same = ite->first == ref->first && ite->second == ref->second;
+			parallel_stable_sort(pool, v.begin(), v.end(), __test_less_first());
+			bool stable = true;
+			for (unsigned int i = 1; i < max_number; ++i)
+				if (v[i - 1].first == v[i].first && v[i - 1].second > v[i].second)
+					stable = false;
+			std::cout << "stable : " << stable << " ; same as set::insert : " << same << std::endl;
+		}
+		std::cout << "steals : " << pool.steal_count() << " ; tasks : " << pool.task_count() << std::endl;
+		finish_info("thread_pool");
+		continue_next_test();
+	}
+
+	void test::test_thread_pool_efficiency() {
+		const unsigned int fib_number = 34;
+		const unsigned int max_number = 20000000;
+		const unsigned int thread_numbers[] = { 1, 2, 4, 8 };
+		start_info("efficiency of thread_pool");
+		test_info("fib " + std::to_string(fib_number) + ":");
+		{
+			begin_wall_timer();
+			unsigned long long result = serial_fib(fib_number);
+			double serial_time = end_wall_timer("serial fib", fib_number);
+			for (unsigned int n : thread_numbers) {
+				thread_pool pool(n);
+				begin_wall_timer();
+				if (parallel_fib(pool, fib_number) != result)
+					std::cout << "wrong result!" << std::endl;
+				double time = end_wall_timer("thread_pool(" + std::to_string(n) + ") fib", fib_number);
+				std::cout << "speedup : " << serial_time / time << " ; steals : " << pool.steal_count()
+					<< " ; tasks : " << pool.task_count() << std::endl;
+			}
+		}
+		test_info("parallel_for:");
+		{
+			vector<double> v(max_number, 0.0);
+			auto body = [&v](unsigned int i) {
+				double x = i;
+				for (int k = 0; k < 8; ++k)
+					x = x * 0.5 + 1.0 / (x + 1.0);
+				v[i] = x;
+			};
+			begin_wall_timer();
+			for (unsigned int i = 0; i < max_number; ++i)
+				body(i);
+			double serial_time = end_wall_timer("serial for", max_number);
+			for (unsigned int n : thread_numbers) {
+				thread_pool pool(n);
+				begin_wall_timer();
+				parallel_for(pool, 0u, max_number, 10000u, body);
+				double time = end_wall_timer("thread_pool(" + std::to_string(n) + ") parallel_for", max_number);
+				std::cout << "speedup : " << serial_time / time << " ; steals : " << pool.steal_count()
+					<< " ; tasks : " << pool.task_count() << std::endl;
+			}
+		}
+		finish_info("efficiency of thread_pool");
+		continue_next_test();
+	}
 }
 
 #endif // !EZSTL_TEST_H
@@ -0,0 +1,686 @@
+/*********************************************************************************************/
+// class work_stealing_deque:
+// Chase-Lev lock-free deque, the owner thread pushes and pops at the bottom,
+// other threads steal from the top. T should be a trivially copyable type (e.g. a pointer)
+//
+// 1. void push(const T& x);
+// 2. bool pop(T& x);
+// 3. bool steal(T& x);
+// 4. bool empty() const;
+// 5. size_type size() const;
+//
+// class task_group:
+// a fork/join counter, all tasks spawned into a group can be waited together
+//
+// 1. bool done() const;
+//
+// class thread_pool:
+// each worker owns a work_stealing_deque, an idle worker steals from random victims
+//
+// 1. size_type size() const;
+// 2. void spawn(task_group& g, F f);
+// 3. void wait(task_group& g);
+// 4. unsigned long long steal_count() const;
+// 5. unsigned long long task_count() const;
+// 6. void reset_statistics();
+//
+// parallel algorithms using thread_pool:
+// 7. void parallel_for(thread_pool& pool, Index first, Index last, Index grain, F f);
+// 8. void parallel_sort(thread_pool& pool, Iterator first, Iterator last, Compare cmp);
+// 9. void parallel_sort(thread_pool& pool, Iterator first, Iterator last);
+// 10. void parallel_stable_sort(thread_pool& pool, Iterator first, Iterator last, Compare cmp);
+// 11. void parallel_stable_sort(thread_pool& pool, Iterator first, Iterator last);
+// 12. void parallel_insert(thread_pool& pool, Container& c, Iterator first, Iterator last);
+//
+// class parallel_fork:
+// runs the join based set operations of set and map on a thread_pool, e.g. a.set_union(b, parallel_fork(pool));
+//
+// class background_reclaimer:
+// one thread running the jobs submitted to it in order, e.g. destroying the nodes m.deferred_clear(reclaimer) detaches;
+// on linux it runs under SCHED_BATCH, background_reclaimer(true) runs it under SCHED_IDLE, which a busy cpu may starve
+//
+// 1. void submit(F f);
+// 2. void wait();
+// 3. size_type pending() const;
+
+#ifndef EZSTL_THREAD_POOL_H
+#define EZSTL_THREAD_POOL_H
+
+#include "vector.h"
+#include "queue.h"
+#include "algorithm.h"
+#include "rbtree.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace ezSTL {
+
+	// circular array used by work_stealing_deque, capacity is always a power of 2
+	template<typename T>
+	class __work_stealing_array {
+	public:
+		using size_type = unsigned int;
+
+		explicit __work_stealing_array(size_type n) : mask(n - 1), buffer(new std::atomic<T>[n]) {}
+		~__work_stealing_array() {
+			delete[] buffer;
+		}
+		__work_stealing_array(const __work_stealing_array<T>&) = delete;
+		__work_stealing_array<T>& operator=(const __work_stealing_array<T>&) = delete;
+
+		size_type capacity() const {
+			return mask + 1;
+		}
+		T get(long i) const {
+			return buffer[i & mask].load(std::memory_order_relaxed);
+		}
+		void put(long i, T x) {
+			buffer[i & mask].store(x, std::memory_order_relaxed);
+		}
+		// allocate a new array of double capacity, and copy [top, bottom) into it
+		__work_stealing_array<T>* grow(long bottom, long top) const {
+			__work_stealing_array<T>* result = new __work_stealing_array<T>(2 * capacity());
+			for (long i = top; i != bottom; ++i)
+				result->put(i, get(i));
+			return result;
+		}
+
+	private:
+		size_type mask;
+		std::atomic<T>* buffer;
+	};
+
+	// Chase-Lev deque, using the memory orders of "Correct and Efficient Work-Stealing for Weak Memory Models"
+	template<typename T>
+	class work_stealing_deque {
+	public:
+		using value_type = T;
+		using size_type = unsigned int;
+
+		explicit work_stealing_deque(size_type capacity = 64) : top(0), bottom(0),
+			array(new __work_stealing_array<T>(capacity)) {}
+		work_stealing_deque(const work_stealing_deque<T>&) = delete;
+		work_stealing_deque<T>& operator=(const work_stealing_deque<T>&) = delete;
+		~work_stealing_deque() {
+			delete array.load(std::memory_order_relaxed);
+			for (size_type i = 0; i < garbage.size(); ++i)
+				delete garbage[i];
+		}
+
+		bool empty() const {
+			return size() == 0;
+		}
+		size_type size() const {
+			long b = bottom.load(std::memory_order_relaxed);
+			long t = top.load(std::memory_order_relaxed);
+			return b > t ? static_cast<size_type>(b - t) : 0;
+		}
+
+		// only called by the owner thread
+		void push(const T& x) {
+			long b = bottom.load(std::memory_order_relaxed);
+			long t = top.load(std::memory_order_acquire);
+			__work_stealing_array<T>* a = array.load(std::memory_order_relaxed);
+			// if the array is full, grow it. the old array may still be read by thieves,
+			// so it is retired until the deque is destroyed
+			if (b - t > static_cast<long>(a->capacity()) - 1) {
+				garbage.push_back(a);
+				a = a->grow(b, t);
+				array.store(a, std::memory_order_release);
+			}
+			a->put(b, x);
+			std::atomic_thread_fence(std::memory_order_release);
+			bottom.store(b + 1, std::memory_order_relaxed);
+		}
+
+		// only called by the owner thread, take the latest pushed value
+		bool pop(T& x) {
+			long b = bottom.load(std::memory_order_relaxed) - 1;
+			__work_stealing_array<T>* a = array.load(std::memory_order_relaxed);
+			bottom.store(b, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			long t = top.load(std::memory_order_relaxed);
+			// if the deque is empty
+			if (t > b) {
+				bottom.store(b + 1, std::memory_order_relaxed);
+				return false;
+			}
+			x = a->get(b);
+			// if it is the last value, race with thieves
+			if (t == b) {
+				bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+				bottom.store(b + 1, std::memory_order_relaxed);
+				return won;
+			}
+			return true;
+		}
+
+		// called by any thread, take the earliest pushed value
+		bool steal(T& x) {
+			long t = top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			long b = bottom.load(std::memory_order_acquire);
+			if (t >= b)
+				return false;
+			__work_stealing_array<T>* a = array.load(std::memory_order_acquire);
+			x = a->get(t);
+			// lose the race with the owner or another thief
+			return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+		}
+
+	private:
+		std::atomic<long> top;
+		std::atomic<long> bottom;
+		std::atomic<__work_stealing_array<T>*> array;
+		// arrays replaced by grow(), only touched by the owner thread
+		vector<__work_stealing_array<T>*> garbage;
+	};
+
+	// fork/join counter of spawned but unfinished tasks
+	class task_group {
+	public:
+		task_group() : pending(0) {}
+		task_group(const task_group&) = delete;
+		task_group& operator=(const task_group&) = delete;
+
+		bool done() const {
+			return pending.load(std::memory_order_acquire) == 0;
+		}
+
+	private:
+		friend class thread_pool;
+		std::atomic<unsigned int> pending;
+	};
+
+	// a task queued in thread_pool
+	class __pool_task {
+	public:
+		__pool_task(std::function<void()>&& f, task_group* g) : func(ezSTL::move(f)), group(g) {}
+		std::function<void()> func;
+		task_group* group;
+	};
+
+	class thread_pool;
+
+	// which pool and which worker the present thread belongs to
+	class __worker_context {
+	public:
+		thread_pool* pool = nullptr;
+		unsigned int index = 0;
+	};
+
+	inline __worker_context& __current_worker() {
+		static thread_local __worker_context context;
+		return context;
+	}
+
+	class thread_pool {
+	public:
+		using size_type = unsigned int;
+
+		// n == 0 means one worker per hardware thread
+		// if pinned is true, worker i is bound to cpu i % hardware_concurrency (only on linux)
+		explicit thread_pool(size_type n = 0, bool pinned = false);
+		thread_pool(const thread_pool&) = delete;
+		thread_pool& operator=(const thread_pool&) = delete;
+		~thread_pool();
+
+		size_type size() const {
+			return workers.size();
+		}
+
+		// run f asynchronously as a part of group g
+		template<typename F>
+		void spawn(task_group& g, F f) {
+			g.pending.fetch_add(1, std::memory_order_relaxed);
+			__pool_task* task = new __pool_task(std::function<void()>(f), &g);
+			__worker_context& context = __current_worker();
+			// a worker pushes into its own deque, other threads use the injection queue
+			if (context.pool == this)
+				workers[context.index]->deque.push(task);
+			else {
+				std::lock_guard<std::mutex> lock(injection_mutex);
+				injection.push(task);
+				injection_size.fetch_add(1, std::memory_order_relaxed);
+			}
+			notify();
+		}
+
+		// block until all tasks of group g are finished, executing other tasks meanwhile
+		void wait(task_group& g);
+
+		// statistics
+		unsigned long long steal_count() const;
+		unsigned long long task_count() const;
+		void reset_statistics();
+
+	protected:
+		class worker {
+		public:
+			explicit worker(unsigned int seed) : random_state(seed), steals(0), executed(0) {}
+			work_stealing_deque<__pool_task*> deque;
+			std::thread thread;
+			// state of xorshift random generator, used to choose a victim
+			unsigned int random_state;
+			std::atomic<unsigned long long> steals;
+			std::atomic<unsigned long long> executed;
+		};
+
+		vector<worker*> workers;
+		// tasks spawned by threads outside the pool
+		std::mutex injection_mutex;
+		queue<__pool_task*> injection;
+		std::atomic<unsigned int> injection_size;
+		// number of queued tasks, used to put idle workers to sleep
+		std::atomic<long> pending;
+		std::atomic<unsigned int> sleepers;
+		std::atomic<bool> stop;
+		std::mutex sleep_mutex;
+		std::condition_variable sleep_cv;
+		// statistics of threads outside the pool
+		std::atomic<unsigned long long> outer_steals;
+		std::atomic<unsigned long long> outer_executed;
+
+		void run(unsigned int index);
+		void notify();
+		void execute(__pool_task* task, std::atomic<unsigned long long>& executed);
+		__pool_task* find_task(worker* self, unsigned int& random_state, std::atomic<unsigned long long>& steals);
+		static void pin(std::thread& t, unsigned int cpu);
+	};
+
+	inline thread_pool::thread_pool(size_type n, bool pinned) : injection_size(0), pending(0), sleepers(0),
+		stop(false), outer_steals(0), outer_executed(0) {
+		if (n == 0)
+			n = std::thread::hardware_concurrency();
+		if (n == 0)
+			n = 1;
+		for (size_type i = 0; i < n; ++i)
+			workers.push_back(new worker(2463534242U + i * 2654435761U));
+		// start threads after all workers exist, since any worker may steal from any other
+		for (size_type i = 0; i < n; ++i) {
+			workers[i]->thread = std::thread(&thread_pool::run, this, i);
+			if (pinned)
+				pin(workers[i]->thread, i);
+		}
+	}
+
+	inline thread_pool::~thread_pool() {
+		{
+			std::lock_guard<std::mutex> lock(sleep_mutex);
+			stop.store(true);
+		}
+		sleep_cv.notify_all();
+		// a running worker may still try to steal from any other, so join all before deleting
+		for (size_type i = 0; i < workers.size(); ++i)
+			workers[i]->thread.join();
+		for (size_type i = 0; i < workers.size(); ++i)
+			delete workers[i];
+	}
+
+	inline void thread_pool::wait(task_group& g) {
+		__worker_context& context = __current_worker();
+		worker* self = context.pool == this ? workers[context.index] : nullptr;
+		unsigned int outer_random_state = 88675123U;
+		unsigned int& random_state = self ? self->random_state : outer_random_state;
+		std::atomic<unsigned long long>& steals = self ? self->steals : outer_steals;
+		std::atomic<unsigned long long>& executed = self ? self->executed : outer_executed;
+		// help executing tasks instead of blocking
+		while (!g.done()) {
+			__pool_task* task = find_task(self, random_state, steals);
+			if (task)
+				execute(task, executed);
+			else
+				std::this_thread::yield();
+		}
+	}
+
+	inline unsigned long long thread_pool::steal_count() const {
+		unsigned long long result = outer_steals.load();
+		for (size_type i = 0; i < workers.size(); ++i)
+			result += workers[i]->steals.load();
+		return result;
+	}
+
+	inline unsigned long long thread_pool::task_count() const {
+		unsigned long long result = outer_executed.load();
+		for (size_type i = 0; i < workers.size(); ++i)
+			result += workers[i]->executed.load();
+		return result;
+	}
+
+	inline void thread_pool::reset_statistics() {
+		outer_steals.store(0);
+		outer_executed.store(0);
+		for (size_type i = 0; i < workers.size(); ++i) {
+			workers[i]->steals.store(0);
+			workers[i]->executed.store(0);
+		}
+	}
+
+	inline void thread_pool::run(unsigned int index) {
+		__worker_context& context = __current_worker();
+		context.pool = this;
+		context.index = index;
+		worker* self = workers[index];
+		unsigned int idle_rounds = 0;
+		while (true) {
+			__pool_task* task = find_task(self, self->random_state, self->steals);
+			if (task) {
+				execute(task, self->executed);
+				idle_rounds = 0;
+				continue;
+			}
+			if (stop.load())
+				break;
+			// spin for a while before going to sleep
+			if (++idle_rounds < 64) {
+				std::this_thread::yield();
+				continue;
+			}
+			std::unique_lock<std::mutex> lock(sleep_mutex);
+			sleepers.fetch_add(1);
+			sleep_cv.wait(lock, [this] { return pending.load() > 0 || stop.load(); });
+			sleepers.fetch_sub(1);
+			idle_rounds = 0;
+		}
+	}
+
+	inline void thread_pool::notify() {
+		pending.fetch_add(1);
+		// taking the lock makes sure a worker between checking pending and sleeping is not missed
+		if (sleepers.load() > 0) {
+			std::lock_guard<std::mutex> lock(sleep_mutex);
+			sleep_cv.notify_one();
+		}
+	}
+
+	inline void thread_pool::execute(__pool_task* task, std::atomic<unsigned long long>& executed) {
+		pending.fetch_sub(1);
+		task->func();
+		task->group->pending.fetch_sub(1, std::memory_order_release);
+		delete task;
+		executed.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	inline __pool_task* thread_pool::find_task(worker* self, unsigned int& random_state,
+		std::atomic<unsigned long long>& steals) {
+		__pool_task* task = nullptr;
+		// 1. own deque, newest task first
+		if (self && self->deque.pop(task))
+			return task;
+		// 2. tasks from outside the pool
+		if (injection_size.load(std::memory_order_relaxed) > 0) {
+			std::lock_guard<std::mutex> lock(injection_mutex);
+			if (!injection.empty()) {
+				task = injection.front();
+				injection.pop();
+				injection_size.fetch_sub(1, std::memory_order_relaxed);
+				return task;
+			}
+		}
+		// 3. steal the oldest task of a random victim
+		size_type n = workers.size();
+		random_state ^= random_state << 13;
+		random_state ^= random_state >> 17;
+		random_state ^= random_state << 5;
+		size_type start = random_state % n;
+		for (size_type i = 0; i < n; ++i) {
+			worker* victim = workers[(start + i) % n];
+			if (victim != self && victim->deque.steal(task)) {
+				steals.fetch_add(1, std::memory_order_relaxed);
+				return task;
+			}
+		}
+		return nullptr;
+	}
+
+	inline void thread_pool::pin(std::thread& t, unsigned int cpu) {
+#if defined(__linux__)
+		unsigned int count = std::thread::hardware_concurrency();
+		cpu_set_t cpuset;
+		CPU_ZERO(&cpuset);
+		CPU_SET(count ? cpu % count : 0, &cpuset);
+		pthread_setaffinity_np(t.native_handle(), sizeof(cpu_set_t), &cpuset);
+#else
+		// pinning is not supported on this platform, workers float freely
+		(void)t;
+		(void)cpu;
+#endif
+	}
+
+	// split [first, last) recursively into pieces of at most grain indices
+	template<typename Index, typename F>
+	void __parallel_for_loop(thread_pool& pool, task_group& g, Index first, Index last, Index grain, const F& f) {
+		while (last - first > grain) {
+			Index medium = first + (last - first) / 2;
+			pool.spawn(g, [&pool, &g, medium, last, grain, &f] {
+				__parallel_for_loop(pool, g, medium, last, grain, f);
+			});
+			last = medium;
+		}
+		for (; first != last; ++first)
+			f(first);
+	}
+
+	// call f(i) for each i in [first, last) on the threads of pool
+	template<typename Index, typename F>
+	void parallel_for(thread_pool& pool, Index first, Index last, Index grain, F f) {
+		if (!(first < last))
+			return;
+		if (grain < 1)
+			grain = 1;
+		task_group g;
+		__parallel_for_loop(pool, g, first, last, grain, f);
+		pool.wait(g);
+	}
+
+	// quick sort partitions [First, Last) until the pieces are at most grain long or depth runs out,
+	// one side of each partition is spawned, the pieces left are sorted by ezSTL::sort
+	template<typename Iterator, typename Compare>
+	void __parallel_sort_loop(thread_pool& pool, task_group& g, Iterator First, Iterator Last,
+		unsigned int depth, unsigned int grain, const Compare& cmp) {
+		while (static_cast<unsigned int>(Last - First) > grain && depth > 0) {
+			--depth;
+			Iterator Medium = ezSTL::__quick_sort_partition(First, Last, cmp);
+			pool.spawn(g, [&pool, &g, Medium, Last, depth, grain, &cmp] {
+				__parallel_sort_loop(pool, g, Medium, Last, depth, grain, cmp);
+			});
+			Last = Medium;
+		}
+		ezSTL::sort(First, Last, cmp);
+	}
+
+	// unstable sort of [first, last) on the threads of pool
+	template<typename Iterator, typename Compare>
+	void parallel_sort(thread_pool& pool, Iterator first, Iterator last, Compare cmp) {
+		if (!(first < last))
+			return;
+		unsigned int n = last - first;
+		// about eight pieces per worker balance the load, smaller ones only add tasks
+		unsigned int grain = n / (8 * pool.size());
+		if (grain < 4096)
+			grain = 4096;
+		task_group g;
+		__parallel_sort_loop(pool, g, first, last, recursive_depth(n), grain, cmp);
+		pool.wait(g);
+	}
+
+	// using less as comparison
+	template<typename Iterator>
+	void parallel_sort(thread_pool& pool, Iterator first, Iterator last) {
+		parallel_sort(pool, first, last, less<typename remove_reference<decltype(*first)>::type>());
+	}
+
+	// merge sort: the first half is spawned and the second half sorted here, then the halves are merged,
+	// pieces of at most grain values are sorted by ezSTL::stable_sort
+	template<typename Iterator, typename Compare>
+	void __parallel_stable_sort_loop(thread_pool& pool, Iterator First, Iterator Last, unsigned int grain, const Compare& cmp) {
+		if (static_cast<unsigned int>(Last - First) <= grain) {
+			ezSTL::stable_sort(First, Last, cmp);
+			return;
+		}
+		Iterator Medium = First + (Last - First) / 2;
+		task_group g;
+		pool.spawn(g, [&pool, First, Medium, grain, &cmp] {
+			__parallel_stable_sort_loop(pool, First, Medium, grain, cmp);
+		});
+		__parallel_stable_sort_loop(pool, Medium, Last, grain, cmp);
+		pool.wait(g);
+		ezSTL::__merge(First, Medium, Last, cmp);
+	}
+
+	// stable sort of [first, last) on the threads of pool
+	template<typename Iterator, typename Compare>
+	void parallel_stable_sort(thread_pool& pool, Iterator first, Iterator last, Compare cmp) {
+		if (!(first < last))
+			return;
+		unsigned int n = last - first;
+		unsigned int grain = n / (8 * pool.size());
+		if (grain < 4096)
+			grain = 4096;
+		__parallel_stable_sort_loop(pool, first, last, grain, cmp);
+	}
+
+	// using less as comparison
+	template<typename Iterator>
+	void parallel_stable_sort(thread_pool& pool, Iterator first, Iterator last) {
+		parallel_stable_sort(pool, first, last, less<typename remove_reference<decltype(*first)>::type>());
+	}
+
+	// insert [first, last) into an ordered container such as set or map, the values are copied and
+	// sorted on the threads of pool first, so an empty container is then built in O(n);
+	// of equal keys the first is inserted, as by c.insert(first, last)
+	template<typename Container, typename Iterator>
+	void parallel_insert(thread_pool& pool, Container& c, Iterator first, Iterator last) {
+		vector<typename iterator_traits<Iterator>::value_type> buffer;
+		for (; first != last; ++first)
+			buffer.push_back(*first);
+		parallel_stable_sort(pool, buffer.begin(), buffer.end(), c.value_comp());
+		c.insert(buffer.begin(), buffer.end());
+	}
+
+	// runs the two independent halves of a join based set operation, the first one as a task of pool,
+	// from max_depth levels of recursion on the halves are small enough to run serially
+	class parallel_fork {
+	public:
+		// max_depth == 0 means enough levels for about eight tasks per worker
+		explicit parallel_fork(thread_pool& p, unsigned int depth = 0) : pool(p), max_depth(depth) {
+			if (max_depth == 0)
+				max_depth = __bit_width(p.size()) + 3;
+		}
+
+		template<typename F1, typename F2>
+		void operator()(unsigned int depth, const F1& f1, const F2& f2) const {
+			if (depth >= max_depth) {
+				f1();
+				f2();
+				return;
+			}
+			task_group g;
+			pool.spawn(g, f1);
+			f2();
+			pool.wait(g);
+		}
+
+	private:
+		thread_pool& pool;
+		unsigned int max_depth;
+	};
+
+	class background_reclaimer {
+	public:
+		using size_type = unsigned int;
+
+		// if idle is true the thread runs under SCHED_IDLE on linux: it takes the least from a busy caller,
+		// but a saturated cpu may starve it while it holds its mutex or the malloc lock, and then submit
+		// and malloc in other threads wait for it; only use it when the cpu has idle time
+		explicit background_reclaimer(bool idle = false) : running(false), stop(false) {
+			thread = std::thread(&background_reclaimer::run, this);
+			lower_priority(thread, idle);
+		}
+		background_reclaimer(const background_reclaimer&) = delete;
+		background_reclaimer& operator=(const background_reclaimer&) = delete;
+		// the jobs still queued run before the thread ends
+		~background_reclaimer() {
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				stop = true;
+			}
+			job_cv.notify_one();
+			thread.join();
+		}
+
+		// run f on the reclaimer thread
+		template<typename F>
+		void submit(F f) {
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				jobs.push(std::function<void()>(f));
+			}
+			job_cv.notify_one();
+		}
+		// block until every job submitted so far has run
+		void wait() {
+			std::unique_lock<std::mutex> lock(mutex);
+			idle_cv.wait(lock, [this] { return jobs.empty() && !running; });
+		}
+		// jobs queued or running
+		size_type pending() const {
+			std::lock_guard<std::mutex> lock(mutex);
+			return jobs.size() + (running ? 1 : 0);
+		}
+
+	protected:
+		mutable std::mutex mutex;
+		std::condition_variable job_cv;
+		std::condition_variable idle_cv;
+		queue<std::function<void()>> jobs;
+		bool running;
+		bool stop;
+		std::thread thread;
+
+		void run();
+		static void lower_priority(std::thread& t, bool idle);
+	};
+
+	// on linux waking a SCHED_BATCH thread does not preempt the caller, a SCHED_IDLE thread
+	// only gets the time no other thread wants; other platforms keep the default scheduling
+	inline void background_reclaimer::lower_priority(std::thread& t, bool idle) {
+#if defined(__linux__) && defined(SCHED_BATCH) && defined(SCHED_IDLE)
+		sched_param param;
+		param.sched_priority = 0;
+		pthread_setschedparam(t.native_handle(), idle ? SCHED_IDLE : SCHED_BATCH, &param);
+#else
+		(void)t;
+		(void)idle;
+#endif
+	}
+
+	inline void background_reclaimer::run() {
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true) {
+			job_cv.wait(lock, [this] { return !jobs.empty() || stop; });
+			if (jobs.empty())
+				return;
+			std::function<void()> job = jobs.front();
+			jobs.pop();
+			running = true;
+			// the lock is not held while freeing, submit never waits for a job
+			lock.unlock();
+			job();
+			lock.lock();
+			running = false;
+			if (jobs.empty())
+				idle_cv.notify_all();
+		}
+	}
+}
+
+#endif // !EZSTL_THREAD_POOL_H
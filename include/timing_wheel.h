@@ -0,0 +1,263 @@
+/*********************************************************************************************/
+// class timing_wheel:
+// hierarchical timing wheel, using vector of list as slots
+// time is measured in user units and rounded up to ticks, level i has 2^slot_bits slots
+// of 2^(slot_bits * i) ticks each. timers of higher levels cascade down when their slot is reached
+// including some basic functions of timing_wheel:
+//
+// 1. bool empty() const;
+// 2. size_type size() const;
+// 3. time_type now() const;
+// 4. handle_type schedule(time_type expire, const T& data);      O(1)
+// 5. handle_type schedule_after(time_type delay, const T& data);  O(1)
+// 6. bool cancel(handle_type h);                                  O(1)
+// 7. size_type advance(time_type now, F on_expire);               call on_expire(data) for all due timers
+// 8. void clear();
+
+#ifndef EZSTL_TIMING_WHEEL_H
+#define EZSTL_TIMING_WHEEL_H
+
+#include "list.h"
+#include "utility.h"
+#include "vector.h"
+
+namespace ezSTL {
+
+	// handle of a scheduled timer, the generation tells a reused entry from the cancelled one
+	class __timing_wheel_handle {
+	public:
+		unsigned int index;
+		unsigned int generation;
+	};
+
+	// timer stored in timing_wheel
+	template<typename T>
+	class __timing_wheel_entry {
+	public:
+		__timing_wheel_entry() : data(), expire(0), generation(0), slot(0), position(nullptr), active(false) {}
+		T data;
+		// expire time in ticks
+		unsigned long long expire;
+		unsigned int generation;
+		// slot holding the entry, and its position in the slot
+		unsigned int slot;
+		__list_iterator<unsigned int> position;
+		bool active;
+	};
+
+	template<typename T>
+	class timing_wheel {
+	public:
+		using value_type = T;
+		using size_type = unsigned int;
+		using time_type = unsigned long long;
+		using handle_type = __timing_wheel_handle;
+
+	protected:
+		using entry = __timing_wheel_entry<T>;
+		// length of a tick in user time
+		time_type tick;
+		unsigned int levels;
+		unsigned int slot_bits;
+		unsigned int slot_mask;
+		// all ticks <= current have been processed
+		time_type current;
+		// slots[level << slot_bits | index], each slot is a list of entry indices
+		vector<list<unsigned int>> slots;
+		vector<entry> entries;
+		vector<unsigned int> free_entries;
+		size_type __size;
+		// number of timers on level 0, if it is 0, ticks before the next level 1 boundary can be skipped
+		size_type near_size;
+
+		// put entry index into the slot of its expire tick
+		void link(unsigned int index);
+		// fire all timers of level 0 slot of tick t after cascading higher levels
+		template<typename F>
+		size_type process_tick(time_type t, F& on_expire);
+
+	public:
+		// tick: length of a tick, levels * slot_bits should be at most 64
+		explicit timing_wheel(time_type tick = 1, unsigned int levels = 4, unsigned int slot_bits = 8, time_type start = 0);
+		// the entries hold iterators into the slots, a copy would point into the lists of the source
+		// and a moved-from wheel would have no slots, so a wheel is neither copied nor moved
+		timing_wheel(const timing_wheel<T>&) = delete;
+		timing_wheel<T>& operator=(const timing_wheel<T>&) = delete;
+
+		bool empty() const {
+			return __size == 0;
+		}
+		size_type size() const {
+			return __size;
+		}
+		time_type now() const {
+			return current * tick;
+		}
+		// a timer not later than now() expires at the next tick
+		handle_type schedule(time_type expire, const T& data);
+		handle_type schedule_after(time_type delay, const T& data) {
+			return schedule(now() + delay, data);
+		}
+		// return false if the timer has already expired or been cancelled
+		bool cancel(handle_type h);
+		// process all ticks up to now, return the number of expired timers
+		template<typename F>
+		size_type advance(time_type now, F on_expire);
+		void clear();
+	};
+
+	template<typename T>
+	timing_wheel<T>::timing_wheel(time_type tick, unsigned int levels, unsigned int slot_bits, time_type start) :
+		tick(tick ? tick : 1), levels(levels ? levels : 1), slot_bits(slot_bits ? slot_bits : 1), __size(0), near_size(0) {
+		if (this->slot_bits > 16)
+			this->slot_bits = 16;
+		if (this->levels * this->slot_bits > 64)
+			this->levels = 64 / this->slot_bits;
+		slot_mask = (1U << this->slot_bits) - 1;
+		current = start / this->tick;
+		slots.resize(this->levels << this->slot_bits);
+	}
+
+	template<typename T>
+	void timing_wheel<T>::link(unsigned int index) {
+		entry& e = entries[index];
+		// the lowest level whose range covers expire - current, the slot is reached at or before expire
+		unsigned int level = (__bit_width(e.expire - current) + slot_bits - 1) / slot_bits;
+		level = level ? level - 1 : 0;
+		unsigned int slot;
+		if (level < levels)
+			slot = (e.expire >> (level * slot_bits)) & slot_mask;
+		// too far away: park it in the last slot to be reached on the top level, it is linked again then
+		else {
+			level = levels - 1;
+			slot = ((current >> (level * slot_bits)) + slot_mask) & slot_mask;
+		}
+		e.slot = (level << slot_bits) | slot;
+		if (level == 0)
+			++near_size;
+		slots[e.slot].push_back(index);
+		e.position = slots[e.slot].end() - 1;
+	}
+
+	template<typename T>
+	typename timing_wheel<T>::handle_type timing_wheel<T>::schedule(time_type expire, const T& data) {
+		unsigned int index;
+		if (free_entries.empty()) {
+			entries.push_back(entry());
+			index = entries.size() - 1;
+		}
+		else {
+			index = free_entries.back();
+			free_entries.pop_back();
+		}
+		entry& e = entries[index];
+		e.data = data;
+		// round up to ticks
+		e.expire = expire / tick + (expire % tick != 0);
+		if (e.expire <= current)
+			e.expire = current + 1;
+		e.active = true;
+		link(index);
+		++__size;
+		handle_type h;
+		h.index = index;
+		h.generation = e.generation;
+		return h;
+	}
+
+	template<typename T>
+	bool timing_wheel<T>::cancel(handle_type h) {
+		if (h.index >= entries.size())
+			return false;
+		entry& e = entries[h.index];
+		if (!e.active || e.generation != h.generation)
+			return false;
+		slots[e.slot].erase(e.position);
+		if (e.slot <= slot_mask)
+			--near_size;
+		e.active = false;
+		++e.generation;
+		free_entries.push_back(h.index);
+		--__size;
+		return true;
+	}
+
+	template<typename T>
+	template<typename F>
+	typename timing_wheel<T>::size_type timing_wheel<T>::process_tick(time_type t, F& on_expire) {
+		current = t;
+		// cascade from the highest level whose slot boundary is t, so its timers reach level 0 in time
+		for (unsigned int level = levels - 1; level > 0; --level) {
+			if ((t & ((1ULL << (level * slot_bits)) - 1)) != 0)
+				continue;
+			list<unsigned int>& slot = slots[(level << slot_bits) | ((t >> (level * slot_bits)) & slot_mask)];
+			while (!slot.empty()) {
+				unsigned int index = slot.front();
+				slot.pop_front();
+				link(index);
+			}
+		}
+		// fire level 0 timers one by one, on_expire may schedule or cancel other timers
+		size_type count = 0;
+		list<unsigned int>& slot = slots[t & slot_mask];
+		while (!slot.empty()) {
+			unsigned int index = slot.front();
+			slot.pop_front();
+			--near_size;
+			entry& e = entries[index];
+			// a timer parked beyond the range of all levels comes around again
+			if (e.expire > t) {
+				link(index);
+				continue;
+			}
+			e.active = false;
+			++e.generation;
+			free_entries.push_back(index);
+			--__size;
+			T data = ezSTL::move(e.data);
+			on_expire(data);
+			++count;
+		}
+		return count;
+	}
+
+	template<typename T>
+	template<typename F>
+	typename timing_wheel<T>::size_type timing_wheel<T>::advance(time_type now, F on_expire) {
+		time_type target = now / tick;
+		size_type count = 0;
+		while (current < target) {
+			// nothing to wait for, jump directly
+			if (__size == 0) {
+				current = target;
+				break;
+			}
+			time_type next = current + 1;
+			// no timer can fire before the next cascade
+			if (near_size == 0) {
+				next = (current | slot_mask) + 1;
+				if (next > target)
+					next = target;
+			}
+			count += process_tick(next, on_expire);
+		}
+		return count;
+	}
+
+	template<typename T>
+	void timing_wheel<T>::clear() {
+		for (unsigned int i = 0; i < slots.size(); ++i)
+			slots[i].clear();
+		for (unsigned int i = 0; i < entries.size(); ++i) {
+			if (entries[i].active) {
+				entries[i].active = false;
+				++entries[i].generation;
+				free_entries.push_back(i);
+			}
+		}
+		__size = 0;
+		near_size = 0;
+	}
+}
+
+#endif // !EZSTL_TIMING_WHEEL_H
@@ -1,7 +1,7 @@
 /*********************************************************************************************/
 // class unordered_map:
 // using vector as basic data structure
-// using list to solve confliction
+// using forward_list to solve confliction, every bucket is a single pointer
 // including some basic functions of unordered_map:
 //
 // 1. iterator begin() const;
@@ -14,15 +14,25 @@
 // 8. void insert(const pair<Key, Value>& p);
 // 9. void erase(const iterator ite);
 // 10. void clear();
+// 11. node_type extract(const iterator ite);
+// 12. node_type extract(const Key& key);
+// 13. pair<iterator, bool> insert(node_type&& nh);
+// 14. void deferred_clear(Reclaimer& reclaimer);
+//
+// rehashing relinks the nodes into the new buckets, nothing is copied or allocated but the bucket vector;
+// extract unlinks a node into a node_handle and insert(node_type&&) links it into the chain of its key in
+// an unordered_map of the same type, nh.key() may change in between; if the key exists the node stays in nh;
+// deferred_clear(reclaimer) swaps in a new small bucket vector and leaves destroying the old one and its
+// nodes to reclaimer, e.g. a background_reclaimer (see thread_pool.h)
 
 #ifndef EZSTL_UNORDERED_MAP_H
 #define EZSTL_UNORDERED_MAP_H
 
+#include "forward_list.h"
 #include "functional.h"
-#include "list.h"
+#include "node_handle.h"
 #include "utility.h"
 #include "vector.h"
-#include "test.h"
 
 namespace ezSTL {
 
@@ -36,17 +46,12 @@ namespace ezSTL {
 			using size_type = unsigned int;
 			using iterator = __unordered_map_iterator<Key, Value, Hash, KeyEqual>;
 			using self = __unordered_map_iterator<Key, Value, Hash, KeyEqual>;
-			using link_type = __list_node<pair<Key, Value>>*;
-			using _list_iterator = __list_iterator<pair<Key, Value>>;
-			using _list_pointer = list<pair<Key, Value>>*;
+			using link_type = __forward_list_node<pair<Key, Value>>*;
 			using _um_pointer = unordered_map<Key, Value, Hash, KeyEqual>*;
 			using difference_type = int;
 
-			// use __list_node as internal storage node
-			// list iterator
-			_list_iterator list_iterator;
-			// list pointer
-			_list_pointer list_pointer;
+			// use __forward_list_node as internal storage node, nullptr for end()
+			link_type node;
 			// unordered_map pointer
 			_um_pointer um_pointer;
 			// index of bucket in *um_pointer
@@ -54,26 +59,10 @@ namespace ezSTL {
 
 			// constructor
 			__unordered_map_iterator() = default;
-			__unordered_map_iterator(_list_iterator x, _list_pointer y, _um_pointer z, size_type n) : list_iterator(x),
-				list_pointer(y), um_pointer(z), bucket(n) {}
-			__unordered_map_iterator(const iterator& x) : list_iterator(x.list_iterator), list_pointer(x.list_pointer),
-				um_pointer(x.um_pointer), bucket(x.bucket) {}
-
-			self& operator= (const iterator& x) {
-				if (this != &x) {
-					list_iterator = x.list_iterator;
-					list_pointer = x.list_pointer;
-					um_pointer = x.um_pointer;
-					bucket = x.bucket;
-				}
-				return *this;
-			}
+			__unordered_map_iterator(link_type x, _um_pointer z, size_type n) : node(x), um_pointer(z), bucket(n) {}
 
 			bool operator== (const self& x) const {
-				// if *this and x are both end()
-				if (bucket >= um_pointer->buckets.size() && x.bucket >= x.um_pointer->buckets.size())
-					return true;
-				return list_iterator == x.list_iterator && bucket == x.bucket;
+				return node == x.node;
 			}
 
 			bool operator!= (const self& x) const {
@@ -81,7 +70,7 @@ namespace ezSTL {
 			}
 
 			Value& operator*() const {
-				return (*list_iterator).second;
+				return node->data.second;
 			}
 
 			Value* operator->() const {
@@ -89,23 +78,14 @@ namespace ezSTL {
 			}
 
 			self& operator++() {
-				// if the next node in the same list
-				if (list_iterator + 1 != list_pointer->end())
-					++list_iterator;
-				// if the next node not in the same list
-				else {
-					list_pointer = um_pointer->buckets[++bucket];
-					// go to next bucket until the next bucket is not empty or overranging
-					while (bucket < um_pointer->buckets.size() && list_pointer == nullptr)
-						list_pointer = um_pointer->buckets[++bucket];
-					// if it is not overanging
-					if (bucket < um_pointer->buckets.size())
-						list_iterator = list_pointer->begin();
-				}
+				node = static_cast<link_type>(node->next);
+				// go to next bucket until the next bucket is not empty or overranging
+				while (node == nullptr && ++bucket < um_pointer->buckets.size())
+					node = static_cast<link_type>(um_pointer->buckets[bucket].begin().node);
 				return *this;
 			}
 
-			self& operator++(int) {
+			self operator++(int) {
 				self temp = *this;
 				++(*this);
 				return temp;
@@ -113,12 +93,12 @@ namespace ezSTL {
 
 			self operator+ (difference_type n) const {
 				self temp = *this;
-				advance(temp, n);
+				ezSTL::advance(temp, n);
 				return temp;
 			}
 
 			Key get_key() const {
-				return (*list_iterator).first;
+				return node->data.first;
 			}
 	};
 
@@ -156,32 +136,29 @@ namespace ezSTL {
 			using reference = value_type&;
 			using const_reference = const pair<Key, Value>&;
 			using difference_type = int;
-			using _list_pointer = list<pair<Key, Value>>*;
+			using bucket_type = forward_list<pair<Key, Value>>;
+			using link_type = __forward_list_node<pair<Key, Value>>*;
+			using node_type = node_handle<pair<Key, Value>, __forward_list_node<pair<Key, Value>>,
+				allocator<__forward_list_node<pair<Key, Value>>>>;
 
 		public:
 			// using vector as base data structure
-			vector<_list_pointer> buckets;
+			vector<bucket_type> buckets;
 		protected:
 			size_type __size;
-			iterator end_iterator;
 
 		public:
 			// some common functions of unordered_map
 			iterator begin() const {
 				// find the first pair
 				for (size_type i = 0; i < buckets.size(); ++i)
-					if (buckets[i]) {
-						iterator temp;
-						temp.list_iterator = buckets[i]->begin();
-						temp.list_pointer = buckets[i];
-						temp.um_pointer = const_cast<unordered_map<Key, Value, Hash, KeyEqual>*>(this);
-						temp.bucket = i;
-						return temp;
-					}
+					if (!buckets[i].empty())
+						return iterator(static_cast<link_type>(buckets[i].begin().node),
+							const_cast<unordered_map<Key, Value, Hash, KeyEqual>*>(this), i);
 				return end();
 			}
 			iterator end() const {
-				return end_iterator;
+				return iterator(nullptr, const_cast<unordered_map<Key, Value, Hash, KeyEqual>*>(this), bucket_size());
 			}
 			size_type size() const {
 				return __size;
@@ -193,9 +170,12 @@ namespace ezSTL {
 				return __size == 0;
 			}
 
-			// operator []
+			// operator [], insert a default value if key does not exist
 			Value& operator[] (const Key& key) {
-				return *find(key);
+				iterator ite = find(key);
+				if (ite == end())
+					ite = insert_new(ezSTL::make_pair(key, Value()));
+				return *ite;
 			}
 
 			// find specific key, and return the iterator
@@ -206,44 +186,47 @@ namespace ezSTL {
 			void erase(const iterator ite);
 			// clear the unordered_map
 			void clear();
+			// take the node of ite out of the map
+			node_type extract(const iterator ite);
+			// take the node of key out of the map, an empty handle if key is missing
+			node_type extract(const Key& key) {
+				iterator ite = find(key);
+				return ite == end() ? node_type() : extract(ite);
+			}
+			// link the node of nh into the map, it stays in nh if the key exists
+			pair<iterator, bool> insert(node_type&& nh);
+			// empty the map now, reclaimer destroys the nodes later
+			template<typename Reclaimer>
+			void deferred_clear(Reclaimer& reclaimer) {
+				vector<bucket_type>* detached = new vector<bucket_type>(ezSTL::move(buckets));
+				buckets = vector<bucket_type>(prime_list[0]);
+				__size = 0;
+				reclaimer.submit([detached] { delete detached; });
+			}
 
 			// constructor
-			unordered_map() : buckets(prime_list[0], nullptr), __size(0), end_iterator(nullptr, nullptr, this, buckets.size()) {}
+			unordered_map() : buckets(prime_list[0]), __size(0) {}
 			// copy constructor
-			unordered_map(const unordered_map<Key, Value, Hash, KeyEqual>& um) : buckets(um.bucket_size(), nullptr), 
-				__size(um.size()), end_iterator(nullptr, nullptr, this, um.bucket_size()) {
-				for (size_type i = 0; i < bucket_size(); ++i) {
-					if(um.buckets[i])
-						buckets[i] = new list<pair<Key, Value>>(*um.buckets[i]);
-				}
-			}
+			unordered_map(const unordered_map<Key, Value, Hash, KeyEqual>& um) : buckets(um.buckets), __size(um.size()) {}
 			// move constructor
-			unordered_map(unordered_map<Key, Value, Hash, KeyEqual>&& um) noexcept {
-				buckets = move(um.buckets);
-				__size = um.__size;
-				end_iterator = um.end_iterator;
+			unordered_map(unordered_map<Key, Value, Hash, KeyEqual>&& um) noexcept : buckets(ezSTL::move(um.buckets)), __size(um.__size) {
+				um.__size = 0;
 			}
 
 			// copy assignemnt operator
 			unordered_map<Key, Value, Hash, KeyEqual>& operator= (const unordered_map<Key, Value, Hash, KeyEqual>& um) {
 				if (this != &um) {
-					clear();
-					buckets.resize(um.bucket_size());
-					for (size_type i = 0; i < bucket_size(); ++i) {
-						if (um.buckets[i])
-							buckets[i] = new list<pair<Key, Value>>(*um.buckets[i]);
-					}
+					buckets = um.buckets;
 					__size = um.size();
-					end_iterator = um.end_iterator;
 				}
 				return *this;
 			}
 			// move assignemnt operators
 			unordered_map<Key, Value, Hash, KeyEqual>& operator= (unordered_map<Key, Value, Hash, KeyEqual>&& um) noexcept {
 				if (this != &um) {
-					buckets = move(um.buckets);
+					buckets = ezSTL::move(um.buckets);
 					__size = um.__size;
-					end_iterator = um.end_iterator;
+					um.__size = 0;
 				}
 				return *this;
 			}
@@ -252,17 +235,29 @@ namespace ezSTL {
 			~unordered_map() {
 				clear();
 			}
+
+		protected:
+			size_type bucket_index(const Key& key, size_type n) const {
+				return Hash()(key) % n;
+			}
+			// insert a pair whose key does not exist, then rehash if needed
+			iterator insert_new(const pair<Key, Value>& p);
+			// rehash by the predetermined primes if one more pair would pass max_load_factor
+			void reserve_one();
+			// move every node into n new buckets
+			void rehash(size_type n);
 	};
 
 	template<typename Key, typename Value, typename Hash, typename KeyEqual>
 	typename unordered_map<Key, Value, Hash, KeyEqual>::iterator
 	unordered_map<Key, Value, Hash, KeyEqual>::find(const Key& key) {
+		// a moved from map has no bucket
+		if (buckets.size() == 0) return end();
 		// finding index
-		size_type index = Hash()(key) % buckets.size();
-		if (!buckets[index]) return end();
-		// searching the list and find key
-		for(auto ite = buckets[index]->begin(); ite != buckets[index]->end(); ++ite)
-			if (KeyEqual()(ite->first, key)) return iterator(ite, buckets[index], this, index);
+		size_type index = bucket_index(key, buckets.size());
+		// searching the chain and find key
+		for (auto ite = buckets[index].begin(); ite != buckets[index].end(); ++ite)
+			if (KeyEqual()(ite->first, key)) return iterator(static_cast<link_type>(ite.node), this, index);
 		return end();
 	}
 
@@ -270,53 +265,94 @@ namespace ezSTL {
 	void unordered_map<Key, Value, Hash, KeyEqual>::insert(const pair<Key, Value>& p) {
 		auto ite = find(p.first);
 		// if key does not exists
-		if (ite == end()) {
-			size_type index = Hash()(p.first) % buckets.size();
-			if (!buckets[index])
-				buckets[index] = new list<pair<Key, Value>>();
-			buckets[index]->push_front(p);
-			++__size;
-		}
+		if (ite == end())
+			insert_new(p);
 		// else replace the value
 		else *ite = p.second;
-		// if load_factor > max_load_factor, then rehash
-		if (static_cast<double>(size()) / bucket_size() > max_load_factor) {
-			// get next bucket size by predetermined primes
+	}
+
+	template<typename Key, typename Value, typename Hash, typename KeyEqual>
+	typename unordered_map<Key, Value, Hash, KeyEqual>::iterator
+	unordered_map<Key, Value, Hash, KeyEqual>::insert_new(const pair<Key, Value>& p) {
+		reserve_one();
+		size_type index = bucket_index(p.first, buckets.size());
+		buckets[index].push_front(p);
+		++__size;
+		return iterator(static_cast<link_type>(buckets[index].begin().node), this, index);
+	}
+
+	template<typename Key, typename Value, typename Hash, typename KeyEqual>
+	void unordered_map<Key, Value, Hash, KeyEqual>::reserve_one() {
+		// if load_factor > max_load_factor, then rehash by predetermined primes
+		if (buckets.size() == 0 || static_cast<double>(size() + 1) / bucket_size() > max_load_factor) {
 			size_type new_size = next_prime(bucket_size());
-			// if not changed, return directly
-			if (new_size == bucket_size()) return;
-			else {
-				unordered_map<Key, Value, Hash, KeyEqual> temp = *this;
-				clear();
-				// resize buckets
-				buckets.resize(new_size);
-				end_iterator.bucket = new_size;
-				// insert each pair from old unordered_map to new one
-				for (auto ite = temp.begin(); ite != temp.end(); ++ite)
-					insert(make_pair(ite.get_key(), *ite));
+			if (new_size != bucket_size())
+				rehash(new_size);
+		}
+	}
+
+	template<typename Key, typename Value, typename Hash, typename KeyEqual>
+	pair<typename unordered_map<Key, Value, Hash, KeyEqual>::iterator, bool>
+	unordered_map<Key, Value, Hash, KeyEqual>::insert(node_type&& nh) {
+		if (nh.empty())
+			return pair<iterator, bool>(end(), false);
+		iterator ite = find(nh.key());
+		if (ite != end())
+			return pair<iterator, bool>(ite, false);
+		reserve_one();
+		// link the node at the front of its chain
+		size_type index = bucket_index(nh.key(), buckets.size());
+		link_type node = nh.release();
+		auto head = buckets[index].before_begin();
+		node->next = head.node->next;
+		head.node->next = node;
+		++__size;
+		return pair<iterator, bool>(iterator(node, this, index), true);
+	}
+
+	template<typename Key, typename Value, typename Hash, typename KeyEqual>
+	typename unordered_map<Key, Value, Hash, KeyEqual>::node_type
+	unordered_map<Key, Value, Hash, KeyEqual>::extract(const iterator ite) {
+		bucket_type& bucket = buckets[ite.bucket];
+		// unlink the node from its chain as erase does, but keep it
+		auto prev = bucket.before_begin();
+		while (prev.node->next != ite.node)
+			++prev;
+		prev.node->next = ite.node->next;
+		--__size;
+		return node_type(ite.node);
+	}
+
+	template<typename Key, typename Value, typename Hash, typename KeyEqual>
+	void unordered_map<Key, Value, Hash, KeyEqual>::rehash(size_type n) {
+		vector<bucket_type> new_buckets(n);
+		for (size_type i = 0; i < buckets.size(); ++i) {
+			bucket_type& old_bucket = buckets[i];
+			// move the first node of the old chain to the front of its new chain
+			while (!old_bucket.empty()) {
+				bucket_type& new_bucket = new_buckets[bucket_index(old_bucket.front().first, n)];
+				new_bucket.splice_after(new_bucket.before_begin(), old_bucket, old_bucket.before_begin());
 			}
 		}
+		buckets = ezSTL::move(new_buckets);
 	}
 
 	template<typename Key, typename Value, typename Hash, typename KeyEqual>
 	void unordered_map<Key, Value, Hash, KeyEqual>::erase(const iterator ite) {
-		ite.list_pointer->erase(ite.list_iterator);
-		// if the list is empty, then remove the list
-		if (ite.list_pointer->empty()) {
-			delete ite.um_pointer->buckets[ite.bucket];
-			ite.um_pointer->buckets[ite.bucket] = nullptr;
-		}
+		bucket_type& bucket = buckets[ite.bucket];
+		// find the node before ite in its chain
+		auto prev = bucket.before_begin();
+		while (prev.node->next != ite.node)
+			++prev;
+		bucket.erase_after(prev);
 		--__size;
 	}
+
 	template<typename Key, typename Value, typename Hash, typename KeyEqual>
 	void unordered_map<Key, Value, Hash, KeyEqual>::clear() {
 		// clear the buckets
-		for (size_type i = 0; i < bucket_size(); ++i) {
-			if (buckets[i]) {
-				delete buckets[i];
-				buckets[i] = nullptr;
-			}
-		}
+		for (size_type i = 0; i < bucket_size(); ++i)
+			buckets[i].clear();
 		__size = 0;
 	}
 }
@@ -0,0 +1,363 @@
+/*********************************************************************************************/
+// class unrolled_list:
+// bidirectional list whose nodes hold a small array of up to NodeCapacity elements,
+// iterating walks contiguous memory and the two pointers are shared by a whole node
+// including some basic functions of unrolled_list:
+//
+// 1. iterator begin() const;
+// 2. iterator end() const;
+// 3. size_type size() const;
+// 4. size_type node_count() const;
+// 5. bool empty() const;
+// 6. reference front() const;
+// 7. reference back() const;
+// 8. void push_back(const_reference x);
+// 9. void push_front(const_reference x);
+// 10. void pop_back();
+// 11. void pop_front();
+// 12. iterator insert(iterator pos, const_reference x);
+// 13. iterator emplace(iterator pos, Args&&... args);
+// 14. iterator erase(iterator pos);
+// 15. void clear();
+// 16. void swap(unrolled_list& other);
+//
+// insert and erase move at most NodeCapacity elements: a full node is split in two halves,
+// a node less than half full is merged with its successor when both fit in one node
+//
+// iterator stability:
+// insert and erase invalidate iterators, pointers and references to the elements of the node
+// they touch, and of the node split from it or merged into it;
+// iterators to elements of every other node stay valid
+// insert and erase return an iterator to the inserted element and to the element after the erased one
+
+#ifndef EZSTL_UNROLLED_LIST_H
+#define EZSTL_UNROLLED_LIST_H
+
+#include "iterator.h"
+#include "memory.h"
+#include "utility.h"
+
+namespace ezSTL {
+
+	// unrolled list node, elements live in uninitialized storage, [0, count) are constructed
+	template<typename T, unsigned int NodeCapacity>
+	class __unrolled_list_node {
+	public:
+		using link_type = __unrolled_list_node<T, NodeCapacity>*;
+		link_type prev;
+		link_type next;
+		unsigned int count;
+		alignas(T) unsigned char storage[sizeof(T) * NodeCapacity];
+
+		__unrolled_list_node() : prev(this), next(this), count(0) {}
+		T* data() {
+			return reinterpret_cast<T*>(storage);
+		}
+		bool full() const {
+			return count == NodeCapacity;
+		}
+	};
+
+	// unrolled list iterator, a node and the index of the element in it
+	// end() is index 0 of the header node which never holds elements
+	template<typename T, unsigned int NodeCapacity>
+	class __unrolled_list_iterator : public iterator<bidirectional_iterator_tag, T> {
+	public:
+		using iterator = __unrolled_list_iterator<T, NodeCapacity>;
+		using self = __unrolled_list_iterator<T, NodeCapacity>;
+		using link_type = __unrolled_list_node<T, NodeCapacity>*;
+		using pointer = T*;
+		using reference = T&;
+		using difference_type = int;
+
+		link_type node;
+		unsigned int index;
+
+		__unrolled_list_iterator() = default;
+		__unrolled_list_iterator(link_type x, unsigned int i) : node(x), index(i) {}
+
+		bool operator== (const self& x) const {
+			return node == x.node && index == x.index;
+		}
+		bool operator!= (const self& x) const {
+			return !(*this == x);
+		}
+		reference operator*() const {
+			return node->data()[index];
+		}
+		pointer operator->() const {
+			return &(operator*());
+		}
+		// go to next
+		self& operator++() {
+			if (++index >= node->count) {
+				node = node->next;
+				index = 0;
+			}
+			return *this;
+		}
+		self operator++(int) {
+			self temp = *this;
+			++(*this);
+			return temp;
+		}
+		// go to prev
+		self& operator--() {
+			if (index == 0) {
+				node = node->prev;
+				index = node->count - 1;
+			}
+			else
+				--index;
+			return *this;
+		}
+		self operator--(int) {
+			self temp = *this;
+			--(*this);
+			return temp;
+		}
+
+		self operator+ (difference_type n) const {
+			self temp = *this;
+			ezSTL::advance(temp, n);
+			return temp;
+		}
+		self operator- (difference_type n) const {
+			self temp = *this;
+			ezSTL::advance(temp, -n);
+			return temp;
+		}
+	};
+
+	// class unrolled_list
+	template<typename T, unsigned int NodeCapacity = 32,
+		typename Alloc = allocator<__unrolled_list_node<T, NodeCapacity>>>
+	class unrolled_list {
+		static_assert(NodeCapacity >= 2, "unrolled_list needs room for at least two elements per node");
+	public:
+		using list_node = __unrolled_list_node<T, NodeCapacity>;
+		using link_type = list_node*;
+		using size_type = unsigned int;
+		using value_type = T;
+		using iterator = __unrolled_list_iterator<T, NodeCapacity>;
+		using const_iterator = const iterator;
+		using reference = value_type&;
+		using const_reference = const T&;
+		using difference_type = int;
+
+	protected:
+		using data_allocator = allocator<T>;
+		// header node, never holds elements
+		link_type header;
+		size_type __size;
+		size_type __node_count;
+
+	public:
+		// constructor
+		unrolled_list() : header(new_node()), __size(0), __node_count(0) {}
+		unrolled_list(const unrolled_list& other) : unrolled_list() {
+			for (iterator ite = other.begin(); ite != other.end(); ++ite)
+				push_back(*ite);
+		}
+		unrolled_list(unrolled_list&& other) noexcept : unrolled_list() {
+			swap(other);
+		}
+		unrolled_list& operator=(const unrolled_list& other) {
+			if (this != &other) {
+				clear();
+				for (iterator ite = other.begin(); ite != other.end(); ++ite)
+					push_back(*ite);
+			}
+			return *this;
+		}
+		unrolled_list& operator=(unrolled_list&& other) noexcept {
+			swap(other);
+			return *this;
+		}
+		// destructor
+		~unrolled_list() {
+			clear();
+			delete_node(header);
+		}
+
+		// some common functions for unrolled_list
+		const_iterator begin() const {
+			return iterator(header->next, 0);
+		}
+		const_iterator end() const {
+			return iterator(header, 0);
+		}
+		reference front() const {
+			return *begin();
+		}
+		reference back() const {
+			return header->prev->data()[header->prev->count - 1];
+		}
+		size_type size() const {
+			return __size;
+		}
+		// number of nodes holding elements, node_count() * sizeof(list_node) is the memory used
+		size_type node_count() const {
+			return __node_count;
+		}
+		bool empty() const {
+			return size() == 0;
+		}
+		void push_back(const_reference x) {
+			emplace(end(), x);
+		}
+		void push_back(value_type&& x) {
+			emplace(end(), ezSTL::move(x));
+		}
+		void push_front(const_reference x) {
+			emplace(begin(), x);
+		}
+		void push_front(value_type&& x) {
+			emplace(begin(), ezSTL::move(x));
+		}
+		void pop_back() {
+			erase(end() - 1);
+		}
+		void pop_front() {
+			erase(begin());
+		}
+		iterator insert(iterator pos, const_reference x) {
+			return emplace(pos, x);
+		}
+		iterator insert(iterator pos, value_type&& x) {
+			return emplace(pos, ezSTL::move(x));
+		}
+		template<typename... Args>
+		iterator emplace(iterator pos, Args&&... args);
+		iterator erase(iterator pos);
+		void clear();
+		void swap(unrolled_list& other) noexcept {
+			ezSTL::swap(header, other.header);
+			ezSTL::swap(__size, other.__size);
+			ezSTL::swap(__node_count, other.__node_count);
+		}
+
+	protected:
+		link_type new_node() {
+			link_type node = Alloc().allocate();
+			Alloc().construct(node);
+			return node;
+		}
+		void delete_node(link_type node) {
+			Alloc().destroy(node);
+			Alloc().deallocate(node);
+		}
+		// link a new empty node before pos
+		link_type link_node_before(link_type pos) {
+			link_type node = new_node();
+			node->next = pos;
+			node->prev = pos->prev;
+			pos->prev->next = node;
+			pos->prev = node;
+			++__node_count;
+			return node;
+		}
+		void unlink_node(link_type node) {
+			node->prev->next = node->next;
+			node->next->prev = node->prev;
+			delete_node(node);
+			--__node_count;
+		}
+		// move construct the element of src into dst and destroy src
+		static void relocate(T* dst, T* src) {
+			data_allocator().construct(dst, ezSTL::move(*src));
+			data_allocator().destroy(src);
+		}
+		// move [first, first + n) of src to the end of dst
+		static void relocate_back(link_type dst, link_type src, unsigned int first, unsigned int n) {
+			for (unsigned int i = 0; i < n; ++i)
+				relocate(dst->data() + dst->count + i, src->data() + first + i);
+			dst->count += n;
+		}
+	};
+
+	template<typename T, unsigned int NodeCapacity, typename Alloc>
+	template<typename... Args>
+	typename unrolled_list<T, NodeCapacity, Alloc>::iterator
+		unrolled_list<T, NodeCapacity, Alloc>::emplace(iterator pos, Args&&... args) {
+		// build the element first, args may refer to an element that is about to move
+		T value(ezSTL::forward<Args>(args)...);
+		link_type node = pos.node;
+		unsigned int index = pos.index;
+		// at the front of a node, or at end(): append to the previous node if it has room
+		if (index == 0 && node->prev != header && !node->prev->full()) {
+			node = node->prev;
+			index = node->count;
+		}
+		else if (node == header || (index == 0 && node->full())) {
+			node = link_node_before(node);
+			index = 0;
+		}
+		else if (node->full()) {
+			// split the node, the upper half moves to a new node after it
+			link_type upper = link_node_before(node->next);
+			unsigned int half = NodeCapacity / 2;
+			relocate_back(upper, node, half, NodeCapacity - half);
+			node->count = half;
+			if (index > half) {
+				node = upper;
+				index -= half;
+			}
+		}
+		// shift [index, count) one place up and construct the element in the gap
+		T* data = node->data();
+		for (unsigned int i = node->count; i > index; --i)
+			relocate(data + i, data + i - 1);
+		data_allocator().construct(data + index, ezSTL::move(value));
+		++node->count;
+		++__size;
+		return iterator(node, index);
+	}
+
+	template<typename T, unsigned int NodeCapacity, typename Alloc>
+	typename unrolled_list<T, NodeCapacity, Alloc>::iterator
+		unrolled_list<T, NodeCapacity, Alloc>::erase(iterator pos) {
+		link_type node = pos.node;
+		unsigned int index = pos.index;
+		T* data = node->data();
+		data_allocator().destroy(data + index);
+		for (unsigned int i = index + 1; i < node->count; ++i)
+			relocate(data + i - 1, data + i);
+		--node->count;
+		--__size;
+		if (node->count == 0) {
+			link_type next = node->next;
+			unlink_node(node);
+			return iterator(next, 0);
+		}
+		// keep nodes at least half full when the successor fits in the same node
+		link_type next = node->next;
+		if (node->count < NodeCapacity / 2 && next != header && node->count + next->count <= NodeCapacity) {
+			relocate_back(node, next, 0, next->count);
+			next->count = 0;
+			unlink_node(next);
+		}
+		if (index < node->count)
+			return iterator(node, index);
+		return iterator(node->next, 0);
+	}
+
+	template<typename T, unsigned int NodeCapacity, typename Alloc>
+	void unrolled_list<T, NodeCapacity, Alloc>::clear() {
+		link_type node = header->next;
+		while (node != header) {
+			link_type next = node->next;
+			T* data = node->data();
+			for (unsigned int i = 0; i < node->count; ++i)
+				data_allocator().destroy(data + i);
+			delete_node(node);
+			node = next;
+		}
+		header->prev = header;
+		header->next = header;
+		__size = 0;
+		__node_count = 0;
+	}
+}
+
+#endif // !EZSTL_UNROLLED_LIST_H
@@ -2,15 +2,21 @@
 // some common useful tools:
 // 1. remove_reference class
 // 2. move function
-// 3. swap function
-// 4. pair class
-// 5. make_pair function
+// 3. forward function
+// 4. swap function
+// 5. pair class
+// 6. make_pair function
+// 7. __bit_width function
+// 8. __owner_of function, needs a standard-layout owner
 //
 // the above classes of funcitons are frequently used in containers, adapters, algorithm, etc
 
 #ifndef EZSTL_UTILITY_H
 #define EZSTL_UTILITY_H
 
+#include <cstddef>
+#include <type_traits>
+
 namespace ezSTL {
 
 	// remove_reference traits
@@ -39,6 +45,17 @@ namespace ezSTL {
 		return (static_cast<typename remove_reference<T>::type&&>(arg));
 	}
 
+	// forward
+	// keep the value category of an argument of a forwarding reference
+	template<typename T>
+	inline T&& forward(typename remove_reference<T>::type& arg) noexcept {
+		return (static_cast<T&&>(arg));
+	}
+	template<typename T>
+	inline T&& forward(typename remove_reference<T>::type&& arg) noexcept {
+		return (static_cast<T&&>(arg));
+	}
+
 	// swap
 	// swap two arguments
 	template<typename T>
@@ -52,6 +69,8 @@ namespace ezSTL {
 	template<typename FIRST, typename SECOND>
 	class pair {
 	public:
+		using first_type = FIRST;
+		using second_type = SECOND;
 		FIRST first;
 		SECOND second;
 	public:
@@ -94,6 +113,43 @@ namespace ezSTL {
 	inline pair<FIRST, SECOND> make_pair(const FIRST& a, const SECOND& b) {
 		return pair<FIRST, SECOND>(a, b);
 	}
+
+	// number of significant bits of x, 0 for 0
+	template<typename Key>
+	inline unsigned int __bit_width(Key x) {
+#if defined(__GNUC__)
+		if (x == 0)
+			return 0;
+		if (sizeof(Key) <= sizeof(unsigned int))
+			return sizeof(unsigned int) * 8 - __builtin_clz(static_cast<unsigned int>(x));
+		return sizeof(unsigned long long) * 8 - __builtin_clzll(static_cast<unsigned long long>(x));
+#else
+		unsigned int width = 0;
+		for (; x != 0; x >>= 1)
+			++width;
+		return width;
+#endif
+	}
+
+	// storage of the size and alignment of an Owner, the Owner is never constructed in it
+	template<typename Owner>
+	union __owner_storage {
+		__owner_storage() {}
+		~__owner_storage() {}
+		unsigned char bytes[sizeof(Owner)];
+		Owner object;
+	};
+
+	// object owning the member pointed to by member, used by intrusive containers to go from a hook to its object;
+	// Owner must be standard-layout, so a member is at the same offset in every Owner and no virtual base moves it
+	template<typename Owner, typename Member>
+	inline Owner* __owner_of(Member* member, Member Owner::*ptr) {
+		static_assert(std::is_standard_layout<Owner>::value, "an intrusive hook needs a standard-layout owner");
+		// offset of the member, measured on real storage of an Owner, the compiler folds it into a constant
+		__owner_storage<Owner> storage;
+		std::ptrdiff_t offset = reinterpret_cast<char*>(&(storage.object.*ptr)) - reinterpret_cast<char*>(&storage.object);
+		return reinterpret_cast<Owner*>(reinterpret_cast<char*>(member) - offset);
+	}
 }
 
 #endif // !EZSTL_UTILITY_H
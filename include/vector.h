@@ -13,11 +13,14 @@
 // 8. reference front() const;
 // 9. reference back() const;
 // 10. void push_back(const_reference x);
-// 11. void pop_back();
-// 12. iterator insert(const_iterator pos, const_reference x);
-// 13. iterator erase(iterator pos);
-// 14. void resize(size_type n);
-// 15. void clear();
+//     void push_back(value_type&& x);
+// 11. void emplace_back(Args&&... args);
+// 12. void pop_back();
+// 13. iterator insert(const_iterator pos, const_reference x);
+// 14. iterator erase(iterator pos);
+// 15. void resize(size_type n);
+// 16. void reserve(size_type n);
+// 17. void clear();
 
 #ifndef EZSTL_VECTOR_H
 #define EZSTL_VECTOR_H
@@ -88,10 +91,14 @@ namespace ezSTL {
 		}
 
 		void push_back(const_reference x);
+		void push_back(value_type&& x);
+		template<typename... Args>
+		void emplace_back(Args&&... args);
 		void pop_back();
 		iterator insert(const_iterator pos, const_reference x);
 		iterator erase(iterator pos);
 		void resize(size_type n);
+		void reserve(size_type n);
 		void clear();
 
 	protected:
@@ -119,6 +126,10 @@ namespace ezSTL {
 			Alloc().construct(ptr, value);
 		}
 
+		void construct(iterator ptr, value_type&& value) {
+			Alloc().construct(ptr, ezSTL::move(value));
+		}
+
 		void destroy(iterator ite) {
 			Alloc().destroy(ite);
 		}
@@ -137,6 +148,35 @@ namespace ezSTL {
 			if (start)
 				Alloc().deallocate(start);
 		}
+
+		// internal function, move all elements into new space of n elements
+		void reallocate(size_type n) {
+			size_type old_size = size();
+			iterator new_start = allocate(n);
+			for (size_type i = 0; i < old_size; ++i)
+				construct(new_start + i, ezSTL::move((*this)[i]));
+			destroy(start, finish);
+			deallocate();
+			start = new_start;
+			finish = start + old_size;
+			end_of_storage = start + n;
+		}
+
+		// internal function, construct the new last element from args in new space of n elements
+		// before moving the old ones there, args may refer to an element of the old space
+		template<typename... Args>
+		void reallocate_and_emplace(size_type n, Args&&... args) {
+			size_type old_size = size();
+			iterator new_start = allocate(n);
+			Alloc().construct(new_start + old_size, ezSTL::forward<Args>(args)...);
+			for (size_type i = 0; i < old_size; ++i)
+				construct(new_start + i, ezSTL::move((*this)[i]));
+			destroy(start, finish);
+			deallocate();
+			start = new_start;
+			finish = start + old_size + 1;
+			end_of_storage = start + n;
+		}
 	};
 
 	template<typename T, typename Alloc>
@@ -180,6 +220,9 @@ namespace ezSTL {
 	vector<T, Alloc>& vector<T, Alloc>::operator= (vector<T, Alloc>&& v) noexcept {
 		if (this == &v) return *this;
 		else {
+			// release the old elements
+			destroy(begin(), end());
+			deallocate();
 			start = v.start;
 			finish = v.finish;
 			end_of_storage = v.end_of_storage;
@@ -198,22 +241,27 @@ namespace ezSTL {
 		}
 		else
 		{
-			size_type old_size = size();
-			// calculate new size
-			size_type new_size = old_size ? 2 * old_size : 1;
-			iterator new_start = allocate(new_size);
-			iterator temp = new_start;
-			for (size_type i = 0; i < old_size; ++i)
-				construct(temp++, (*this)[i]);
-			destroy(start, finish);
-			deallocate();
-			construct(temp++, x);
-			start = new_start;
-			finish = temp;
-			end_of_storage = start + new_size;
+			reallocate_and_emplace(size() ? 2 * size() : 1, x);
 		}
 	}
 
+	template<typename T, typename Alloc>
+	void vector<T, Alloc>::push_back(value_type&& x) {
+		if (finish == end_of_storage)
+			reallocate_and_emplace(size() ? 2 * size() : 1, ezSTL::move(x));
+		else
+			construct(finish++, ezSTL::move(x));
+	}
+
+	template<typename T, typename Alloc>
+	template<typename... Args>
+	void vector<T, Alloc>::emplace_back(Args&&... args) {
+		if (finish == end_of_storage)
+			reallocate_and_emplace(size() ? 2 * size() : 1, ezSTL::forward<Args>(args)...);
+		else
+			Alloc().construct(finish++, ezSTL::forward<Args>(args)...);
+	}
+
 	template<typename T, typename Alloc>
 	void vector<T, Alloc>::pop_back() {
 		destroy(--finish);
@@ -289,6 +337,13 @@ namespace ezSTL {
 		}
 	}
 
+	// make sure capacity() >= n, never shrink
+	template<typename T, typename Alloc>
+	void vector<T, Alloc>::reserve(size_type n) {
+		if (n > capacity())
+			reallocate(n);
+	}
+
 	template<typename T, typename Alloc>
 	void vector<T, Alloc>::clear() {
 		destroy(begin(), end());
@@ -9,16 +9,37 @@ int main()
 	// add annotations to prevent running the testing codes of corresponding modules
 	test::test_vector();
 	test::test_list();
+	test::test_list_efficiency();
+	test::test_forward_list();
+	test::test_forward_list_efficiency();
+	test::test_unrolled_list();
+	test::test_unrolled_list_efficiency();
+	test::test_intrusive_containers();
+	test::test_intrusive_containers_efficiency();
 	test::test_stack();
 	test::test_queue();
 	test::test_priority_queue();
+	test::test_priority_queue_efficiency();
+	test::test_addressable_heap();
+	test::test_addressable_heap_efficiency();
+	test::test_radix_heap();
+	test::test_radix_heap_efficiency();
+	test::test_timing_wheel();
+	test::test_timing_wheel_efficiency();
 	test::test_rbtree();
 	test::test_set();
 	test::test_map();
+	test::test_btree();
+	test::test_flat_containers();
+	test::test_static_index();
+	test::test_arena_set();
+	test::test_interval_map();
 	test::test_unordered_map();
 	test::test_smart_pointers();
 	test::test_set_map_efficiency();
 	test::test_algorithm();
 	test::test_algorithm_efficiency();
+	test::test_thread_pool();
+	test::test_thread_pool_efficiency();
 	return 0;
 }